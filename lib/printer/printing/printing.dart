@@ -5,9 +5,12 @@ import 'src/fonts/gfonts.dart';
 export 'src/asset_utils.dart';
 export 'src/cache.dart';
 export 'src/callback.dart';
+export 'src/document_info.dart';
 export 'src/fonts/gfonts.dart';
 export 'src/preview/actions.dart';
 export 'src/preview/pdf_preview.dart';
+export 'src/print_job_status.dart';
+export 'src/print_options.dart';
 export 'src/printer.dart';
 export 'src/printing.dart';
 export 'src/printing_info.dart';
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2017, David PHAM-VAN <dev.nfet.net@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import 'dart:typed_data';
+
+import 'package:method_channel/printer/pdf/pdf.dart';
+
+import 'raster.dart';
+
+/// Layout and print preferences of a Pdf document, read without
+/// rendering any page
+class PdfDocumentInfo {
+  /// Create a document information object
+  const PdfDocumentInfo({
+    required this.pageCount,
+    required this.sizes,
+    this.version = 0,
+    this.permissions = 0,
+    this.printScaling = true,
+    this.numCopies = 1,
+    this.printPageRange = const <int>[],
+    this.duplex = 0,
+  });
+
+  /// Create a document information object from a dictionnary
+  factory PdfDocumentInfo.fromMap(Map<dynamic, dynamic> map) =>
+      PdfDocumentInfo(
+        pageCount: map['pageCount'],
+        sizes: map['sizes'],
+        version: map['version'] ?? 0,
+        permissions: map['permissions'] ?? 0,
+        printScaling: map['printScaling'] ?? true,
+        numCopies: map['numCopies'] ?? 1,
+        printPageRange: List<int>.from(map['printPageRange'] ?? const <int>[]),
+        duplex: map['duplex'] ?? 0,
+      );
+
+  /// Number of pages
+  final int pageCount;
+
+  /// Width and height of each page, in points
+  final Float64List sizes;
+
+  /// Pdf version: 17 for PDF 1.7, 0 if unknown
+  final int version;
+
+  /// Document permission flags, see table 3.20 of the PDF reference
+  final int permissions;
+
+  /// Whether the viewer may scale the pages when printing
+  final bool printScaling;
+
+  /// Number of copies to print
+  final int numCopies;
+
+  /// Page ranges to print, empty for all pages: zero-based first and last
+  /// page of each range, in pairs
+  final List<int> printPageRange;
+
+  /// Paper handling: 0 undefined, 1 simplex, 2 duplex flip on the short edge,
+  /// 3 duplex flip on the long edge
+  final int duplex;
+
+  /// The format of a page, in points
+  PdfPageFormat pageFormat(int page) =>
+      PdfPageFormat(sizes[page * 2], sizes[page * 2 + 1]);
+
+  @override
+  String toString() => '$runtimeType $pageCount pages, version $version';
+}
+
+/// A Pdf document kept open on the native side
+class PdfDocumentHandle {
+  /// Create a handle from its native id and document information
+  const PdfDocumentHandle(this.handle, this.info);
+
+  /// The native id of the document
+  final int handle;
+
+  /// Page count, sizes and print preferences of the document
+  final PdfDocumentInfo info;
+
+  @override
+  String toString() => '$runtimeType #$handle $info';
+}
+
+/// A visible page of an open document rendered again by the platform
+class PdfPageRender {
+  /// Create a page render event
+  const PdfPageRender(this.handle, this.page, this.raster);
+
+  /// The native id of the document
+  final int handle;
+
+  /// The page index
+  final int page;
+
+  /// The new image of the page
+  final PdfRaster raster;
+}
+
+/// A page of one of the documents of [Printing.rasterBatch]
+class PdfBatchRaster {
+  /// Create a batch result
+  const PdfBatchRaster(this.document, this.page, {this.raster, this.error});
+
+  /// Index of the document in the list given to [Printing.rasterBatch]
+  final int document;
+
+  /// The page index, -1 if the whole document failed
+  final int page;
+
+  /// The image of the page, null on error
+  final PdfRaster? raster;
+
+  /// Why the page or the document could not be rendered
+  final String? error;
+}
+
+/// A match of [Printing.searchText] in an indexed document
+class PdfTextHit {
+  /// Create a search hit
+  const PdfTextHit({
+    required this.page,
+    required this.start,
+    required this.length,
+    required this.bounds,
+  });
+
+  /// Create a search hit from a dictionnary
+  factory PdfTextHit.fromMap(Map<dynamic, dynamic> map) => PdfTextHit(
+        page: map['page'],
+        start: map['start'],
+        length: map['length'],
+        bounds: PdfRect.fromLTRB(
+          map['left'],
+          map['top'],
+          map['right'],
+          map['bottom'],
+        ),
+      );
+
+  /// The page index
+  final int page;
+
+  /// Index of the first matching character of the page
+  final int start;
+
+  /// Number of matching characters
+  final int length;
+
+  /// Box around the match, in points from the top-left corner of the page
+  final PdfRect bounds;
+
+  @override
+  String toString() => '$runtimeType page $page [$start, ${start + length})';
+}
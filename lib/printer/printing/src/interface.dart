@@ -17,12 +17,15 @@
 import 'dart:async';
 import 'dart:typed_data';
 
-import 'package:flutter/rendering.dart' show Rect;
+import 'package:flutter/rendering.dart' show Rect, Size;
 import 'package:method_channel/printer/pdf/pdf.dart';
 import 'package:plugin_platform_interface/plugin_platform_interface.dart';
 
 import 'callback.dart';
+import 'document_info.dart';
 import 'method_channel.dart';
+import 'print_job_status.dart';
+import 'print_options.dart';
 import 'printer.dart';
 import 'printing_info.dart';
 import 'raster.dart';
@@ -65,8 +68,14 @@ abstract class PrintingPlatform extends PlatformInterface {
     String name,
     PdfPageFormat format,
     bool dynamicLayout,
-    bool usePrinterSettings,
-  );
+    bool usePrinterSettings, {
+    Duration batchWindow = Duration.zero,
+    String? documentId,
+    PrintOutputMode outputMode = PrintOutputMode.gdi,
+    PdfImposition? imposition,
+    int lookAhead = 0,
+    bool downsample = true,
+  });
 
   /// Enumerate the available printers on the system.
   Future<List<Printer>> listPrinters();
@@ -103,10 +112,158 @@ abstract class PrintingPlatform extends PlatformInterface {
     PdfPageFormat format,
   );
 
-  /// Convert a Pdf document to bitmap images
+  /// Convert a Pdf document to bitmap images, with the text layer of each
+  /// page if [textLayer] is true and the platform supports it, in helper
+  /// processes if [isolated] is true and the platform supports it
   Stream<PdfRaster> raster(
+    Uint8List document,
+    List<int>? pages,
+    double dpi, {
+    bool textLayer = false,
+    bool isolated = false,
+    PdfImposition? imposition,
+  });
+
+  /// Start the helper processes used by [raster] with isolated set, and
+  /// return their number
+  Future<int> startRasterWorkers(int? workers) {
+    throw UnimplementedError('startRasterWorkers() has not been implemented.');
+  }
+
+  /// Convert pages of a Pdf document to thumbnails packed in one bitmap
+  Future<PdfRasterAtlas> rasterAtlas(
     Uint8List document,
     List<int>? pages,
     double dpi,
-  );
+    int maxWidth,
+  ) {
+    throw UnimplementedError('rasterAtlas() has not been implemented.');
+  }
+
+  /// Convert the same pages of many Pdf documents, given as bytes or file
+  /// paths, to bitmap images
+  Stream<PdfBatchRaster> rasterBatch(
+    List<Object> documents,
+    List<int>? pages,
+    double dpi,
+  ) {
+    throw UnimplementedError('rasterBatch() has not been implemented.');
+  }
+
+  /// Live and peak bytes held natively, per category, globally and per job
+  Future<Map<String, dynamic>> memoryStats() {
+    throw UnimplementedError('memoryStats() has not been implemented.');
+  }
+
+  /// Hits, misses and prefetch counters of the native cache of rendered
+  /// pages
+  Future<Map<String, dynamic>> prefetchStats() {
+    throw UnimplementedError('prefetchStats() has not been implemented.');
+  }
+
+  /// Hits, misses, entries and bytes of the native cache of laid out
+  /// documents
+  Future<Map<String, int>> layoutCacheStats() {
+    throw UnimplementedError('layoutCacheStats() has not been implemented.');
+  }
+
+  /// Index the text of [document] under [documentId], and save the index to
+  /// [path] if set. Returns the number of pages indexed.
+  Future<int> indexDocument(
+    String documentId,
+    Uint8List document,
+    String? path,
+  ) {
+    throw UnimplementedError('indexDocument() has not been implemented.');
+  }
+
+  /// Load an index saved by [indexDocument] under [documentId]
+  Future<bool> loadTextIndex(String documentId, String path) {
+    throw UnimplementedError('loadTextIndex() has not been implemented.');
+  }
+
+  /// Find [query] in the document indexed under [documentId]
+  Future<List<PdfTextHit>> searchText(
+    String documentId,
+    String query,
+    int limit,
+  ) {
+    throw UnimplementedError('searchText() has not been implemented.');
+  }
+
+  /// Release the index of [documentId]
+  Future<void> closeTextIndex(String documentId) {
+    throw UnimplementedError('closeTextIndex() has not been implemented.');
+  }
+
+  /// Read the page count, page sizes and print preferences of a Pdf document
+  Future<PdfDocumentInfo> probeDocument(Uint8List document) {
+    throw UnimplementedError('probeDocument() has not been implemented.');
+  }
+
+  /// Parse a Pdf document once and keep it open until [closeDocument]
+  Future<PdfDocumentHandle> openDocument(Uint8List document) {
+    throw UnimplementedError('openDocument() has not been implemented.');
+  }
+
+  /// Convert a page of an open document to a bitmap image, at [dpi] or at
+  /// the physical resolution of [width] logical pixels if set
+  Future<PdfRaster> rasterPage(
+    int handle,
+    int page,
+    double dpi, {
+    bool textLayer = false,
+    double? width,
+  }) {
+    throw UnimplementedError('rasterPage() has not been implemented.');
+  }
+
+  /// Tell the platform which pages of an open document are on screen and
+  /// their width in logical pixels, to render them again on DPI changes
+  Future<void> setVisiblePages(int handle, List<int> pages, double width) {
+    throw UnimplementedError('setVisiblePages() has not been implemented.');
+  }
+
+  /// Release a document opened by [openDocument]
+  Future<void> closeDocument(int handle) {
+    throw UnimplementedError('closeDocument() has not been implemented.');
+  }
+
+  /// Create a texture to show the pages of an open document, returns its id
+  Future<int> createDocumentTexture(int handle) {
+    throw UnimplementedError(
+        'createDocumentTexture() has not been implemented.');
+  }
+
+  /// Create a texture to show the pages of a Pdf document, returns its id
+  Future<int> createPageTexture(Uint8List document) {
+    throw UnimplementedError('createPageTexture() has not been implemented.');
+  }
+
+  /// Render a page into the texture, returns the size of the rendered frame
+  /// or null if the page was not rendered
+  Future<Size?> renderPageTexture(int texture, int page, double dpi) {
+    throw UnimplementedError('renderPageTexture() has not been implemented.');
+  }
+
+  /// Release a texture created by [createPageTexture]
+  Future<void> disposePageTexture(int texture) {
+    throw UnimplementedError('disposePageTexture() has not been implemented.');
+  }
+
+  /// Status of a print job, null if the job is unknown
+  Future<PrintJobStatus?> printJobStatus(int job) {
+    throw UnimplementedError('printJobStatus() has not been implemented.');
+  }
+
+  /// Cancel a print job, returns false if it cannot be cancelled
+  Future<bool> cancelPrintJob(int job) {
+    throw UnimplementedError('cancelPrintJob() has not been implemented.');
+  }
+
+  /// Send the print jobs to another print server, "host[:port]", or to the
+  /// default one if null
+  Future<void> setPrintServer(String? server) {
+    throw UnimplementedError('setPrintServer() has not been implemented.');
+  }
 }
@@ -2,14 +2,17 @@ import 'dart:async';
 import 'dart:typed_data';
 
 import 'package:flutter/foundation.dart';
-import 'package:flutter/rendering.dart' show Rect;
+import 'package:flutter/rendering.dart' show Rect, Size;
 import 'package:flutter/services.dart';
 import 'package:method_channel/printer/pdf/pdf.dart';
 
 import 'callback.dart';
+import 'document_info.dart';
 import 'interface.dart';
 import 'method_channel_ffi.dart' if (dart.library.js) 'method_channel_js.dart';
 import 'print_job.dart';
+import 'print_job_status.dart';
+import 'print_options.dart';
 import 'printer.dart';
 import 'printing_info.dart';
 import 'raster.dart';
@@ -23,6 +26,38 @@ class MethodChannelPrinting extends PrintingPlatform {
 
   static final _printJobs = PrintJobs();
 
+  static final _printersChanged = StreamController<List<Printer>>.broadcast();
+
+  /// Printer list pushed by the platform when printers are added, removed
+  /// or change availability
+  static Stream<List<Printer>> get onPrintersChanged =>
+      _printersChanged.stream;
+
+  static final _devicePixelRatioChanged = StreamController<double>.broadcast();
+
+  /// Device pixel ratio of the window, pushed by the platform when the
+  /// window moves to a monitor with another DPI
+  static Stream<double> get onDevicePixelRatioChanged =>
+      _devicePixelRatioChanged.stream;
+
+  static final _pageRerendered = StreamController<PdfPageRender>.broadcast();
+
+  /// Visible pages rendered again by the platform after a DPI change, see
+  /// [setVisiblePages]
+  static Stream<PdfPageRender> get onPageRerendered => _pageRerendered.stream;
+
+  static final _printJobStatus = StreamController<PrintJobStatus>.broadcast();
+
+  /// Progress of the print jobs, pushed by the platform while a document is
+  /// sent and when it is done
+  static Stream<PrintJobStatus> get onPrintJobStatus => _printJobStatus.stream;
+
+  static final _pageSpooled = StreamController<PrintSpoolProgress>.broadcast();
+
+  /// Pages of the print jobs handed to the spooler, sent in batches at most
+  /// four times per second
+  static Stream<PrintSpoolProgress> get onPageSpooled => _pageSpooled.stream;
+
   /// Callbacks from platform plugin
   static Future<dynamic> _handleMethod(MethodCall call) async {
     switch (call.method) {
@@ -105,6 +140,7 @@ class MethodChannelPrinting extends PrintingPlatform {
             call.arguments['width'],
             call.arguments['height'],
             call.arguments['image'],
+            textLayer: call.arguments['text'],
           );
           job.onPageRasterized!.add(raster);
         }
@@ -120,6 +156,58 @@ class MethodChannelPrinting extends PrintingPlatform {
           _printJobs.remove(job.index);
         }
         break;
+      case 'onBatchRasterized':
+        final job = _printJobs.getJob(call.arguments['job']);
+        if (job != null) {
+          final String? error = call.arguments['error'];
+          job.onBatchRasterized!.add(PdfBatchRaster(
+            call.arguments['document'],
+            call.arguments['page'],
+            raster: error == null
+                ? PdfRaster(
+                    call.arguments['width'],
+                    call.arguments['height'],
+                    call.arguments['image'],
+                  )
+                : null,
+            error: error,
+          ));
+        }
+        break;
+      case 'onBatchEnd':
+        final job = _printJobs.getJob(call.arguments['job']);
+        if (job != null) {
+          await job.onBatchRasterized!.close();
+          _printJobs.remove(job.index);
+        }
+        break;
+      case 'onPrintersChanged':
+        final printers = <Printer>[];
+        for (final printer in call.arguments['printers']) {
+          printers.add(Printer.fromMap(printer));
+        }
+        _printersChanged.add(printers);
+        break;
+      case 'onDevicePixelRatioChanged':
+        _devicePixelRatioChanged.add(call.arguments['devicePixelRatio']);
+        break;
+      case 'onPageRerendered':
+        _pageRerendered.add(PdfPageRender(
+          call.arguments['handle'],
+          call.arguments['page'],
+          PdfRaster(
+            call.arguments['width'],
+            call.arguments['height'],
+            call.arguments['image'],
+          ),
+        ));
+        break;
+      case 'onJobProgress':
+        _printJobStatus.add(PrintJobStatus.fromMap(call.arguments));
+        break;
+      case 'onPageSpooled':
+        _pageSpooled.add(PrintSpoolProgress.fromMap(call.arguments));
+        break;
     }
   }
 
@@ -153,8 +241,14 @@ class MethodChannelPrinting extends PrintingPlatform {
     String name,
     PdfPageFormat format,
     bool dynamicLayout,
-    bool usePrinterSettings,
-  ) async {
+    bool usePrinterSettings, {
+    Duration batchWindow = Duration.zero,
+    String? documentId,
+    PrintOutputMode outputMode = PrintOutputMode.gdi,
+    PdfImposition? imposition,
+    int lookAhead = 0,
+    bool downsample = true,
+  }) async {
     final job = _printJobs.add(
       onCompleted: Completer<bool>(),
       onLayout: onLayout,
@@ -172,6 +266,13 @@ class MethodChannelPrinting extends PrintingPlatform {
       'marginBottom': format.marginBottom,
       'dynamic': dynamicLayout,
       'usePrinterSettings': usePrinterSettings,
+      if (batchWindow > Duration.zero)
+        'batchWindow': batchWindow.inMilliseconds,
+      if (documentId != null) 'documentId': documentId,
+      'outputMode': outputMode.name,
+      ...?imposition?.toMap(),
+      if (lookAhead > 0) 'lookAhead': lookAhead,
+      'downsample': downsample,
     };
 
     await _channel.invokeMethod<int>('printPdf', params);
@@ -266,8 +367,11 @@ class MethodChannelPrinting extends PrintingPlatform {
   Stream<PdfRaster> raster(
     Uint8List document,
     List<int>? pages,
-    double dpi,
-  ) {
+    double dpi, {
+    bool textLayer = false,
+    bool isolated = false,
+    PdfImposition? imposition,
+  }) {
     final job = _printJobs.add(
       onPageRasterized: StreamController<PdfRaster>(),
     );
@@ -277,9 +381,275 @@ class MethodChannelPrinting extends PrintingPlatform {
       'pages': pages,
       'scale': dpi / PdfPageFormat.inch,
       'job': job.index,
+      'textLayer': textLayer,
+      'isolated': isolated,
+      ...?imposition?.toMap(),
     };
 
     _channel.invokeMethod<void>('rasterPdf', params);
     return job.onPageRasterized!.stream;
   }
+
+  @override
+  Future<int> startRasterWorkers(int? workers) async {
+    final result = await _channel.invokeMethod<int>(
+      'startRasterWorkers',
+      <String, dynamic>{'workers': workers},
+    );
+    return result!;
+  }
+
+  @override
+  Future<PdfRasterAtlas> rasterAtlas(
+    Uint8List document,
+    List<int>? pages,
+    double dpi,
+    int maxWidth,
+  ) async {
+    final params = <String, dynamic>{
+      'doc': document,
+      'pages': pages,
+      'scale': dpi / PdfPageFormat.inch,
+      'maxWidth': maxWidth,
+    };
+
+    final result = await _channel.invokeMethod<Map>('rasterAtlas', params);
+    return PdfRasterAtlas(
+      PdfRaster(result!['width'], result['height'], result['image']),
+      result['rects'],
+    );
+  }
+
+  @override
+  Stream<PdfBatchRaster> rasterBatch(
+    List<Object> documents,
+    List<int>? pages,
+    double dpi,
+  ) {
+    final job = _printJobs.add(
+      onBatchRasterized: StreamController<PdfBatchRaster>(),
+    );
+
+    final params = <String, dynamic>{
+      'docs': documents,
+      'pages': pages,
+      'scale': dpi / PdfPageFormat.inch,
+      'job': job.index,
+    };
+
+    _channel.invokeMethod<void>('rasterBatch', params);
+    return job.onBatchRasterized!.stream;
+  }
+
+  @override
+  Future<Map<String, dynamic>> memoryStats() async {
+    final result = await _channel.invokeMethod<Map>(
+      'memoryStats',
+      <String, dynamic>{},
+    );
+    return result!.cast<String, dynamic>();
+  }
+
+  @override
+  Future<Map<String, dynamic>> prefetchStats() async {
+    final result = await _channel.invokeMethod<Map>(
+      'prefetchStats',
+      <String, dynamic>{},
+    );
+    return result!.cast<String, dynamic>();
+  }
+
+  @override
+  Future<Map<String, int>> layoutCacheStats() async {
+    final result = await _channel.invokeMethod<Map>(
+      'layoutCacheStats',
+      <String, dynamic>{},
+    );
+    return result!.cast<String, int>();
+  }
+
+  @override
+  Future<int> indexDocument(
+    String documentId,
+    Uint8List document,
+    String? path,
+  ) async {
+    final result = await _channel.invokeMethod<Map>(
+      'indexDocument',
+      <String, dynamic>{
+        'documentId': documentId,
+        'doc': document,
+        if (path != null) 'path': path,
+      },
+    );
+    return result!['pages'];
+  }
+
+  @override
+  Future<bool> loadTextIndex(String documentId, String path) async {
+    final result = await _channel.invokeMethod<bool>(
+      'loadTextIndex',
+      <String, dynamic>{'documentId': documentId, 'path': path},
+    );
+    return result!;
+  }
+
+  @override
+  Future<List<PdfTextHit>> searchText(
+    String documentId,
+    String query,
+    int limit,
+  ) async {
+    final result = await _channel.invokeMethod<List>(
+      'searchText',
+      <String, dynamic>{
+        'documentId': documentId,
+        'query': query,
+        'limit': limit,
+      },
+    );
+    return result!.map((hit) => PdfTextHit.fromMap(hit)).toList();
+  }
+
+  @override
+  Future<void> closeTextIndex(String documentId) async {
+    await _channel.invokeMethod<void>(
+      'closeTextIndex',
+      <String, dynamic>{'documentId': documentId},
+    );
+  }
+
+  @override
+  Future<PdfDocumentInfo> probeDocument(Uint8List document) async {
+    final result = await _channel.invokeMethod<Map>(
+      'probeDocument',
+      <String, dynamic>{'doc': document},
+    );
+    return PdfDocumentInfo.fromMap(result!);
+  }
+
+  @override
+  Future<PdfDocumentHandle> openDocument(Uint8List document) async {
+    final result = await _channel.invokeMethod<Map>(
+      'openDocument',
+      <String, dynamic>{'doc': document},
+    );
+    return PdfDocumentHandle(
+      result!['handle'],
+      PdfDocumentInfo.fromMap(result),
+    );
+  }
+
+  @override
+  Future<PdfRaster> rasterPage(
+    int handle,
+    int page,
+    double dpi, {
+    bool textLayer = false,
+    double? width,
+  }) async {
+    final result = await _channel.invokeMethod<Map>(
+      'rasterPage',
+      <String, dynamic>{
+        'handle': handle,
+        'page': page,
+        'scale': dpi / PdfPageFormat.inch,
+        'width': width,
+        'textLayer': textLayer,
+      },
+    );
+    return PdfRaster(
+      result!['width'],
+      result['height'],
+      result['image'],
+      textLayer: result['text'],
+    );
+  }
+
+  @override
+  Future<void> setVisiblePages(int handle, List<int> pages, double width) async {
+    await _channel.invokeMethod<void>(
+      'setVisiblePages',
+      <String, dynamic>{'handle': handle, 'pages': pages, 'width': width},
+    );
+  }
+
+  @override
+  Future<void> closeDocument(int handle) async {
+    await _channel.invokeMethod<void>(
+      'closeDocument',
+      <String, dynamic>{'handle': handle},
+    );
+  }
+
+  @override
+  Future<int> createDocumentTexture(int handle) async {
+    final result = await _channel.invokeMethod<int>(
+      'createTexture',
+      <String, dynamic>{'handle': handle},
+    );
+    return result!;
+  }
+
+  @override
+  Future<int> createPageTexture(Uint8List document) async {
+    final result = await _channel.invokeMethod<int>(
+      'createTexture',
+      <String, dynamic>{'doc': document},
+    );
+    return result!;
+  }
+
+  @override
+  Future<Size?> renderPageTexture(int texture, int page, double dpi) async {
+    final result = await _channel.invokeMethod<Map>(
+      'renderTexture',
+      <String, dynamic>{
+        'texture': texture,
+        'page': page,
+        'scale': dpi / PdfPageFormat.inch,
+      },
+    );
+    if (result == null) {
+      return null;
+    }
+    return Size(
+      (result['width'] as int).toDouble(),
+      (result['height'] as int).toDouble(),
+    );
+  }
+
+  @override
+  Future<void> disposePageTexture(int texture) async {
+    await _channel.invokeMethod<void>(
+      'disposeTexture',
+      <String, dynamic>{'texture': texture},
+    );
+  }
+
+  @override
+  Future<PrintJobStatus?> printJobStatus(int job) async {
+    final result = await _channel.invokeMethod<Map>(
+      'printJobStatus',
+      <String, dynamic>{'job': job},
+    );
+    return result == null ? null : PrintJobStatus.fromMap(result);
+  }
+
+  @override
+  Future<bool> cancelPrintJob(int job) async {
+    final result = await _channel.invokeMethod<bool>(
+      'cancelPrintJob',
+      <String, dynamic>{'job': job},
+    );
+    return result ?? false;
+  }
+
+  @override
+  Future<void> setPrintServer(String? server) async {
+    await _channel.invokeMethod<void>(
+      'setPrintServer',
+      <String, dynamic>{if (server != null) 'server': server},
+    );
+  }
 }
@@ -19,6 +19,7 @@ import 'dart:io';
 import 'dart:typed_data';
 
 import 'callback.dart';
+import 'document_info.dart';
 import 'raster.dart';
 
 /// Represents a print job to communicate with the platform implementation
@@ -30,6 +31,7 @@ class PrintJob {
     this.onHtmlRendered,
     this.onCompleted,
     this.onPageRasterized,
+    this.onBatchRasterized,
     required this.useFFI,
   });
 
@@ -45,6 +47,9 @@ class PrintJob {
   /// Stream of rasterized pages
   final StreamController<PdfRaster>? onPageRasterized;
 
+  /// Stream of the pages of a batch of documents
+  final StreamController<PdfBatchRaster>? onBatchRasterized;
+
   /// The Job number
   final int index;
 
@@ -67,6 +72,7 @@ class PrintJobs {
     Completer<Uint8List>? onHtmlRendered,
     Completer<bool>? onCompleted,
     StreamController<PdfRaster>? onPageRasterized,
+    StreamController<PdfBatchRaster>? onBatchRasterized,
   }) {
     final job = PrintJob._(
       index: _currentIndex++,
@@ -74,6 +80,7 @@ class PrintJobs {
       onHtmlRendered: onHtmlRendered,
       onCompleted: onCompleted,
       onPageRasterized: onPageRasterized,
+      onBatchRasterized: onBatchRasterized,
       useFFI: Platform.isMacOS || Platform.isIOS,
     );
     _printJobs[job.index] = job;
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2017, David PHAM-VAN <dev.nfet.net@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// Progress of a document sent to a printer
+class PrintJobStatus {
+  /// Create a print job status
+  const PrintJobStatus({
+    required this.job,
+    required this.name,
+    required this.state,
+    this.sent = 0,
+    this.total = 0,
+    this.printerJob = 0,
+    this.printerState,
+    this.error,
+    this.pages,
+    this.rasterPages,
+    this.imageBytes,
+    this.rasterBytes,
+    this.spoolBytes,
+    this.spoolTime,
+  });
+
+  /// Create a print job status from a dictionnary
+  factory PrintJobStatus.fromMap(Map<dynamic, dynamic> map) => PrintJobStatus(
+        job: map['job'],
+        name: map['name'],
+        state: map['state'],
+        sent: map['sent'] ?? 0,
+        total: map['total'] ?? 0,
+        printerJob: map['printerJob'] ?? 0,
+        printerState: map['printerState'],
+        error: map['error'],
+        pages: map['pages'],
+        rasterPages: map['rasterPages'],
+        imageBytes: map['imageBytes'],
+        rasterBytes: map['rasterBytes'],
+        spoolBytes: map['spoolBytes'],
+        spoolTime: map['spoolTime'] == null
+            ? null
+            : Duration(microseconds: (map['spoolTime'] * 1000).round()),
+      );
+
+  /// Identifier of the job
+  final int job;
+
+  /// Document name
+  final String name;
+
+  /// layout, sending, sent or failed
+  final String state;
+
+  /// Bytes sent to the printer
+  final int sent;
+
+  /// Size of the document in bytes, 0 until the layout is done
+  final int total;
+
+  /// Job id given by the printer, 0 until the job is created
+  final int printerJob;
+
+  /// IPP job state once sent: pending, processing, completed, ...
+  final String? printerState;
+
+  /// Reason of the failure
+  final String? error;
+
+  /// Pages spooled, once sent
+  final int? pages;
+
+  /// Image-heavy pages sent as a bitmap at the printer resolution rather
+  /// than with their full resolution images
+  final int? rasterPages;
+
+  /// Decoded size of the images of [rasterPages]
+  final int? imageBytes;
+
+  /// Size of the bitmaps that replaced them
+  final int? rasterBytes;
+
+  /// Size of the spool job, -1 if the spooler did not tell
+  final int? spoolBytes;
+
+  /// Time taken to render and spool the document
+  final Duration? spoolTime;
+
+  /// Part of the document sent, from 0 to 1
+  double get progress => total > 0 ? sent / total : 0;
+
+  @override
+  String toString() =>
+      '$runtimeType $job "$name" $state $sent/$total ${printerState ?? ''}';
+}
+
+/// Pages handed to the printer spooler since the previous event, sent
+/// while a document is printed
+class PrintSpoolProgress {
+  /// Create a spool progress event
+  const PrintSpoolProgress({
+    required this.job,
+    required this.pages,
+    required this.renderTimes,
+    required this.spoolTimes,
+    required this.spooled,
+    this.spoolBytes = -1,
+    this.pagesPerSecond = 0,
+  });
+
+  /// Create a spool progress event from a dictionnary
+  factory PrintSpoolProgress.fromMap(Map<dynamic, dynamic> map) {
+    Duration toDuration(dynamic ms) =>
+        Duration(microseconds: ((ms as num) * 1000).round());
+
+    return PrintSpoolProgress(
+      job: map['job'],
+      pages: List<int>.from(map['pages']),
+      renderTimes: (map['renderTime'] as List).map(toDuration).toList(),
+      spoolTimes: (map['spoolTime'] as List).map(toDuration).toList(),
+      spooled: map['spooled'],
+      spoolBytes: map['spoolBytes'] ?? -1,
+      pagesPerSecond: map['pagesPerSecond'] ?? 0,
+    );
+  }
+
+  /// Identifier of the job
+  final int job;
+
+  /// Indexes of the pages spooled since the previous event
+  final List<int> pages;
+
+  /// Time taken to render each of [pages]
+  final List<Duration> renderTimes;
+
+  /// Time taken by the spooler to accept each of [pages]
+  final List<Duration> spoolTimes;
+
+  /// Pages spooled since the job started
+  final int spooled;
+
+  /// Size of the spool job so far, -1 if the spooler did not tell
+  final int spoolBytes;
+
+  /// Average rate since the job started
+  final double pagesPerSecond;
+
+  @override
+  String toString() =>
+      '$runtimeType $job $spooled pages ${pagesPerSecond.toStringAsFixed(1)}/s';
+}
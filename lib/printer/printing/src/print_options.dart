@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2017, David PHAM-VAN <dev.nfet.net@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import 'package:meta/meta.dart';
+import 'package:method_channel/printer/pdf/pdf.dart';
+
+/// How a document is handed to the printer
+enum PrintOutputMode {
+  /// Every page is drawn by the platform graphics API and spooled in the
+  /// format of the driver
+  gdi,
+
+  /// Pages are converted to PostScript level 2, vector graphics and fonts
+  /// included. Falls back to [gdi] if the driver does not take PostScript.
+  postScript2,
+
+  /// Pages are converted to PostScript level 3, see [postScript2]
+  postScript3,
+
+  /// The Pdf bytes are sent untouched, for printers that read Pdf
+  /// themselves
+  pdf,
+}
+
+/// How the pages of a document are placed on the printed or rasterized
+/// sheets
+enum PdfImpositionMode {
+  /// [PdfImposition.columns] x [PdfImposition.rows] pages on each sheet, in
+  /// reading order
+  nUp,
+
+  /// Two pages side by side, ordered so that the sheets printed on both
+  /// sides then folded in the middle read in order
+  booklet,
+
+  /// Each page enlarged over [PdfImposition.columns] x [PdfImposition.rows]
+  /// sheets
+  tile,
+}
+
+/// Several pages on each sheet, or a page across several sheets, placed
+/// natively without building a new document
+@immutable
+class PdfImposition {
+  /// Place [columns] x [rows] pages on each sheet
+  const PdfImposition.nUp({this.columns = 2, this.rows = 1, this.sheet})
+      : mode = PdfImpositionMode.nUp;
+
+  /// Place the pages two by two for a folded booklet
+  const PdfImposition.booklet({this.sheet})
+      : mode = PdfImpositionMode.booklet,
+        columns = 2,
+        rows = 1;
+
+  /// Enlarge each page over [columns] x [rows] sheets
+  const PdfImposition.tile({this.columns = 2, this.rows = 2, this.sheet})
+      : mode = PdfImpositionMode.tile;
+
+  /// The placement of the pages
+  final PdfImpositionMode mode;
+
+  /// Pages across a sheet, or sheets across a page when tiled
+  final int columns;
+
+  /// Pages down a sheet, or sheets down a page when tiled
+  final int rows;
+
+  /// The size of the rasterized sheets, the first page fits one sheet if
+  /// null. Printed sheets always have the size of the paper.
+  final PdfPageFormat? sheet;
+
+  /// The method channel arguments
+  Map<String, Object?> toMap() => {
+        'imposition': mode.name,
+        'columns': columns,
+        'rows': rows,
+        if (sheet != null) 'sheetWidth': sheet!.width,
+        if (sheet != null) 'sheetHeight': sheet!.height,
+      };
+}
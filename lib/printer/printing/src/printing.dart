@@ -21,7 +21,10 @@ import 'package:flutter/material.dart';
 import 'package:method_channel/printer/pdf/pdf.dart';
 
 import 'callback.dart';
+import 'document_info.dart';
 import 'interface.dart';
+import 'print_job_status.dart';
+import 'print_options.dart';
 import 'printer.dart';
 import 'printing_info.dart';
 import 'raster.dart';
@@ -39,12 +42,41 @@ mixin Printing {
   /// Set [usePrinterSettings] to true to use the configuration defined by
   /// the printer. May not work for all the printers and can depend on the
   /// drivers. (Supported platforms: Windows)
+  ///
+  /// When [documentId] is set, the document returned by [onLayout] is cached
+  /// natively for these page metrics, and printing the same [documentId]
+  /// again on the same page metrics skips [onLayout]. Change the id when the
+  /// content changes. (Supported platforms: Windows)
+  ///
+  /// [outputMode] chooses how the pages reach the printer. PostScript keeps
+  /// vector graphics and fonts for PostScript drivers, and
+  /// [PrintOutputMode.pdf] sends the document untouched to printers that
+  /// read Pdf.
+  /// (Supported platforms: Windows)
+  ///
+  /// Set [imposition] to print several pages on each sheet, a booklet, or
+  /// each page over several sheets. (Supported platforms: Windows)
+  ///
+  /// With a [lookAhead] of 1 or 2, the next pages are rendered on a worker
+  /// thread while the current one is spooled. Each of them is held as a
+  /// bitmap at the printer resolution, so larger values are clamped to 2.
+  /// (Supported platforms: Windows)
+  ///
+  /// With [downsample], pages whose images outweigh a bitmap of the whole
+  /// page at the printer resolution are sent as that bitmap instead, which
+  /// keeps the spool job small. Set it to false to always send the images
+  /// as they are. (Supported platforms: Windows)
   static Future<bool> layoutPdf({
     required LayoutCallback onLayout,
     String name = 'Document',
     PdfPageFormat format = PdfPageFormat.standard,
     bool dynamicLayout = true,
     bool usePrinterSettings = false,
+    String? documentId,
+    PrintOutputMode outputMode = PrintOutputMode.gdi,
+    PdfImposition? imposition,
+    int lookAhead = 0,
+    bool downsample = true,
   }) {
     return PrintingPlatform.instance.layoutPdf(
       null,
@@ -53,6 +85,11 @@ mixin Printing {
       format,
       dynamicLayout,
       usePrinterSettings,
+      documentId: documentId,
+      outputMode: outputMode,
+      imposition: imposition,
+      lookAhead: lookAhead,
+      downsample: downsample,
     );
   }
 
@@ -128,6 +165,35 @@ mixin Printing {
   /// Set [usePrinterSettings] to true to use the configuration defined by
   /// the printer. May not work for all the printers and can depend on the
   /// drivers. (Supported platforms: Windows)
+  ///
+  /// Jobs sent to the same printer and page format less than [batchWindow]
+  /// apart share one printer device context, so the driver is only set up
+  /// once per burst. Each job is still spooled under its own [name].
+  /// (Supported platforms: Windows)
+  ///
+  /// When [documentId] is set, the document returned by [onLayout] is cached
+  /// natively for these page metrics, and printing the same [documentId]
+  /// again on the same page metrics skips [onLayout]. Change the id when the
+  /// content changes. (Supported platforms: Windows)
+  ///
+  /// [outputMode] chooses how the pages reach the printer. PostScript keeps
+  /// vector graphics and fonts for PostScript drivers, and
+  /// [PrintOutputMode.pdf] sends the document untouched to printers that
+  /// read Pdf.
+  /// (Supported platforms: Windows)
+  ///
+  /// Set [imposition] to print several pages on each sheet, a booklet, or
+  /// each page over several sheets. (Supported platforms: Windows)
+  ///
+  /// With a [lookAhead] of 1 or 2, the next pages are rendered on a worker
+  /// thread while the current one is spooled. Each of them is held as a
+  /// bitmap at the printer resolution, so larger values are clamped to 2.
+  /// (Supported platforms: Windows)
+  ///
+  /// With [downsample], pages whose images outweigh a bitmap of the whole
+  /// page at the printer resolution are sent as that bitmap instead, which
+  /// keeps the spool job small. Set it to false to always send the images
+  /// as they are. (Supported platforms: Windows)
   static FutureOr<bool> directPrintPdf({
     required Printer printer,
     required LayoutCallback onLayout,
@@ -135,6 +201,12 @@ mixin Printing {
     PdfPageFormat format = PdfPageFormat.standard,
     bool dynamicLayout = true,
     bool usePrinterSettings = false,
+    Duration batchWindow = Duration.zero,
+    String? documentId,
+    PrintOutputMode outputMode = PrintOutputMode.gdi,
+    PdfImposition? imposition,
+    int lookAhead = 0,
+    bool downsample = true,
   }) {
     return PrintingPlatform.instance.layoutPdf(
       printer,
@@ -143,6 +215,12 @@ mixin Printing {
       format,
       dynamicLayout,
       usePrinterSettings,
+      batchWindow: batchWindow,
+      documentId: documentId,
+      outputMode: outputMode,
+      imposition: imposition,
+      lookAhead: lookAhead,
+      downsample: downsample,
     );
   }
 
@@ -208,15 +286,269 @@ mixin Printing {
   /// }
   /// ```
   ///
+  /// Set [textLayer] to receive the glyph boxes of each page in
+  /// [PdfRaster.textLayer], for text selection over the image.
+  ///
+  /// Set [isolated] to render in helper processes, see
+  /// [startRasterWorkers]. The text layer is not available then.
+  ///
+  /// Set [imposition] to render sheets of several pages, or tiles of each
+  /// page, instead of the pages themselves. It is ignored when [isolated] is
+  /// set. (Supported platforms: Windows)
+  ///
   /// This is not supported on all platforms. Check the result of [info] to
   /// find at runtime if this feature is available or not.
   static Stream<PdfRaster> raster(
     Uint8List document, {
     List<int>? pages,
     double dpi = PdfPageFormat.inch,
+    bool textLayer = false,
+    bool isolated = false,
+    PdfImposition? imposition,
+  }) {
+    assert(dpi > 0);
+
+    return PrintingPlatform.instance.raster(document, pages, dpi,
+        textLayer: textLayer, isolated: isolated, imposition: imposition);
+  }
+
+  /// Start the helper processes that render the pages of [raster] when
+  /// `isolated` is set, and of [rasterBatch], before the first document
+  /// arrives. Each process
+  /// has its own PDF engine, so the pages of one document render on
+  /// several cores, and a document crashing the engine only ends its
+  /// stream with an error. Returns the number of processes, half the cores
+  /// by default.
+  ///
+  /// Supported platforms: Windows
+  static Future<int> startRasterWorkers({int? workers}) {
+    return PrintingPlatform.instance.startRasterWorkers(workers);
+  }
+
+  /// Render the pages of a PDF as thumbnails packed in a single bitmap,
+  /// received in one message. Suited to page strips showing many pages.
+  ///
+  /// Pages wider than [maxWidth] are scaled down to fit it. The atlas is at
+  /// most 16384 pixels tall, the pages that do not fit are left out and
+  /// missing from [PdfRasterAtlas].
+  ///
+  /// This is not supported on all platforms. Check the result of [info] to
+  /// find at runtime if this feature is available or not.
+  static Future<PdfRasterAtlas> rasterAtlas(
+    Uint8List document, {
+    List<int>? pages,
+    double dpi = 12,
+    int maxWidth = 4096,
+  }) {
+    assert(dpi > 0);
+    assert(maxWidth > 0);
+
+    return PrintingPlatform.instance
+        .rasterAtlas(document, pages, dpi, maxWidth);
+  }
+
+  /// Render the same [pages] of many documents as thumbnails, for library
+  /// and file picker views. Each item of [documents] is the bytes of a PDF
+  /// as a [Uint8List] or the path of a PDF file as a [String].
+  ///
+  /// Documents are rendered in parallel by the helper processes of
+  /// [startRasterWorkers], one per process, and their pages arrive in no
+  /// particular order, tagged with [PdfBatchRaster.document]. A document
+  /// that cannot be read is reported with [PdfBatchRaster.error] and does
+  /// not stop the others.
+  ///
+  /// This is not supported on all platforms.
+  static Stream<PdfBatchRaster> rasterBatch(
+    List<Object> documents, {
+    List<int>? pages,
+    double dpi = 12,
+  }) {
+    assert(dpi > 0);
+    assert(documents.every((d) => d is Uint8List || d is String));
+
+    return PrintingPlatform.instance.rasterBatch(documents, pages, dpi);
+  }
+
+  /// Bytes held by the native side, as `{'global': counters, 'jobs':
+  /// {job: counters}}`. Counters map each category (`document`, `bitmap`,
+  /// `output`, `message`) to its `live` and `peak` byte counts. Finished
+  /// jobs are kept for a while.
+  ///
+  /// This is not supported on all platforms.
+  static Future<Map<String, dynamic>> memoryStats() {
+    return PrintingPlatform.instance.memoryStats();
+  }
+
+  /// Hits, misses, speculative renders and their hit ratio, cancelled
+  /// renders, entries and bytes of the native cache of rendered pages of
+  /// open documents.
+  ///
+  /// This is not supported on all platforms.
+  static Future<Map<String, dynamic>> prefetchStats() {
+    return PrintingPlatform.instance.prefetchStats();
+  }
+
+  /// Hits, misses, entries and bytes of the native cache of documents
+  /// laid out for a [documentId].
+  ///
+  /// This is not supported on all platforms.
+  static Future<Map<String, int>> layoutCacheStats() {
+    return PrintingPlatform.instance.layoutCacheStats();
+  }
+
+  /// Extract and index the text of [document] under [documentId], so that
+  /// [searchText] never goes back to the Pdf. The index is also saved to
+  /// [path] if set, to be loaded with [loadTextIndex] without the document.
+  /// Returns the number of pages indexed.
+  ///
+  /// This is not supported on all platforms.
+  static Future<int> indexDocument(
+    String documentId,
+    Uint8List document, {
+    String? path,
+  }) {
+    return PrintingPlatform.instance.indexDocument(documentId, document, path);
+  }
+
+  /// Load an index saved by [indexDocument] under [documentId]. Returns false
+  /// if the file is missing, corrupt or from another version.
+  ///
+  /// This is not supported on all platforms.
+  static Future<bool> loadTextIndex(String documentId, String path) {
+    return PrintingPlatform.instance.loadTextIndex(documentId, path);
+  }
+
+  /// Find the words of [query], consecutive and in order, in the document
+  /// indexed under [documentId]. Returns at most [limit] hits, in page order.
+  ///
+  /// This is not supported on all platforms.
+  static Future<List<PdfTextHit>> searchText(
+    String documentId,
+    String query, {
+    int limit = 100,
+  }) {
+    assert(limit > 0);
+
+    return PrintingPlatform.instance.searchText(documentId, query, limit);
+  }
+
+  /// Release the index of [documentId]
+  static Future<void> closeTextIndex(String documentId) {
+    return PrintingPlatform.instance.closeTextIndex(documentId);
+  }
+
+  /// Read the page count, page sizes and print preferences of [document]
+  /// without rendering it, to lay out a preview before any page is ready.
+  ///
+  /// This is not supported on all platforms.
+  static Future<PdfDocumentInfo> probeDocument(Uint8List document) {
+    return PrintingPlatform.instance.probeDocument(document);
+  }
+
+  /// Parse [document] once and keep it open on the native side, so that
+  /// [rasterPage] requests only carry the handle and the page index.
+  /// Call [closeDocument] when done.
+  ///
+  /// This is not supported on all platforms.
+  static Future<PdfDocumentHandle> openDocument(Uint8List document) {
+    return PrintingPlatform.instance.openDocument(document);
+  }
+
+  /// Convert one page of a document opened with [openDocument] to an image.
+  ///
+  /// Set [width] to the width of the page on screen in logical pixels to
+  /// render at exactly the physical resolution of the window instead of
+  /// [dpi].
+  static Future<PdfRaster> rasterPage(
+    int handle,
+    int page, {
+    double dpi = PdfPageFormat.inch,
+    bool textLayer = false,
+    double? width,
+  }) {
+    assert(dpi > 0);
+
+    return PrintingPlatform.instance
+        .rasterPage(handle, page, dpi, textLayer: textLayer, width: width);
+  }
+
+  /// Tell the platform which pages of an open document are on screen, and
+  /// their width in logical pixels. When the window DPI changes they are
+  /// rendered again and sent to `MethodChannelPrinting.onPageRerendered`.
+  static Future<void> setVisiblePages(
+    int handle,
+    List<int> pages,
+    double width,
+  ) {
+    return PrintingPlatform.instance.setVisiblePages(handle, pages, width);
+  }
+
+  /// Release a document opened with [openDocument]
+  static Future<void> closeDocument(int handle) {
+    return PrintingPlatform.instance.closeDocument(handle);
+  }
+
+  /// Create a Flutter texture showing the pages of a document opened with
+  /// [openDocument]. See [createPageTexture].
+  static Future<int> createDocumentTexture(int handle) {
+    return PrintingPlatform.instance.createDocumentTexture(handle);
+  }
+
+  /// Create a Flutter texture showing the pages of [document], to be
+  /// displayed with `Texture(textureId: id)`. Pages are rendered natively
+  /// with [renderPageTexture], without sending pixels over the channel.
+  ///
+  /// On Linux, pages are rendered only when the runner was built with
+  /// PDFium, otherwise the call fails with a `MissingPluginException`, and
+  /// [createDocumentTexture] is not available.
+  ///
+  /// (Supported platforms: Windows, Linux)
+  static Future<int> createPageTexture(Uint8List document) {
+    return PrintingPlatform.instance.createPageTexture(document);
+  }
+
+  /// Render [page] of the texture document at [dpi] and show it.
+  /// Returns the size in pixels of the new frame, or null if the page cannot
+  /// be rendered or a newer render of the same texture was requested.
+  static Future<Size?> renderPageTexture(
+    int texture,
+    int page, {
+    double dpi = PdfPageFormat.inch,
   }) {
     assert(dpi > 0);
 
-    return PrintingPlatform.instance.raster(document, pages, dpi);
+    return PrintingPlatform.instance.renderPageTexture(texture, page, dpi);
+  }
+
+  /// Release a texture created by [createPageTexture]
+  static Future<void> disposePageTexture(int texture) {
+    return PrintingPlatform.instance.disposePageTexture(texture);
+  }
+
+  /// Status of a print job, as sent to
+  /// `MethodChannelPrinting.onPrintJobStatus`, null if the job is unknown or
+  /// finished long ago.
+  ///
+  /// Supported platforms: Linux
+  static Future<PrintJobStatus?> printJobStatus(int job) {
+    return PrintingPlatform.instance.printJobStatus(job);
+  }
+
+  /// Cancel a print job, while its document is laid out or sent, or once
+  /// it is queued on the printer. Returns false if the job is unknown or the
+  /// printer refused.
+  ///
+  /// Supported platforms: Linux
+  static Future<bool> cancelPrintJob(int job) {
+    return PrintingPlatform.instance.cancelPrintJob(job);
+  }
+
+  /// Send the print jobs and printer queries to the CUPS server at
+  /// "host[:port]", for example a test server, or to the default one if
+  /// [server] is null.
+  ///
+  /// Supported platforms: Linux
+  static Future<void> setPrintServer(String? server) {
+    return PrintingPlatform.instance.setPrintServer(server);
   }
 }
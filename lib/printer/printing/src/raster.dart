@@ -27,8 +27,9 @@ class PdfRaster {
   const PdfRaster(
     this.width,
     this.height,
-    this.pixels,
-  );
+    this.pixels, {
+    this.textLayer,
+  });
 
   /// The width of the image
   final int width;
@@ -39,6 +40,13 @@ class PdfRaster {
   /// The raw RGBA pixels of the image
   final Uint8List pixels;
 
+  /// The glyphs of the page, if requested, packed little-endian as:
+  /// `uint32 count`, `float32 pageWidth, pageHeight`,
+  /// `uint32 codepoints[count]`, `uint16 boxes[count * 4]`.
+  /// Each box is left, top, right, bottom in 1/65535 of the page size,
+  /// from the top-left corner.
+  final Uint8List? textLayer;
+
   @override
   String toString() => 'Image ${width}x$height ${width * height * 4} bytes';
 
@@ -68,6 +76,35 @@ class PdfRaster {
   }
 }
 
+/// Thumbnails of several pages packed into one bitmap
+class PdfRasterAtlas {
+  /// Create an atlas from its bitmap and page rectangles
+  const PdfRasterAtlas(this.raster, this.rects);
+
+  /// The bitmap holding every page
+  final PdfRaster raster;
+
+  /// Page index, x, y, width and height of each page in [raster]
+  final Int32List rects;
+
+  /// Number of pages in the atlas
+  int get length => rects.length ~/ 5;
+
+  /// The page index of the nth thumbnail
+  int pageAt(int n) => rects[n * 5];
+
+  /// The area of the nth thumbnail in [raster]
+  Rect rectAt(int n) => Rect.fromLTWH(
+        rects[n * 5 + 1].toDouble(),
+        rects[n * 5 + 2].toDouble(),
+        rects[n * 5 + 3].toDouble(),
+        rects[n * 5 + 4].toDouble(),
+      );
+
+  @override
+  String toString() => 'Atlas of $length pages, $raster';
+}
+
 /// Image provider for a [PdfRaster]
 class PdfRasterImage extends ImageProvider<PdfRaster> {
   /// Create an ImageProvider from a [PdfRaster]
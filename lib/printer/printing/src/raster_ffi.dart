@@ -0,0 +1,301 @@
+/*
+ * Copyright (C) 2017, David PHAM-VAN <dev.nfet.net@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import 'dart:ffi' as ffi;
+import 'dart:io' as io;
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart' as ffi;
+import 'package:method_channel/printer/pdf/pdf.dart';
+
+import 'raster.dart';
+
+/// Version of the native interface these bindings were written for
+const _rasterVersion = 1;
+
+const _statusOk = 0;
+const _statusBadDocument = 2;
+const _statusBadPage = 3;
+const _statusOutOfMemory = 4;
+
+/// Load the dynamic library, installed next to the Flutter library
+final ffi.DynamicLibrary? _dynamicLibrary = _open();
+ffi.DynamicLibrary? _open() {
+  if (!io.Platform.isLinux) {
+    return null;
+  }
+
+  final bundle = io.File(io.Platform.resolvedExecutable).parent.path;
+  try {
+    return ffi.DynamicLibrary.open('$bundle/lib/libprinting_raster.so');
+  } on ArgumentError {
+    // Built without PDFium
+    return null;
+  }
+}
+
+final _RasterBindings? _bindings = _dynamicLibrary == null
+    ? null
+    : _RasterBindings(_dynamicLibrary!);
+
+_RasterBindings _require() {
+  final bindings = _bindings;
+  if (bindings == null || bindings.version() < _rasterVersion) {
+    throw UnsupportedError('The raster library is not available');
+  }
+  return bindings;
+}
+
+String _statusMessage(int status) {
+  switch (status) {
+    case _statusBadDocument:
+      return 'Cannot raster a malformed PDF file';
+    case _statusBadPage:
+      return 'Cannot raster this page';
+    case _statusOutOfMemory:
+      return 'Not enough memory to raster this page';
+  }
+  return 'Invalid raster arguments';
+}
+
+/// RGBA pixels in native memory owned by the caller, rendered into by
+/// [PdfRasterDocument.render] without any copy.
+class PdfRasterBitmap {
+  /// Allocate a bitmap of [width] x [height] pixels
+  factory PdfRasterBitmap(int width, int height) {
+    assert(width > 0 && height > 0);
+    final size = width * height * 4;
+    return PdfRasterBitmap._(width, height, ffi.calloc<ffi.Uint8>(size), size);
+  }
+
+  PdfRasterBitmap._(this.width, this.height, this._data, int size)
+      : pixels = _data.asTypedList(size);
+
+  /// The width of the bitmap
+  final int width;
+
+  /// The height of the bitmap
+  final int height;
+
+  /// The raw RGBA pixels, valid until [dispose] is called
+  final Uint8List pixels;
+
+  ffi.Pointer<ffi.Uint8> _data;
+
+  /// Copy the pixels to a [PdfRaster] held by the Dart heap
+  PdfRaster toRaster() => PdfRaster(width, height, Uint8List.fromList(pixels));
+
+  /// Free the native memory
+  void dispose() {
+    if (_data != ffi.nullptr) {
+      ffi.calloc.free(_data);
+      _data = ffi.nullptr;
+    }
+  }
+}
+
+/// A PDF document opened by the native raster library.
+///
+/// Unlike [Printing.raster], the pages are rendered synchronously on the
+/// calling isolate, with no platform channel, so it is meant to be used
+/// from a background isolate. Only available on Linux when the runner is
+/// built with PDFium.
+class PdfRasterDocument {
+  PdfRasterDocument._(this._bindings, this._handle);
+
+  /// Parse a copy of [document]. Throws an [Exception] if the document
+  /// cannot be loaded.
+  factory PdfRasterDocument.open(Uint8List document) {
+    final bindings = _require();
+    final nativeBytes = ffi.calloc<ffi.Uint8>(document.length);
+    final status = ffi.calloc<ffi.Int32>();
+    try {
+      nativeBytes.asTypedList(document.length).setAll(0, document);
+      final handle = bindings.open(nativeBytes, document.length, status);
+      if (handle == ffi.nullptr) {
+        throw Exception(_statusMessage(status.value));
+      }
+      return PdfRasterDocument._(bindings, handle);
+    } finally {
+      ffi.calloc.free(nativeBytes);
+      ffi.calloc.free(status);
+    }
+  }
+
+  /// Whether the native raster library is available on this platform
+  static bool get isAvailable =>
+      _bindings != null && _bindings!.version() >= _rasterVersion;
+
+  final _RasterBindings _bindings;
+
+  ffi.Pointer<ffi.Void> _handle;
+
+  /// The number of pages
+  int get pageCount => _bindings.pageCount(_checked());
+
+  /// The size of [page] in PDF points, read without rendering it
+  PdfPoint pageSize(int page) {
+    final width = ffi.calloc<ffi.Double>();
+    final height = ffi.calloc<ffi.Double>();
+    try {
+      final status = _bindings.pageSize(_checked(), page, width, height);
+      if (status != _statusOk) {
+        throw Exception(_statusMessage(status));
+      }
+      return PdfPoint(width.value, height.value);
+    } finally {
+      ffi.calloc.free(width);
+      ffi.calloc.free(height);
+    }
+  }
+
+  /// Render [page] scaled to the size of [bitmap]
+  void render(int page, PdfRasterBitmap bitmap) {
+    if (bitmap._data == ffi.nullptr) {
+      throw StateError('The bitmap was disposed');
+    }
+
+    final status = _bindings.render(_checked(), page, bitmap._data,
+        bitmap.width, bitmap.height, bitmap.width * 4);
+    if (status != _statusOk) {
+      throw Exception(_statusMessage(status));
+    }
+  }
+
+  /// Render [page] at [dpi] into a new [PdfRaster]
+  PdfRaster raster(int page, {double dpi = PdfPageFormat.inch}) {
+    final size = pageSize(page);
+    final scale = dpi / PdfPageFormat.inch;
+    final bitmap = PdfRasterBitmap(
+      (size.x * scale).toInt(),
+      (size.y * scale).toInt(),
+    );
+    try {
+      render(page, bitmap);
+      return bitmap.toRaster();
+    } finally {
+      bitmap.dispose();
+    }
+  }
+
+  /// Release the document
+  void close() {
+    if (_handle != ffi.nullptr) {
+      _bindings.close(_handle);
+      _handle = ffi.nullptr;
+    }
+  }
+
+  ffi.Pointer<ffi.Void> _checked() {
+    if (_handle == ffi.nullptr) {
+      throw StateError('The document was closed');
+    }
+    return _handle;
+  }
+}
+
+class _RasterBindings {
+  _RasterBindings(ffi.DynamicLibrary library)
+      : version = library.lookupFunction<_VersionC, _VersionDart>(
+          'net_nfet_printing_raster_version',
+        ),
+        open = library.lookupFunction<_OpenC, _OpenDart>(
+          'net_nfet_printing_raster_open',
+        ),
+        pageCount = library.lookupFunction<_PageCountC, _PageCountDart>(
+          'net_nfet_printing_raster_page_count',
+        ),
+        pageSize = library.lookupFunction<_PageSizeC, _PageSizeDart>(
+          'net_nfet_printing_raster_page_size',
+        ),
+        render = library.lookupFunction<_RenderC, _RenderDart>(
+          'net_nfet_printing_raster_render',
+        ),
+        close = library.lookupFunction<_CloseC, _CloseDart>(
+          'net_nfet_printing_raster_close',
+        );
+
+  final _VersionDart version;
+  final _OpenDart open;
+  final _PageCountDart pageCount;
+  final _PageSizeDart pageSize;
+  final _RenderDart render;
+  final _CloseDart close;
+}
+
+typedef _VersionC = ffi.Int32 Function();
+
+typedef _VersionDart = int Function();
+
+typedef _OpenC = ffi.Pointer<ffi.Void> Function(
+  ffi.Pointer<ffi.Uint8> data,
+  ffi.Uint64 size,
+  ffi.Pointer<ffi.Int32> status,
+);
+
+typedef _OpenDart = ffi.Pointer<ffi.Void> Function(
+  ffi.Pointer<ffi.Uint8> data,
+  int size,
+  ffi.Pointer<ffi.Int32> status,
+);
+
+typedef _PageCountC = ffi.Int32 Function(
+  ffi.Pointer<ffi.Void> document,
+);
+
+typedef _PageCountDart = int Function(
+  ffi.Pointer<ffi.Void> document,
+);
+
+typedef _PageSizeC = ffi.Int32 Function(
+  ffi.Pointer<ffi.Void> document,
+  ffi.Int32 page,
+  ffi.Pointer<ffi.Double> width,
+  ffi.Pointer<ffi.Double> height,
+);
+
+typedef _PageSizeDart = int Function(
+  ffi.Pointer<ffi.Void> document,
+  int page,
+  ffi.Pointer<ffi.Double> width,
+  ffi.Pointer<ffi.Double> height,
+);
+
+typedef _RenderC = ffi.Int32 Function(
+  ffi.Pointer<ffi.Void> document,
+  ffi.Int32 page,
+  ffi.Pointer<ffi.Uint8> buffer,
+  ffi.Int32 width,
+  ffi.Int32 height,
+  ffi.Int32 stride,
+);
+
+typedef _RenderDart = int Function(
+  ffi.Pointer<ffi.Void> document,
+  int page,
+  ffi.Pointer<ffi.Uint8> buffer,
+  int width,
+  int height,
+  int stride,
+);
+
+typedef _CloseC = ffi.Void Function(
+  ffi.Pointer<ffi.Void> document,
+);
+
+typedef _CloseDart = void Function(
+  ffi.Pointer<ffi.Void> document,
+);
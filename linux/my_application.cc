@@ -6,6 +6,7 @@
 #endif
 
 #include "flutter/generated_plugin_registrant.h"
+#include "printing/printing_plugin.h"
 
 struct _MyApplication {
   GtkApplication parent_instance;
@@ -59,6 +60,11 @@ static void my_application_activate(GApplication* application) {
 
   fl_register_plugins(FL_PLUGIN_REGISTRY(view));
 
+  g_autoptr(FlPluginRegistrar) printing_registrar =
+      fl_plugin_registry_get_registrar_for_plugin(FL_PLUGIN_REGISTRY(view),
+                                                  "PrintingPlugin");
+  printing_plugin_register_with_registrar(printing_registrar);
+
   gtk_widget_grab_focus(GTK_WIDGET(view));
 }
 
@@ -0,0 +1,166 @@
+#include "page_texture.h"
+
+#include <limits>
+#include <new>
+#include <vector>
+
+struct PageFrame {
+  std::vector<uint8_t> pixels;  // RGBA rows
+  uint32_t width = 0;
+  uint32_t height = 0;
+};
+
+// Frames of a texture, shared by render and the engine's copy on the raster
+// thread.
+struct PageFrames {
+  // Guards front and shown.
+  std::mutex mutex;
+  std::shared_ptr<PageFrame> front;
+  // Frame last handed to the engine, kept alive until the next copy.
+  std::shared_ptr<PageFrame> shown;
+};
+
+G_DECLARE_FINAL_TYPE(PagePixelBuffer,
+                     page_pixel_buffer,
+                     PAGE,
+                     PIXEL_BUFFER,
+                     FlPixelBufferTexture)
+
+struct _PagePixelBuffer {
+  FlPixelBufferTexture parent_instance;
+  PageFrames* frames;
+};
+
+G_DEFINE_TYPE(PagePixelBuffer,
+              page_pixel_buffer,
+              fl_pixel_buffer_texture_get_type())
+
+// Implements FlPixelBufferTexture::copy_pixels, on the raster thread.
+static gboolean page_pixel_buffer_copy_pixels(FlPixelBufferTexture* texture,
+                                              const uint8_t** buffer,
+                                              uint32_t* width,
+                                              uint32_t* height,
+                                              GError** error) {
+  auto frames = PAGE_PIXEL_BUFFER(texture)->frames;
+  std::lock_guard<std::mutex> lock{frames->mutex};
+  if (!frames->front) {
+    g_set_error_literal(error, g_quark_from_static_string("printing"), 0,
+                        "No page rendered yet");
+    return FALSE;
+  }
+
+  frames->shown = frames->front;
+  *buffer = frames->shown->pixels.data();
+  *width = frames->shown->width;
+  *height = frames->shown->height;
+  return TRUE;
+}
+
+// Implements GObject::finalize.
+static void page_pixel_buffer_finalize(GObject* object) {
+  delete PAGE_PIXEL_BUFFER(object)->frames;
+  G_OBJECT_CLASS(page_pixel_buffer_parent_class)->finalize(object);
+}
+
+static void page_pixel_buffer_class_init(PagePixelBufferClass* klass) {
+  FL_PIXEL_BUFFER_TEXTURE_CLASS(klass)->copy_pixels =
+      page_pixel_buffer_copy_pixels;
+  G_OBJECT_CLASS(klass)->finalize = page_pixel_buffer_finalize;
+}
+
+static void page_pixel_buffer_init(PagePixelBuffer* self) {
+  self->frames = new PageFrames();
+}
+
+std::shared_ptr<PageTexture> PageTexture::create(FlTextureRegistrar* registrar,
+                                                 const uint8_t* data,
+                                                 size_t size,
+                                                 std::string& error) {
+  int32_t status = NET_NFET_PRINTING_RASTER_OK;
+  auto document = net_nfet_printing_raster_open(data, size, &status);
+  if (!document) {
+    error = status == NET_NFET_PRINTING_RASTER_OUT_OF_MEMORY
+                ? "Not enough memory to load the document"
+                : "Cannot load the document";
+    return nullptr;
+  }
+
+  return std::shared_ptr<PageTexture>(new PageTexture(registrar, document));
+}
+
+PageTexture::PageTexture(FlTextureRegistrar* registrar,
+                         net_nfet_printing_raster_document* document)
+    : registrar{registrar},
+      document{document},
+      texture{FL_TEXTURE(g_object_new(page_pixel_buffer_get_type(), nullptr))} {
+  fl_texture_registrar_register_texture(registrar, texture);
+  textureId = fl_texture_get_id(texture);
+}
+
+PageTexture::~PageTexture() {
+  // The engine keeps its own reference while it may still copy a frame.
+  g_object_unref(texture);
+  net_nfet_printing_raster_close(document);
+}
+
+void PageTexture::release() {
+  if (released.exchange(true)) {
+    return;
+  }
+
+  fl_texture_registrar_unregister_texture(registrar, texture);
+}
+
+bool PageTexture::render(int request,
+                         int page,
+                         double scale,
+                         int& width,
+                         int& height) {
+  std::lock_guard<std::mutex> render{renderMutex};
+  if (request != generation || released) {
+    return false;
+  }
+
+  double pageWidth = 0, pageHeight = 0;
+  if (net_nfet_printing_raster_page_size(document, page, &pageWidth,
+                                         &pageHeight) !=
+      NET_NFET_PRINTING_RASTER_OK) {
+    return false;
+  }
+
+  auto frame = std::make_shared<PageFrame>();
+  width = static_cast<int>(pageWidth * scale);
+  height = static_cast<int>(pageHeight * scale);
+  // The library takes the row stride as an int32.
+  if (width <= 0 || height <= 0 ||
+      width > std::numeric_limits<int32_t>::max() / 4) {
+    return false;
+  }
+
+  auto stride = width * 4;
+  try {
+    frame->pixels.resize(static_cast<size_t>(stride) * height);
+  } catch (const std::bad_alloc&) {
+    return false;
+  }
+  if (net_nfet_printing_raster_render(document, page, frame->pixels.data(),
+                                      width, height, stride) !=
+      NET_NFET_PRINTING_RASTER_OK) {
+    return false;
+  }
+  frame->width = static_cast<uint32_t>(width);
+  frame->height = static_cast<uint32_t>(height);
+
+  auto frames = PAGE_PIXEL_BUFFER(texture)->frames;
+  {
+    std::lock_guard<std::mutex> lock{frames->mutex};
+    frames->front = std::move(frame);
+  }
+  return !released;
+}
+
+void PageTexture::frameAvailable() {
+  if (!released) {
+    fl_texture_registrar_mark_texture_frame_available(registrar, texture);
+  }
+}
@@ -0,0 +1,67 @@
+#ifndef PRINTING_PLUGIN_PAGE_TEXTURE_H_
+#define PRINTING_PLUGIN_PAGE_TEXTURE_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "pdf_raster.h"
+
+// A Flutter pixel-buffer texture showing one page of a document at a time,
+// rendered by the printing_raster library. A zoom or scroll only renders the
+// page again and swaps the new frame in; no pixels cross the method channel.
+class PageTexture {
+ public:
+  // Loads size bytes of a PDF file and registers the texture. Returns
+  // nullptr and sets error if the document cannot be loaded.
+  static std::shared_ptr<PageTexture> create(FlTextureRegistrar* registrar,
+                                             const uint8_t* data,
+                                             size_t size,
+                                             std::string& error);
+
+  // The last reference may be dropped on any thread.
+  virtual ~PageTexture();
+
+  PageTexture(const PageTexture&) = delete;
+  PageTexture& operator=(const PageTexture&) = delete;
+
+  // Unregisters the texture. Must be called on the main thread before the
+  // last reference is dropped. The frames stay alive until the engine has
+  // stopped copying them.
+  void release();
+
+  int64_t id() const { return textureId; }
+
+  // Starts a new render request and returns its number. A render whose
+  // request is no longer the latest one is skipped.
+  int request() { return ++generation; }
+
+  // Renders page at scale into a new frame. Runs on any thread. Returns
+  // false if the page cannot be rendered, the request was superseded or the
+  // texture was released.
+  bool render(int request, int page, double scale, int& width, int& height);
+
+  // Tells the engine a rendered frame is ready. Main thread only.
+  void frameAvailable();
+
+ private:
+  PageTexture(FlTextureRegistrar* registrar,
+              net_nfet_printing_raster_document* document);
+
+  FlTextureRegistrar* registrar;
+  net_nfet_printing_raster_document* document;
+  // Holds the frames, referenced by the engine while registered.
+  FlTexture* texture;
+  int64_t textureId;
+  std::atomic<int> generation{0};
+  std::atomic<bool> released{false};
+
+  // Held while rendering, one render at a time per texture.
+  std::mutex renderMutex;
+};
+
+#endif
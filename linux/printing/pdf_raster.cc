@@ -0,0 +1,174 @@
+#include "pdf_raster.h"
+
+#include <algorithm>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "fpdfview.h"
+
+// PDFium keeps process-wide state and is not thread-safe, every call is made
+// under this lock. The library stays initialized while a document is open.
+static std::mutex pdfiumMutex;
+static int libraryUsers = 0;
+
+struct net_nfet_printing_raster_document {
+  std::vector<uint8_t> bytes;  // parsed in place by PDFium
+  FPDF_DOCUMENT doc = nullptr;
+};
+
+static void acquireLibrary() {
+  if (libraryUsers++ > 0) {
+    return;
+  }
+
+  FPDF_LIBRARY_CONFIG config;
+  config.version = 2;
+  config.m_pUserFontPaths = nullptr;
+  config.m_pIsolate = nullptr;
+  config.m_v8EmbedderSlot = 0;
+  FPDF_InitLibraryWithConfig(&config);
+}
+
+static void releaseLibrary() {
+  if (--libraryUsers == 0) {
+    FPDF_DestroyLibrary();
+  }
+}
+
+int32_t net_nfet_printing_raster_version(void) {
+  return NET_NFET_PRINTING_RASTER_VERSION;
+}
+
+net_nfet_printing_raster_document* net_nfet_printing_raster_open(
+    const uint8_t* data,
+    uint64_t size,
+    int32_t* status) {
+  auto result = NET_NFET_PRINTING_RASTER_OK;
+  net_nfet_printing_raster_document* document = nullptr;
+
+  if (!data || size == 0) {
+    result = NET_NFET_PRINTING_RASTER_BAD_ARGUMENT;
+  } else {
+    // The caller may free or move its bytes as soon as this returns.
+    document = new (std::nothrow) net_nfet_printing_raster_document();
+    try {
+      if (document) {
+        document->bytes.assign(data, data + size);
+      }
+    } catch (const std::bad_alloc&) {
+      delete document;
+      document = nullptr;
+    }
+    if (!document) {
+      result = NET_NFET_PRINTING_RASTER_OUT_OF_MEMORY;
+    }
+  }
+
+  if (document) {
+    std::lock_guard<std::mutex> lock{pdfiumMutex};
+    acquireLibrary();
+    document->doc = FPDF_LoadMemDocument64(document->bytes.data(),
+                                           document->bytes.size(), nullptr);
+    if (!document->doc) {
+      releaseLibrary();
+      delete document;
+      document = nullptr;
+      result = NET_NFET_PRINTING_RASTER_BAD_DOCUMENT;
+    }
+  }
+
+  if (status) {
+    *status = result;
+  }
+  return document;
+}
+
+int32_t net_nfet_printing_raster_page_count(
+    net_nfet_printing_raster_document* document) {
+  if (!document) {
+    return -1;
+  }
+
+  std::lock_guard<std::mutex> lock{pdfiumMutex};
+  return FPDF_GetPageCount(document->doc);
+}
+
+int32_t net_nfet_printing_raster_page_size(
+    net_nfet_printing_raster_document* document,
+    int32_t page,
+    double* width,
+    double* height) {
+  if (!document || !width || !height) {
+    return NET_NFET_PRINTING_RASTER_BAD_ARGUMENT;
+  }
+
+  std::lock_guard<std::mutex> lock{pdfiumMutex};
+  FS_SIZEF size;
+  if (page < 0 || page >= FPDF_GetPageCount(document->doc) ||
+      !FPDF_GetPageSizeByIndexF(document->doc, page, &size)) {
+    return NET_NFET_PRINTING_RASTER_BAD_PAGE;
+  }
+
+  *width = size.width;
+  *height = size.height;
+  return NET_NFET_PRINTING_RASTER_OK;
+}
+
+int32_t net_nfet_printing_raster_render(
+    net_nfet_printing_raster_document* document,
+    int32_t page,
+    uint8_t* buffer,
+    int32_t width,
+    int32_t height,
+    int32_t stride) {
+  if (!document || !buffer || width <= 0 || height <= 0 ||
+      stride < static_cast<int64_t>(width) * 4) {
+    return NET_NFET_PRINTING_RASTER_BAD_ARGUMENT;
+  }
+
+  std::lock_guard<std::mutex> lock{pdfiumMutex};
+  if (page < 0 || page >= FPDF_GetPageCount(document->doc)) {
+    return NET_NFET_PRINTING_RASTER_BAD_PAGE;
+  }
+  auto pdfPage = FPDF_LoadPage(document->doc, page);
+  if (!pdfPage) {
+    return NET_NFET_PRINTING_RASTER_BAD_PAGE;
+  }
+
+  // Rendered straight into the caller's memory, no intermediate bitmap.
+  auto bitmap =
+      FPDFBitmap_CreateEx(width, height, FPDFBitmap_BGRA, buffer, stride);
+  if (!bitmap) {
+    FPDF_ClosePage(pdfPage);
+    return NET_NFET_PRINTING_RASTER_OUT_OF_MEMORY;
+  }
+  FPDFBitmap_FillRect(bitmap, 0, 0, width, height, 0xffffffff);
+  FPDF_RenderPageBitmap(bitmap, pdfPage, 0, 0, width, height, 0,
+                        FPDF_ANNOT | FPDF_LCD_TEXT);
+  FPDFBitmap_Destroy(bitmap);
+  FPDF_ClosePage(pdfPage);
+
+  // BGRA to RGBA conversion
+  for (auto y = 0; y < height; y++) {
+    auto row = buffer + static_cast<size_t>(y) * stride;
+    for (auto x = 0; x < width * 4; x += 4) {
+      std::swap(row[x], row[x + 2]);
+    }
+  }
+  return NET_NFET_PRINTING_RASTER_OK;
+}
+
+void net_nfet_printing_raster_close(
+    net_nfet_printing_raster_document* document) {
+  if (!document) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock{pdfiumMutex};
+    FPDF_CloseDocument(document->doc);
+    releaseLibrary();
+  }
+  delete document;
+}
@@ -0,0 +1,72 @@
+#ifndef PRINTING_PLUGIN_PDF_RASTER_H_
+#define PRINTING_PLUGIN_PDF_RASTER_H_
+
+#include <stdint.h>
+
+// A C interface to the PDFium raster engine, built as libprinting_raster
+// and called from Dart isolates through dart:ffi. Pages are rendered into
+// memory owned by the caller, nothing goes through the method channel.
+//
+// The interface is stable: functions are only ever added, and the version
+// below changes when they are. Calls are thread-safe, PDFium itself is
+// serialized by a lock inside the library.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NET_NFET_PRINTING_RASTER_VERSION 1
+
+typedef enum {
+  NET_NFET_PRINTING_RASTER_OK = 0,
+  NET_NFET_PRINTING_RASTER_BAD_ARGUMENT = 1,
+  NET_NFET_PRINTING_RASTER_BAD_DOCUMENT = 2,  // malformed or encrypted
+  NET_NFET_PRINTING_RASTER_BAD_PAGE = 3,      // out of range or unreadable
+  NET_NFET_PRINTING_RASTER_OUT_OF_MEMORY = 4,
+} net_nfet_printing_raster_status;
+
+typedef struct net_nfet_printing_raster_document
+    net_nfet_printing_raster_document;
+
+// Returns NET_NFET_PRINTING_RASTER_VERSION of the library loaded.
+int32_t net_nfet_printing_raster_version(void);
+
+// Copies size bytes of a PDF file and parses them. Returns NULL and sets
+// status if the document cannot be loaded. The result is released with
+// net_nfet_printing_raster_close.
+net_nfet_printing_raster_document* net_nfet_printing_raster_open(
+    const uint8_t* data,
+    uint64_t size,
+    int32_t* status);
+
+// Returns the number of pages, or -1 if document is NULL.
+int32_t net_nfet_printing_raster_page_count(
+    net_nfet_printing_raster_document* document);
+
+// Sets the size of page in PDF points, without rendering it.
+int32_t net_nfet_printing_raster_page_size(
+    net_nfet_printing_raster_document* document,
+    int32_t page,
+    double* width,
+    double* height);
+
+// Renders page scaled to width x height pixels into buffer, as RGBA rows of
+// stride bytes on a white background. buffer must hold stride * height
+// bytes, and stride be at least width * 4.
+int32_t net_nfet_printing_raster_render(
+    net_nfet_printing_raster_document* document,
+    int32_t page,
+    uint8_t* buffer,
+    int32_t width,
+    int32_t height,
+    int32_t stride);
+
+// Releases document, which may be NULL.
+void net_nfet_printing_raster_close(
+    net_nfet_printing_raster_document* document);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,235 @@
+#include "print_job.h"
+
+#include <algorithm>
+
+static const int connectTimeout = 30000;  // ms
+
+// Size of each write to the request body.
+static const size_t writeChunk = 64 * 1024;
+
+static int toHundredthMm(double points) {
+  return static_cast<int>(points * 2540 / 72 + 0.5);
+}
+
+static double toPoints(int hundredthMm) {
+  return hundredthMm * 72.0 / 2540;
+}
+
+static bool isUri(const std::string& printer) {
+  return printer.compare(0, 6, "ipp://") == 0 ||
+         printer.compare(0, 7, "ipps://") == 0;
+}
+
+static std::string option(const cups_dest_t& dest, const char* name) {
+  auto value = cupsGetOption(name, dest.num_options, dest.options);
+  return value ? value : "";
+}
+
+PrintJob::PrintJob(int index, std::string server, std::string title)
+    : index{index}, server{std::move(server)}, title{std::move(title)} {}
+
+PrintJob::~PrintJob() {
+  if (info) {
+    cupsFreeDestInfo(info);
+  }
+  if (dest) {
+    cupsFreeDests(1, dest);
+  }
+  if (http) {
+    httpClose(http);
+  }
+}
+
+void PrintJob::useServer(const std::string& server) {
+  cupsSetServer(server.empty() ? nullptr : server.c_str());
+}
+
+std::vector<Printer> PrintJob::listPrinters(const std::string& server) {
+  useServer(server);
+
+  cups_dest_t* dests = nullptr;
+  auto count = cupsGetDests2(CUPS_HTTP_DEFAULT, &dests);
+
+  auto printers = std::vector<Printer>{};
+  for (auto i = 0; i < count; i++) {
+    auto& dest = dests[i];
+    if (dest.instance) {
+      // Instances are option presets of a queue listed on its own.
+      continue;
+    }
+
+    // printer-state 5 is stopped.
+    printers.push_back(Printer{
+        dest.name, dest.name, option(dest, "printer-make-and-model"),
+        option(dest, "printer-location"), option(dest, "printer-info"),
+        dest.is_default != 0,
+        option(dest, "printer-state") != "5" &&
+            option(dest, "printer-is-accepting-jobs") != "false"});
+  }
+
+  cupsFreeDests(count, dests);
+  return printers;
+}
+
+bool PrintJob::open(const std::string& printer,
+                    double width,
+                    double height,
+                    PageMetrics& metrics,
+                    std::string& error) {
+  std::lock_guard<std::mutex> lock{mutex};
+  useServer(server);
+
+  if (isUri(printer)) {
+    // A printer the scheduler does not know, like a test printer.
+    dest = cupsGetDestWithURI(nullptr, printer.c_str());
+  } else {
+    dest = cupsGetNamedDest(CUPS_HTTP_DEFAULT,
+                            printer.empty() ? nullptr : printer.c_str(),
+                            nullptr);
+  }
+  if (!dest) {
+    error = "Cannot find the printer";
+    return false;
+  }
+
+  http = cupsConnectDest(dest, CUPS_DEST_FLAGS_NONE, connectTimeout, nullptr,
+                         resource, sizeof(resource), nullptr, nullptr);
+  if (!http) {
+    error = "Cannot connect to the printer";
+    return false;
+  }
+
+  info = cupsCopyDestInfo(http, dest);
+
+  // Media sizes are listed in portrait.
+  auto landscape = width > height;
+  cups_size_t size;
+  auto found =
+      width > 0 && height > 0
+          ? cupsGetDestMediaBySize(
+                http, dest, info, toHundredthMm(std::min(width, height)),
+                toHundredthMm(std::max(width, height)),
+                CUPS_MEDIA_FLAGS_DEFAULT, &size)
+          : cupsGetDestMediaDefault(http, dest, info, CUPS_MEDIA_FLAGS_DEFAULT,
+                                    &size);
+
+  if (!found) {
+    metrics.pageWidth = width;
+    metrics.pageHeight = height;
+    return true;
+  }
+
+  if (landscape) {
+    // Turned a quarter counterclockwise, the left edge goes down.
+    metrics.pageWidth = toPoints(size.length);
+    metrics.pageHeight = toPoints(size.width);
+    metrics.marginLeft = toPoints(size.top);
+    metrics.marginTop = toPoints(size.right);
+    metrics.marginRight = toPoints(size.bottom);
+    metrics.marginBottom = toPoints(size.left);
+  } else {
+    metrics.pageWidth = toPoints(size.width);
+    metrics.pageHeight = toPoints(size.length);
+    metrics.marginLeft = toPoints(size.left);
+    metrics.marginTop = toPoints(size.top);
+    metrics.marginRight = toPoints(size.right);
+    metrics.marginBottom = toPoints(size.bottom);
+  }
+  return true;
+}
+
+bool PrintJob::write(const std::vector<uint8_t>& data,
+                     const Progress& progress,
+                     std::string& error) {
+  std::lock_guard<std::mutex> lock{mutex};
+
+  if (cancelled) {
+    error = "Cancelled";
+    return false;
+  }
+
+  if (cupsCreateDestJob(http, dest, info, &jobId, title.c_str(), 0,
+                        nullptr) > IPP_STATUS_OK_CONFLICTING) {
+    error = cupsLastErrorString();
+    return false;
+  }
+
+  if (cupsStartDestDocument(http, dest, info, jobId, title.c_str(),
+                            CUPS_FORMAT_PDF, 0, nullptr,
+                            1) != HTTP_STATUS_CONTINUE) {
+    error = cupsLastErrorString();
+    cupsCancelDestJob(http, dest, jobId);
+    return false;
+  }
+
+  size_t sent = 0;
+  while (sent < data.size() && !cancelled) {
+    auto chunk = std::min(writeChunk, data.size() - sent);
+    if (cupsWriteRequestData(http,
+                             reinterpret_cast<const char*>(data.data() + sent),
+                             chunk) != HTTP_STATUS_CONTINUE) {
+      break;
+    }
+    sent += chunk;
+    if (progress) {
+      progress(sent, data.size());
+    }
+  }
+
+  // Reads the response even after a failed write, to free the connection.
+  auto status = cupsFinishDestDocument(http, dest, info);
+  if (sent < data.size() || status > IPP_STATUS_OK_CONFLICTING) {
+    error = cancelled ? "Cancelled" : cupsLastErrorString();
+    jobCancelled = cupsCancelDestJob(http, dest, jobId) == IPP_STATUS_OK;
+    return false;
+  }
+
+  return true;
+}
+
+bool PrintJob::cancel() {
+  cancelled = true;
+
+  // Waits for a write in progress to stop.
+  std::lock_guard<std::mutex> lock{mutex};
+  if (jobId <= 0 || jobCancelled) {
+    return true;
+  }
+
+  jobCancelled = cupsCancelDestJob(http, dest, jobId) == IPP_STATUS_OK;
+  return jobCancelled;
+}
+
+std::string PrintJob::printerState() {
+  std::lock_guard<std::mutex> lock{mutex};
+  if (!http || jobId <= 0) {
+    return "";
+  }
+
+  auto uri = option(*dest, "printer-uri-supported");
+  if (uri.empty()) {
+    return "";
+  }
+
+  static const char* const attributes[] = {"job-state"};
+  auto request = ippNewRequest(IPP_OP_GET_JOB_ATTRIBUTES);
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", nullptr,
+               uri.c_str());
+  ippAddInteger(request, IPP_TAG_OPERATION, IPP_TAG_INTEGER, "job-id", jobId);
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME,
+               "requesting-user-name", nullptr, cupsUser());
+  ippAddStrings(request, IPP_TAG_OPERATION, IPP_TAG_KEYWORD,
+                "requested-attributes", 1, nullptr, attributes);
+
+  // Frees the request.
+  auto response = cupsDoRequest(http, request, resource);
+
+  auto state = std::string{};
+  auto attribute = ippFindAttribute(response, "job-state", IPP_TAG_ENUM);
+  if (attribute) {
+    state = ippEnumString("job-state", ippGetInteger(attribute, 0));
+  }
+
+  ippDelete(response);
+  return state;
+}
@@ -0,0 +1,107 @@
+#ifndef PRINTING_PLUGIN_PRINT_JOB_H_
+#define PRINTING_PLUGIN_PRINT_JOB_H_
+
+#include <cups/cups.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct Printer {
+  std::string name;
+  std::string url;
+  std::string model;
+  std::string location;
+  std::string comment;
+  bool isDefault;
+  bool available;
+};
+
+// Page size and printable area of the media, in PDF points.
+struct PageMetrics {
+  double pageWidth = 0;
+  double pageHeight = 0;
+  double marginLeft = 0;
+  double marginTop = 0;
+  double marginRight = 0;
+  double marginBottom = 0;
+};
+
+// One PDF document sent to a CUPS queue, or straight to an IPP printer.
+//
+// server is "host[:port]" of the CUPS scheduler, empty for the libcups
+// default (CUPS_SERVER, client.conf, then the local scheduler). To test
+// without a real printer, run `ippeveprinter -p 8631 -f application/pdf Test`
+// and print to ipp://localhost:8631/ipp/print, as test/print_job_test does,
+// or point server at a cupsd started with a test configuration.
+//
+// open() and write() block on the network and are meant for a worker thread.
+class PrintJob {
+ public:
+  // Called with the bytes sent so far and the document size.
+  using Progress = std::function<void(size_t sent, size_t total)>;
+
+  PrintJob(int index, std::string server, std::string title);
+
+  virtual ~PrintJob();
+
+  PrintJob(const PrintJob&) = delete;
+  PrintJob& operator=(const PrintJob&) = delete;
+
+  int id() const { return index; }
+
+  const std::string& name() const { return title; }
+
+  // Resolves printer, a queue name, an ipp:// or ipps:// URI, or empty for
+  // the default destination, and measures its media closest to width and
+  // height. Returns false and sets error if the printer cannot be reached.
+  bool open(const std::string& printer,
+            double width,
+            double height,
+            PageMetrics& metrics,
+            std::string& error);
+
+  // Creates the job and streams data to it as one PDF document, without a
+  // temporary file.
+  bool write(const std::vector<uint8_t>& data,
+             const Progress& progress,
+             std::string& error);
+
+  // Stops a write in progress and cancels its job, or cancels the job on
+  // the printer once submitted. A later write fails. Returns false if the
+  // printer refused. Thread-safe, blocks until the chunk being sent is
+  // written, so not to be called from a progress callback.
+  bool cancel();
+
+  // Job id given by the printer or the scheduler, 0 before write.
+  int printerJobId() const { return jobId; }
+
+  // IPP job-state of the submitted job ("pending", "processing",
+  // "completed", ...), asked to the printer, or empty if unknown.
+  std::string printerState();
+
+  static std::vector<Printer> listPrinters(const std::string& server);
+
+ private:
+  // libcups keeps the server per thread.
+  static void useServer(const std::string& server);
+
+  const int index;
+  const std::string server;
+  const std::string title;
+
+  // Guards the connection, used by one request at a time.
+  std::mutex mutex;
+  cups_dest_t* dest = nullptr;
+  cups_dinfo_t* info = nullptr;
+  http_t* http = nullptr;
+  char resource[256] = "";
+  int jobId = 0;
+  std::atomic<bool> cancelled{false};
+  bool jobCancelled = false;
+};
+
+#endif
@@ -0,0 +1,165 @@
+#include "printer_watcher.h"
+
+#include "task_runner.h"
+
+static const char* const printersConf = "/etc/cups/printers.conf";
+
+// Polling period of a remote scheduler.
+static const guint pollSeconds = 10;
+
+static bool samePrinters(const std::vector<Printer>& a,
+                         const std::vector<Printer>& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i].name != b[i].name || a[i].url != b[i].url ||
+        a[i].model != b[i].model || a[i].location != b[i].location ||
+        a[i].comment != b[i].comment || a[i].isDefault != b[i].isDefault ||
+        a[i].available != b[i].available) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+PrinterWatcher::PrinterWatcher(TaskRunner* runner,
+                               std::function<void(PrinterList)> listener)
+    : runner{runner}, listener{std::move(listener)} {
+  watch();
+}
+
+PrinterWatcher::~PrinterWatcher() {
+  unwatch();
+
+  {
+    std::lock_guard<std::mutex> lock{mutex};
+    stopping = true;
+  }
+  if (worker.joinable()) {
+    worker.join();
+  }
+}
+
+PrinterWatcher::PrinterList PrinterWatcher::printers() {
+  std::lock_guard<std::mutex> lock{mutex};
+  return current;
+}
+
+PrinterWatcher::PrinterList PrinterWatcher::store(
+    std::vector<Printer> printers) {
+  std::lock_guard<std::mutex> lock{mutex};
+  if (!current) {
+    current =
+        std::make_shared<const std::vector<Printer>>(std::move(printers));
+  }
+  return current;
+}
+
+void PrinterWatcher::setServer(const std::string& server) {
+  if (server == currentServer) {
+    return;
+  }
+
+  unwatch();
+  currentServer = server;
+  {
+    std::lock_guard<std::mutex> lock{mutex};
+    workerServer = server;
+  }
+  watch();
+  refreshLater();
+}
+
+void PrinterWatcher::watch() {
+  if (!currentServer.empty()) {
+    timer = g_timeout_add_seconds(pollSeconds, onTimer, this);
+    return;
+  }
+
+  g_autoptr(GFile) file = g_file_new_for_path(printersConf);
+  monitor = g_file_monitor_file(file, G_FILE_MONITOR_NONE, nullptr, nullptr);
+  if (monitor) {
+    g_signal_connect(monitor, "changed", G_CALLBACK(onFileChanged), this);
+  }
+}
+
+void PrinterWatcher::unwatch() {
+  if (monitor) {
+    g_file_monitor_cancel(monitor);
+    g_object_unref(monitor);
+    monitor = nullptr;
+  }
+
+  if (timer) {
+    g_source_remove(timer);
+    timer = 0;
+  }
+}
+
+void PrinterWatcher::onFileChanged(GFileMonitor* monitor,
+                                   GFile* file,
+                                   GFile* other,
+                                   GFileMonitorEvent event,
+                                   gpointer data) {
+  // The scheduler writes a new file and renames it over the old one.
+  if (event == G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT ||
+      event == G_FILE_MONITOR_EVENT_CREATED ||
+      event == G_FILE_MONITOR_EVENT_DELETED) {
+    static_cast<PrinterWatcher*>(data)->refreshLater();
+  }
+}
+
+gboolean PrinterWatcher::onTimer(gpointer data) {
+  static_cast<PrinterWatcher*>(data)->refreshLater();
+  return G_SOURCE_CONTINUE;
+}
+
+void PrinterWatcher::refreshLater() {
+  std::lock_guard<std::mutex> lock{mutex};
+  dirty = true;
+  if (busy) {
+    // The running refresh goes around once more.
+    return;
+  }
+
+  busy = true;
+  if (worker.joinable()) {
+    // Done already, busy was cleared on its way out.
+    worker.join();
+  }
+  worker = std::thread(&PrinterWatcher::work, this);
+}
+
+void PrinterWatcher::work() {
+  for (;;) {
+    std::string server;
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      if (!dirty || stopping) {
+        busy = false;
+        return;
+      }
+      dirty = false;
+      server = workerServer;
+    }
+
+    auto printers = PrintJob::listPrinters(server);
+
+    PrinterList changed;
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      if (!current || !samePrinters(*current, printers)) {
+        current =
+            std::make_shared<const std::vector<Printer>>(std::move(printers));
+        changed = current;
+      }
+    }
+
+    if (changed && listener) {
+      runner->post([listener = listener, changed] { listener(changed); });
+    }
+  }
+}
@@ -0,0 +1,80 @@
+#ifndef PRINTING_PLUGIN_PRINTER_WATCHER_H_
+#define PRINTING_PLUGIN_PRINTER_WATCHER_H_
+
+#include <gio/gio.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "print_job.h"
+
+class TaskRunner;
+
+// Keeps the list of CUPS printers in memory. The local scheduler rewrites
+// printers.conf when a queue is added, removed or changes state, a file
+// monitor on it triggers a refresh; a remote server is polled instead.
+// The listener only hears about it when the list differs.
+// Must be created and configured on the main thread.
+class PrinterWatcher {
+ public:
+  using PrinterList = std::shared_ptr<const std::vector<Printer>>;
+
+  // The listener is called on the main thread through the task runner.
+  PrinterWatcher(TaskRunner* runner, std::function<void(PrinterList)> listener);
+
+  virtual ~PrinterWatcher();
+
+  PrinterWatcher(const PrinterWatcher&) = delete;
+  PrinterWatcher& operator=(const PrinterWatcher&) = delete;
+
+  // Returns the cached list, null until the printers were enumerated once.
+  PrinterList printers();
+
+  // Keeps printers, enumerated off the main thread with
+  // PrintJob::listPrinters(server()), unless a refresh was faster. Returns
+  // the list to show.
+  PrinterList store(std::vector<Printer> printers);
+
+  // Watches another scheduler, empty for the default one.
+  void setServer(const std::string& server);
+
+  const std::string& server() const { return currentServer; }
+
+ private:
+  static void onFileChanged(GFileMonitor* monitor,
+                            GFile* file,
+                            GFile* other,
+                            GFileMonitorEvent event,
+                            gpointer data);
+
+  static gboolean onTimer(gpointer data);
+
+  void watch();
+
+  void unwatch();
+
+  // Refreshes the list on the worker thread.
+  void refreshLater();
+
+  void work();
+
+  TaskRunner* runner;
+  std::function<void(PrinterList)> listener;
+  std::string currentServer;
+  GFileMonitor* monitor = nullptr;
+  guint timer = 0;
+
+  std::mutex mutex;
+  std::string workerServer;
+  PrinterList current;
+  bool dirty = false;
+  bool busy = false;
+  bool stopping = false;
+  std::thread worker;
+};
+
+#endif
@@ -0,0 +1,580 @@
+#include "printing_plugin.h"
+
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef PRINTING_TEXTURES
+#include "page_texture.h"
+#endif
+#include "print_job.h"
+#include "printer_watcher.h"
+#include "task_runner.h"
+
+// Progress of a job is sent at most this often, and once at the end.
+static const auto progressInterval = std::chrono::milliseconds(100);
+
+// Finished jobs remembered for printJobStatus.
+static const size_t maxFinishedJobs = 16;
+
+static FlValue* lookup(FlValue* args, const char* key) {
+  if (!args || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return nullptr;
+  }
+  return fl_value_lookup_string(args, key);
+}
+
+static std::string argString(FlValue* args,
+                             const char* key,
+                             const char* fallback = "") {
+  auto value = lookup(args, key);
+  return value && fl_value_get_type(value) == FL_VALUE_TYPE_STRING
+             ? fl_value_get_string(value)
+             : fallback;
+}
+
+static int64_t argInteger(FlValue* args, const char* key, int64_t fallback) {
+  auto value = lookup(args, key);
+  return value && fl_value_get_type(value) == FL_VALUE_TYPE_INT
+             ? fl_value_get_int(value)
+             : fallback;
+}
+
+static double argNumber(FlValue* args, const char* key) {
+  auto value = lookup(args, key);
+  if (!value) {
+    return 0;
+  }
+  switch (fl_value_get_type(value)) {
+    case FL_VALUE_TYPE_FLOAT:
+      return fl_value_get_float(value);
+    case FL_VALUE_TYPE_INT:
+      return static_cast<double>(fl_value_get_int(value));
+    default:
+      return 0;
+  }
+}
+
+static bool argBoolean(FlValue* args, const char* key) {
+  auto value = lookup(args, key);
+  return value && fl_value_get_type(value) == FL_VALUE_TYPE_BOOL &&
+         fl_value_get_bool(value);
+}
+
+// Answers call with result, which is released.
+static void respond(FlMethodCall* call, FlValue* result) {
+  g_autoptr(FlValue) value = result;
+  fl_method_call_respond_success(call, value, nullptr);
+}
+
+static FlValue* encode(const std::vector<Printer>& printers) {
+  auto list = fl_value_new_list();
+  for (auto& printer : printers) {
+    auto map = fl_value_new_map();
+    fl_value_set_string_take(map, "name",
+                             fl_value_new_string(printer.name.c_str()));
+    fl_value_set_string_take(map, "url",
+                             fl_value_new_string(printer.url.c_str()));
+    fl_value_set_string_take(map, "model",
+                             fl_value_new_string(printer.model.c_str()));
+    fl_value_set_string_take(map, "location",
+                             fl_value_new_string(printer.location.c_str()));
+    fl_value_set_string_take(map, "comment",
+                             fl_value_new_string(printer.comment.c_str()));
+    fl_value_set_string_take(map, "default",
+                             fl_value_new_bool(printer.isDefault));
+    fl_value_set_string_take(map, "available",
+                             fl_value_new_bool(printer.available));
+    fl_value_append_take(list, map);
+  }
+  return list;
+}
+
+class PrintingPlugin {
+ public:
+  // The channel deletes the plugin with its handler, so it outlives it and
+  // is not referenced here.
+  PrintingPlugin(FlMethodChannel* channel,
+                 FlTextureRegistrar* textureRegistrar)
+      : channel{channel},
+#ifdef PRINTING_TEXTURES
+        textureRegistrar{textureRegistrar},
+#endif
+        owner{std::make_shared<Owner>(this)},
+        watcher{&runner,
+                [owner = owner](PrinterWatcher::PrinterList printers) {
+                  if (auto plugin = owner->get()) {
+                    plugin->onPrintersChanged(*printers);
+                  }
+                }} {}
+
+  virtual ~PrintingPlugin() {
+    owner->detach();
+#ifdef PRINTING_TEXTURES
+    for (auto& texture : textures) {
+      texture.second->release();
+    }
+#endif
+  }
+
+  PrintingPlugin(const PrintingPlugin&) = delete;
+  PrintingPlugin& operator=(const PrintingPlugin&) = delete;
+
+  void handleMethodCall(FlMethodCall* call) {
+    auto method = fl_method_call_get_name(call);
+    auto args = fl_method_call_get_args(call);
+
+    if (strcmp(method, "printingInfo") == 0) {
+      respond(call, printingInfo());
+    } else if (strcmp(method, "listPrinters") == 0) {
+      listPrinters(call);
+    } else if (strcmp(method, "printPdf") == 0) {
+      printPdf(call, args);
+    } else if (strcmp(method, "printJobStatus") == 0) {
+      printJobStatus(call, static_cast<int>(argInteger(args, "job", -1)));
+    } else if (strcmp(method, "cancelPrintJob") == 0) {
+      cancelPrintJob(call, static_cast<int>(argInteger(args, "job", -1)));
+    } else if (strcmp(method, "setPrintServer") == 0) {
+      watcher.setServer(argString(args, "server"));
+      respond(call, fl_value_new_null());
+#ifdef PRINTING_TEXTURES
+    } else if (strcmp(method, "createTexture") == 0) {
+      createTexture(call, args);
+    } else if (strcmp(method, "renderTexture") == 0) {
+      renderTexture(call, argInteger(args, "texture", -1),
+                    static_cast<int>(argInteger(args, "page", 0)),
+                    argNumber(args, "scale"));
+    } else if (strcmp(method, "disposeTexture") == 0) {
+      auto it = textures.find(argInteger(args, "texture", -1));
+      if (it != textures.end()) {
+        it->second->release();
+        textures.erase(it);
+      }
+      respond(call, fl_value_new_null());
+#endif
+    } else {
+      fl_method_call_respond_not_implemented(call, nullptr);
+    }
+  }
+
+ private:
+  struct JobStatus {
+    std::shared_ptr<PrintJob> job;
+    std::string state;  // layout, sending, sent or failed
+    int64_t sent = 0;
+    int64_t total = 0;
+    std::string error;
+  };
+
+  // Lets threads and Dart replies reach the plugin without keeping it
+  // alive. A task posted from a worker thread runs on the main thread, with
+  // a null plugin once it was destroyed, so that it can still answer its
+  // call.
+  class Owner : public std::enable_shared_from_this<Owner> {
+   public:
+    explicit Owner(PrintingPlugin* plugin) : plugin{plugin} {}
+
+    // The plugin, null once destroyed. Main thread only.
+    PrintingPlugin* get() const { return plugin; }
+
+    // Any thread.
+    void post(std::function<void(PrintingPlugin*)> task) {
+      auto self = shared_from_this();
+      runner.post([self, task] { task(self->plugin); });
+    }
+
+    void detach() { plugin = nullptr; }
+
+   private:
+    TaskRunner runner;
+    PrintingPlugin* plugin;
+  };
+
+  struct LayoutRequest {
+    std::shared_ptr<Owner> owner;
+    std::shared_ptr<PrintJob> job;
+  };
+
+  static FlValue* printingInfo() {
+    auto map = fl_value_new_map();
+    fl_value_set_string_take(map, "directPrint", fl_value_new_bool(true));
+    fl_value_set_string_take(map, "dynamicLayout", fl_value_new_bool(true));
+    fl_value_set_string_take(map, "canPrint", fl_value_new_bool(true));
+    fl_value_set_string_take(map, "canListPrinters", fl_value_new_bool(true));
+    fl_value_set_string_take(map, "canConvertHtml", fl_value_new_bool(false));
+    fl_value_set_string_take(map, "canShare", fl_value_new_bool(false));
+    fl_value_set_string_take(map, "canRaster", fl_value_new_bool(false));
+    return map;
+  }
+
+  // Sends args, which are released.
+  void invoke(const char* method, FlValue* args) {
+    g_autoptr(FlValue) value = args;
+    fl_method_channel_invoke_method(channel, method, value, nullptr, nullptr,
+                                    nullptr);
+  }
+
+  void listPrinters(FlMethodCall* call) {
+    auto printers = watcher.printers();
+    if (printers) {
+      respond(call, encode(*printers));
+      return;
+    }
+
+    // The first enumeration waits for the scheduler.
+    g_object_ref(call);
+    auto server = watcher.server();
+    std::thread([owner = owner, call, server] {
+      auto printers = std::make_shared<std::vector<Printer>>(
+          PrintJob::listPrinters(server));
+      owner->post([call, printers](PrintingPlugin* plugin) {
+        if (plugin) {
+          respond(call, encode(*plugin->watcher.store(std::move(*printers))));
+        } else {
+          respond(call, encode(*printers));
+        }
+        g_object_unref(call);
+      });
+    }).detach();
+  }
+
+  void printPdf(FlMethodCall* call, FlValue* args) {
+    auto index = static_cast<int>(argInteger(args, "job", -1));
+    auto job = std::make_shared<PrintJob>(index, watcher.server(),
+                                          argString(args, "name", "document"));
+    auto printer = argString(args, "printer");
+    auto width = argNumber(args, "width");
+    auto height = argNumber(args, "height");
+    if (argBoolean(args, "usePrinterSettings")) {
+      // The default media of the printer.
+      width = height = 0;
+    }
+
+    jobs[index] = JobStatus{job, "layout"};
+
+    std::thread([owner = owner, job, printer, width, height] {
+      PageMetrics metrics;
+      std::string error;
+      auto opened = job->open(printer, width, height, metrics, error);
+      owner->post([job, opened, metrics, error](PrintingPlugin* plugin) {
+        if (!plugin) {
+          return;
+        }
+        if (opened) {
+          plugin->onLayout(job, metrics);
+        } else {
+          plugin->onCompleted(job->id(), false, error);
+        }
+      });
+    }).detach();
+
+    respond(call, fl_value_new_int(1));
+  }
+
+  void onLayout(std::shared_ptr<PrintJob> job, const PageMetrics& metrics) {
+    g_autoptr(FlValue) args = fl_value_new_map();
+    fl_value_set_string_take(args, "job", fl_value_new_int(job->id()));
+    fl_value_set_string_take(args, "width",
+                             fl_value_new_float(metrics.pageWidth));
+    fl_value_set_string_take(args, "height",
+                             fl_value_new_float(metrics.pageHeight));
+    fl_value_set_string_take(args, "marginLeft",
+                             fl_value_new_float(metrics.marginLeft));
+    fl_value_set_string_take(args, "marginTop",
+                             fl_value_new_float(metrics.marginTop));
+    fl_value_set_string_take(args, "marginRight",
+                             fl_value_new_float(metrics.marginRight));
+    fl_value_set_string_take(args, "marginBottom",
+                             fl_value_new_float(metrics.marginBottom));
+
+    fl_method_channel_invoke_method(channel, "onLayout", args, nullptr,
+                                    onLayoutResult,
+                                    new LayoutRequest{owner, std::move(job)});
+  }
+
+  static void onLayoutResult(GObject* object,
+                             GAsyncResult* result,
+                             gpointer data) {
+    std::unique_ptr<LayoutRequest> request{static_cast<LayoutRequest*>(data)};
+    auto plugin = request->owner->get();
+
+    g_autoptr(GError) error = nullptr;
+    g_autoptr(FlMethodResponse) response =
+        fl_method_channel_invoke_method_finish(FL_METHOD_CHANNEL(object),
+                                               result, &error);
+    auto document =
+        response ? fl_method_response_get_result(response, &error) : nullptr;
+    if (!plugin) {
+      return;
+    }
+    if (!document ||
+        fl_value_get_type(document) != FL_VALUE_TYPE_UINT8_LIST) {
+      // The layout failed, Dart reported it already.
+      plugin->onCompleted(request->job->id(), false, "");
+      return;
+    }
+
+    auto bytes = fl_value_get_uint8_list(document);
+    plugin->write(request->job,
+                           std::make_shared<const std::vector<uint8_t>>(
+                               bytes, bytes + fl_value_get_length(document)));
+  }
+
+  void write(std::shared_ptr<PrintJob> job,
+             std::shared_ptr<const std::vector<uint8_t>> data) {
+    auto index = job->id();
+    setState(index, "sending", 0, static_cast<int64_t>(data->size()));
+
+    std::thread([owner = owner, job, data, index] {
+      auto last = std::chrono::steady_clock::time_point{};
+      auto progress = [&owner, &last, index](size_t sent, size_t total) {
+        auto now = std::chrono::steady_clock::now();
+        if (sent < total && now - last < progressInterval) {
+          return;
+        }
+        last = now;
+        owner->post([index, sent, total](PrintingPlugin* plugin) {
+          if (plugin) {
+            plugin->setState(index, "sending", static_cast<int64_t>(sent),
+                             static_cast<int64_t>(total));
+          }
+        });
+      };
+
+      std::string error;
+      auto written = job->write(*data, progress, error);
+      owner->post([index, written, error](PrintingPlugin* plugin) {
+        if (plugin) {
+          plugin->onCompleted(index, written, error);
+        }
+      });
+    }).detach();
+  }
+
+  void setState(int index,
+                const std::string& state,
+                int64_t sent,
+                int64_t total) {
+    auto it = jobs.find(index);
+    if (it == jobs.end()) {
+      return;
+    }
+
+    auto& status = it->second;
+    status.state = state;
+    status.sent = sent;
+    status.total = total;
+    invoke("onJobProgress", encodeStatus(index, status, ""));
+  }
+
+  void onCompleted(int index, bool completed, const std::string& error) {
+    auto it = jobs.find(index);
+    if (it != jobs.end()) {
+      auto& status = it->second;
+      status.state = completed ? "sent" : "failed";
+      status.error = error;
+      invoke("onJobProgress", encodeStatus(index, status, ""));
+
+      finished.push_back(index);
+      if (finished.size() > maxFinishedJobs) {
+        jobs.erase(finished.front());
+        finished.pop_front();
+      }
+    }
+
+    auto args = fl_value_new_map();
+    fl_value_set_string_take(args, "job", fl_value_new_int(index));
+    fl_value_set_string_take(args, "completed", fl_value_new_bool(completed));
+    if (!error.empty()) {
+      fl_value_set_string_take(args, "error",
+                               fl_value_new_string(error.c_str()));
+    }
+    invoke("onCompleted", args);
+  }
+
+  void printJobStatus(FlMethodCall* call, int index) {
+    auto it = jobs.find(index);
+    if (it == jobs.end()) {
+      respond(call, fl_value_new_null());
+      return;
+    }
+
+    if (it->second.state != "sent") {
+      respond(call, encodeStatus(index, it->second, ""));
+      return;
+    }
+
+    // Only a submitted job has a state on the printer, asked off the main
+    // thread.
+    g_object_ref(call);
+    auto job = it->second.job;
+    std::thread([owner = owner, call, job, index] {
+      auto printerState = job->printerState();
+      owner->post([call, index, printerState](PrintingPlugin* plugin) {
+        FlValue* status = nullptr;
+        if (plugin) {
+          auto it = plugin->jobs.find(index);
+          if (it != plugin->jobs.end()) {
+            status = encodeStatus(index, it->second, printerState);
+          }
+        }
+        respond(call, status ? status : fl_value_new_null());
+        g_object_unref(call);
+      });
+    }).detach();
+  }
+
+  // A job still laid out fails as soon as Dart sends its document.
+  void cancelPrintJob(FlMethodCall* call, int index) {
+    auto it = jobs.find(index);
+    if (it == jobs.end()) {
+      respond(call, fl_value_new_bool(false));
+      return;
+    }
+
+    // Waits for the chunk being sent and asks the printer, off the main
+    // thread.
+    g_object_ref(call);
+    auto job = it->second.job;
+    std::thread([owner = owner, call, job] {
+      auto cancelled = job->cancel();
+      owner->post([call, cancelled](PrintingPlugin*) {
+        respond(call, fl_value_new_bool(cancelled));
+        g_object_unref(call);
+      });
+    }).detach();
+  }
+
+#ifdef PRINTING_TEXTURES
+  // Shows a document given as bytes, there are no open documents here.
+  void createTexture(FlMethodCall* call, FlValue* args) {
+    auto doc = lookup(args, "doc");
+    if (!doc || fl_value_get_type(doc) != FL_VALUE_TYPE_UINT8_LIST) {
+      fl_method_call_respond_error(call, "createTexture", "Unknown document",
+                                   nullptr, nullptr);
+      return;
+    }
+
+    std::string error;
+    auto texture =
+        PageTexture::create(textureRegistrar, fl_value_get_uint8_list(doc),
+                            fl_value_get_length(doc), error);
+    if (!texture) {
+      fl_method_call_respond_error(call, "createTexture", error.c_str(),
+                                   nullptr, nullptr);
+      return;
+    }
+
+    textures[texture->id()] = texture;
+    respond(call, fl_value_new_int(texture->id()));
+  }
+
+  // Renders off the main thread and answers with the frame size, or null if
+  // the page cannot be rendered or a newer render was requested meanwhile.
+  // The engine hears about the frame on the main thread.
+  void renderTexture(FlMethodCall* call,
+                     int64_t id,
+                     int page,
+                     double scale) {
+    auto it = textures.find(id);
+    if (it == textures.end()) {
+      fl_method_call_respond_error(call, "renderTexture", "Unknown texture",
+                                   nullptr, nullptr);
+      return;
+    }
+
+    g_object_ref(call);
+    auto texture = it->second;
+    auto request = texture->request();
+    std::thread([owner = owner, call, texture, request, page, scale] {
+      auto width = 0, height = 0;
+      auto rendered = texture->render(request, page, scale, width, height);
+      owner->post([call, texture, rendered, width, height](PrintingPlugin*) {
+        if (!rendered) {
+          respond(call, fl_value_new_null());
+        } else {
+          texture->frameAvailable();
+          auto size = fl_value_new_map();
+          fl_value_set_string_take(size, "width", fl_value_new_int(width));
+          fl_value_set_string_take(size, "height", fl_value_new_int(height));
+          respond(call, size);
+        }
+        g_object_unref(call);
+      });
+    }).detach();
+  }
+#endif
+
+  static FlValue* encodeStatus(int index,
+                               const JobStatus& status,
+                               const std::string& printerState) {
+    auto map = fl_value_new_map();
+    fl_value_set_string_take(map, "job", fl_value_new_int(index));
+    fl_value_set_string_take(map, "name",
+                             fl_value_new_string(status.job->name().c_str()));
+    fl_value_set_string_take(map, "state",
+                             fl_value_new_string(status.state.c_str()));
+    fl_value_set_string_take(map, "sent", fl_value_new_int(status.sent));
+    fl_value_set_string_take(map, "total", fl_value_new_int(status.total));
+    fl_value_set_string_take(map, "printerJob",
+                             fl_value_new_int(status.job->printerJobId()));
+    if (!status.error.empty()) {
+      fl_value_set_string_take(map, "error",
+                               fl_value_new_string(status.error.c_str()));
+    }
+    if (!printerState.empty()) {
+      fl_value_set_string_take(map, "printerState",
+                               fl_value_new_string(printerState.c_str()));
+    }
+    return map;
+  }
+
+  void onPrintersChanged(const std::vector<Printer>& printers) {
+    auto args = fl_value_new_map();
+    fl_value_set_string_take(args, "printers", encode(printers));
+    invoke("onPrintersChanged", args);
+  }
+
+  FlMethodChannel* channel;
+#ifdef PRINTING_TEXTURES
+  FlTextureRegistrar* textureRegistrar;
+#endif
+  TaskRunner runner;
+  std::shared_ptr<Owner> owner;
+  PrinterWatcher watcher;
+  std::map<int, JobStatus> jobs;
+  std::deque<int> finished;
+#ifdef PRINTING_TEXTURES
+  std::map<int64_t, std::shared_ptr<PageTexture>> textures;
+#endif
+};
+
+static void methodCallCallback(FlMethodChannel* channel,
+                               FlMethodCall* call,
+                               gpointer data) {
+  static_cast<PrintingPlugin*>(data)->handleMethodCall(call);
+}
+
+static void deletePlugin(gpointer data) {
+  delete static_cast<PrintingPlugin*>(data);
+}
+
+void printing_plugin_register_with_registrar(FlPluginRegistrar* registrar) {
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  g_autoptr(FlMethodChannel) channel =
+      fl_method_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                            "printing", FL_METHOD_CODEC(codec));
+
+  // The plugin lives as long as the handler of its channel.
+  fl_method_channel_set_method_call_handler(
+      channel, methodCallCallback,
+      new PrintingPlugin(channel,
+                         fl_plugin_registrar_get_texture_registrar(registrar)),
+      deletePlugin);
+}
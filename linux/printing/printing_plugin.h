@@ -0,0 +1,9 @@
+#ifndef FLUTTER_PLUGIN_PRINTING_PLUGIN_H_
+#define FLUTTER_PLUGIN_PRINTING_PLUGIN_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+// Registers the "printing" method channel, printing through CUPS.
+void printing_plugin_register_with_registrar(FlPluginRegistrar* registrar);
+
+#endif  // FLUTTER_PLUGIN_PRINTING_PLUGIN_H_
@@ -0,0 +1,21 @@
+#include "task_runner.h"
+
+#include <glib.h>
+
+using Task = std::function<void()>;
+
+static gboolean runTask(gpointer data) {
+  (*static_cast<Task*>(data))();
+  return G_SOURCE_REMOVE;
+}
+
+static void deleteTask(gpointer data) {
+  delete static_cast<Task*>(data);
+}
+
+void TaskRunner::post(std::function<void()> task) {
+  // Always deferred, even from the main thread, so a task never runs in
+  // the middle of its caller.
+  g_idle_add_full(G_PRIORITY_DEFAULT, runTask, new Task(std::move(task)),
+                  deleteTask);
+}
@@ -0,0 +1,13 @@
+#ifndef PRINTING_PLUGIN_TASK_RUNNER_H_
+#define PRINTING_PLUGIN_TASK_RUNNER_H_
+
+#include <functional>
+
+// Runs tasks posted from any thread on the GLib main loop, where the
+// printing channel may be used.
+class TaskRunner {
+ public:
+  void post(std::function<void()> task);
+};
+
+#endif
@@ -0,0 +1,151 @@
+// Checks the C interface of libprinting_raster the way the dart:ffi
+// bindings call it.
+
+#include <stdint.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pdf_raster.h"
+#include "printing_test_util.h"
+
+using Document = net_nfet_printing_raster_document;
+
+static std::vector<uint8_t> testDocument() {
+  // A red square at the bottom left corner of the first page.
+  return makePdf({{200, 100, "First", "1 0 0 rg 0 0 50 50 re f"},
+                  {300, 400, "Second"}});
+}
+
+static Document* openDocument(const std::vector<uint8_t>& data, int32_t& status) {
+  return net_nfet_printing_raster_open(data.data(), data.size(), &status);
+}
+
+static void opensDocuments() {
+  EXPECT(net_nfet_printing_raster_version() ==
+         NET_NFET_PRINTING_RASTER_VERSION);
+
+  int32_t status = -1;
+  EXPECT(net_nfet_printing_raster_open(nullptr, 10, &status) == nullptr);
+  EXPECT(status == NET_NFET_PRINTING_RASTER_BAD_ARGUMENT);
+
+  std::string text = "not a pdf file";
+  EXPECT(openDocument(std::vector<uint8_t>(text.begin(), text.end()), status) ==
+         nullptr);
+  EXPECT(status == NET_NFET_PRINTING_RASTER_BAD_DOCUMENT);
+
+  // The bytes are copied, the caller may free them right away.
+  auto data = testDocument();
+  auto document = openDocument(data, status);
+  data.assign(data.size(), 0);
+  EXPECT(document != nullptr);
+  EXPECT(status == NET_NFET_PRINTING_RASTER_OK);
+  EXPECT(net_nfet_printing_raster_page_count(document) == 2);
+  EXPECT(net_nfet_printing_raster_page_count(nullptr) == -1);
+
+  double width = 0, height = 0;
+  EXPECT(net_nfet_printing_raster_page_size(document, 1, &width, &height) ==
+         NET_NFET_PRINTING_RASTER_OK);
+  EXPECT(width == 300 && height == 400);
+  EXPECT(net_nfet_printing_raster_page_size(document, 2, &width, &height) ==
+         NET_NFET_PRINTING_RASTER_BAD_PAGE);
+  EXPECT(net_nfet_printing_raster_page_size(document, -1, &width, &height) ==
+         NET_NFET_PRINTING_RASTER_BAD_PAGE);
+
+  net_nfet_printing_raster_close(document);
+  net_nfet_printing_raster_close(nullptr);
+}
+
+static void rendersIntoCallerMemory() {
+  int32_t status;
+  auto document = openDocument(testDocument(), status);
+  EXPECT(document != nullptr);
+
+  // Rows padded past the pixels, the padding must be left untouched.
+  const int32_t width = 200, height = 100, stride = width * 4 + 16;
+  std::vector<uint8_t> buffer(static_cast<size_t>(stride) * height, 0xab);
+  EXPECT(net_nfet_printing_raster_render(document, 0, buffer.data(), width,
+                                         height, stride) ==
+         NET_NFET_PRINTING_RASTER_OK);
+
+  auto pixel = [&](int x, int y) { return &buffer[y * stride + x * 4]; };
+
+  // RGBA, red at the bottom left, white elsewhere.
+  auto red = pixel(10, height - 10);
+  EXPECT(red[0] == 255 && red[1] == 0 && red[2] == 0 && red[3] == 255);
+  auto white = pixel(width - 10, height - 10);
+  EXPECT(white[0] == 255 && white[1] == 255 && white[2] == 255);
+
+  // The text is drawn at the top left.
+  auto inked = false;
+  for (auto y = 5; y < 25 && !inked; y++) {
+    for (auto x = 10; x < 50 && !inked; x++) {
+      inked = pixel(x, y)[0] < 128;
+    }
+  }
+  EXPECT(inked);
+
+  auto padded = true;
+  for (auto y = 0; y < height; y++) {
+    for (auto x = width * 4; x < stride; x++) {
+      padded = padded && buffer[y * stride + x] == 0xab;
+    }
+  }
+  EXPECT(padded);
+
+  EXPECT(net_nfet_printing_raster_render(document, 2, buffer.data(), width,
+                                         height, stride) ==
+         NET_NFET_PRINTING_RASTER_BAD_PAGE);
+  EXPECT(net_nfet_printing_raster_render(document, 0, buffer.data(), width,
+                                         height, width * 4 - 1) ==
+         NET_NFET_PRINTING_RASTER_BAD_ARGUMENT);
+  EXPECT(net_nfet_printing_raster_render(document, 0, nullptr, width, height,
+                                         stride) ==
+         NET_NFET_PRINTING_RASTER_BAD_ARGUMENT);
+
+  net_nfet_printing_raster_close(document);
+}
+
+// Isolates render documents of their own at the same time.
+static void rendersFromSeveralThreads() {
+  const int32_t width = 150, height = 200;
+  auto render = [&](std::vector<uint8_t>& pixels) {
+    int32_t status;
+    auto document = openDocument(testDocument(), status);
+    pixels.resize(static_cast<size_t>(width) * 4 * height);
+    for (auto i = 0; i < 20 && document; i++) {
+      if (net_nfet_printing_raster_render(document, 1, pixels.data(), width,
+                                          height, width * 4) !=
+          NET_NFET_PRINTING_RASTER_OK) {
+        pixels.clear();
+        break;
+      }
+    }
+    net_nfet_printing_raster_close(document);
+  };
+
+  std::vector<uint8_t> expected;
+  render(expected);
+  EXPECT(!expected.empty());
+
+  std::vector<std::vector<uint8_t>> results(4);
+  std::vector<std::thread> threads;
+  for (auto& pixels : results) {
+    threads.emplace_back([&render, &pixels] { render(pixels); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (auto& pixels : results) {
+    EXPECT(pixels == expected);
+  }
+}
+
+int main() {
+  opensDocuments();
+  rendersIntoCallerMemory();
+  rendersFromSeveralThreads();
+  return testFailures();
+}
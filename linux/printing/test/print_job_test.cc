@@ -0,0 +1,219 @@
+// Sends jobs to an ippeveprinter started for the test, the IPP Everywhere
+// printer simulator of the CUPS tools. Skipped if it is not installed.
+//
+// print_job_test <path to ippeveprinter>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "print_job.h"
+#include "printing_test_util.h"
+
+// ctest SKIP_RETURN_CODE.
+static const int skipped = 77;
+
+static bool acceptsConnections(int port) {
+  auto fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(static_cast<uint16_t>(port));
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  auto connected =
+      connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+  close(fd);
+  return connected;
+}
+
+// Runs ippeveprinter on port with a private spool directory, until the
+// instance is destroyed.
+class TestPrinter {
+ public:
+  TestPrinter(const std::string& program, int port) : port{port} {
+    char directory[] = "/tmp/print_job_test.XXXXXX";
+    if (!mkdtemp(directory)) {
+      return;
+    }
+    spool = directory;
+
+    pid = fork();
+    if (pid == 0) {
+      auto portArg = std::to_string(port);
+      execl(program.c_str(), program.c_str(), "-p", portArg.c_str(), "-f",
+            "application/pdf", "-d", spool.c_str(), "-n", "localhost", "-r",
+            "off", "Test", static_cast<char*>(nullptr));
+      _exit(127);
+    }
+
+    for (auto i = 0; i < 100 && pid > 0; i++) {
+      if (acceptsConnections(port)) {
+        ready = true;
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+  }
+
+  ~TestPrinter() {
+    if (pid > 0) {
+      kill(pid, SIGTERM);
+      waitpid(pid, nullptr, 0);
+    }
+    if (!spool.empty()) {
+      auto command = "rm -rf '" + spool + "'";
+      if (system(command.c_str()) != 0) {
+        std::fprintf(stderr, "cannot remove %s\n", spool.c_str());
+      }
+    }
+  }
+
+  std::string uri() const {
+    return "ipp://localhost:" + std::to_string(port) + "/ipp/print";
+  }
+
+  bool ready = false;
+
+ private:
+  const int port;
+  pid_t pid = -1;
+  std::string spool;
+};
+
+static void opensThePrinter(const TestPrinter& printer) {
+  PrintJob job{1, "", "open"};
+  PageMetrics metrics;
+  std::string error;
+  EXPECT(job.open(printer.uri(), 595, 842, metrics, error));
+  EXPECT(error.empty());
+  EXPECT(metrics.pageWidth > 0 && metrics.pageHeight > metrics.pageWidth);
+  EXPECT(job.printerJobId() == 0);
+
+  PrintJob missing{2, "", "missing"};
+  EXPECT(!missing.open("ipp://localhost:1/ipp/print", 595, 842, metrics,
+                       error));
+  EXPECT(!error.empty());
+}
+
+static void streamsADocument(const TestPrinter& printer) {
+  PrintJob job{3, "", "stream"};
+  PageMetrics metrics;
+  std::string error;
+  EXPECT(job.open(printer.uri(), 612, 792, metrics, error));
+
+  // More than one chunk, sent without a temporary file.
+  auto data = makePdf({{612, 792, std::string(200 * 1024, 'a')},
+                       {612, 792, "Second page"}});
+  std::vector<size_t> progress;
+  auto written = job.write(
+      data,
+      [&progress](size_t sent, size_t total) { progress.push_back(sent); },
+      error);
+  EXPECT(written);
+  EXPECT(error.empty());
+  EXPECT(job.printerJobId() > 0);
+
+  EXPECT(progress.size() > 1);
+  for (size_t i = 1; i < progress.size(); i++) {
+    EXPECT(progress[i] > progress[i - 1]);
+  }
+  EXPECT(!progress.empty() && progress.back() == data.size());
+
+  auto state = job.printerState();
+  EXPECT(state == "pending" || state == "processing" || state == "completed");
+}
+
+static void cancelsWhileStreaming(const TestPrinter& printer) {
+  PrintJob job{4, "", "cancel"};
+  PageMetrics metrics;
+  std::string error;
+  EXPECT(job.open(printer.uri(), 612, 792, metrics, error));
+
+  auto data = makePdf({{612, 792, std::string(8 * 1024 * 1024, 'c')}});
+  std::thread canceller;
+  std::atomic<bool> started{false};
+  auto cancelled = false;
+  size_t lastSent = 0;
+  auto written = job.write(
+      data,
+      [&](size_t sent, size_t total) {
+        lastSent = sent;
+        if (!canceller.joinable()) {
+          // cancel waits for the write, it cannot run on this thread. The
+          // write goes on once cancel had time to raise its flag.
+          canceller = std::thread([&] {
+            started = true;
+            cancelled = job.cancel();
+          });
+          while (!started) {
+            std::this_thread::yield();
+          }
+          std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+      },
+      error);
+  canceller.join();
+
+  EXPECT(!written);
+  EXPECT(error == "Cancelled");
+  EXPECT(lastSent < data.size());
+  EXPECT(job.printerJobId() > 0);
+  // The printer may abort the truncated document before it is cancelled.
+  auto state = job.printerState();
+  EXPECT(cancelled ? state == "canceled" : state == "aborted");
+}
+
+static void cancelsBeforeTheDocument(const TestPrinter& printer) {
+  PrintJob job{5, "", "layout"};
+  PageMetrics metrics;
+  std::string error;
+  EXPECT(job.open(printer.uri(), 612, 792, metrics, error));
+
+  // Cancelled while Dart lays the document out.
+  EXPECT(job.cancel());
+  EXPECT(!job.write(makePdf({{612, 792, "Late"}}), nullptr, error));
+  EXPECT(error == "Cancelled");
+  EXPECT(job.printerJobId() == 0);
+}
+
+static void cancelsAQueuedJob(const TestPrinter& printer) {
+  PrintJob job{6, "", "queued"};
+  PageMetrics metrics;
+  std::string error;
+  EXPECT(job.open(printer.uri(), 612, 792, metrics, error));
+  EXPECT(job.write(makePdf({{612, 792, "Queued"}}), nullptr, error));
+
+  // The simulator may already be done with such a small job.
+  auto cancelled = job.cancel();
+  auto state = job.printerState();
+  EXPECT(cancelled ? state == "canceled" : state == "completed");
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 2 || access(argv[1], X_OK) != 0) {
+    std::fprintf(stderr, "ippeveprinter not found, skipped\n");
+    return skipped;
+  }
+
+  TestPrinter printer{argv[1], 20000 + getpid() % 10000};
+  EXPECT(printer.ready);
+  if (!printer.ready) {
+    return testFailures();
+  }
+
+  opensThePrinter(printer);
+  streamsADocument(printer);
+  cancelsWhileStreaming(printer);
+  cancelsBeforeTheDocument(printer);
+  cancelsAQueuedJob(printer);
+  return testFailures();
+}
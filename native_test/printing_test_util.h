@@ -0,0 +1,95 @@
+#ifndef PRINTING_TEST_UTIL_H_
+#define PRINTING_TEST_UTIL_H_
+
+// Checks and generated documents shared by the printing tests of the Linux
+// and Windows runners. Portable C++14, platform helpers stay with the tests
+// of each runner.
+
+#include <cstdint>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Minimal checks for the test executables, which return testFailures()
+// from main so that ctest reports them.
+inline int& testFailures() {
+  static int failures = 0;
+  return failures;
+}
+
+#define EXPECT(condition)                                                 \
+  do {                                                                    \
+    if (!(condition)) {                                                   \
+      std::fprintf(stderr, "%s:%d: failed: %s\n", __FILE__, __LINE__,     \
+                   #condition);                                           \
+      testFailures()++;                                                   \
+    }                                                                     \
+  } while (false)
+
+struct TestPage {
+  double width;
+  double height;
+  std::string text;  // ASCII, shown in Helvetica at the top left
+  std::string drawing = "";  // content stream operators drawn before it
+};
+
+// A well-formed PDF 1.7 file of pages, with catalogEntries added to the
+// document catalog, e.g. "/ViewerPreferences << /NumCopies 2 >>".
+inline std::vector<uint8_t> makePdf(const std::vector<TestPage>& pages,
+                                    const std::string& catalogEntries = "") {
+  std::vector<std::string> objects;
+  objects.push_back("<< /Type /Catalog /Pages 2 0 R " + catalogEntries +
+                    " >>");
+
+  std::ostringstream kids;
+  for (size_t i = 0; i < pages.size(); i++) {
+    kids << (4 + i * 2) << " 0 R ";
+  }
+  objects.push_back("<< /Type /Pages /Kids [" + kids.str() +
+                    "] /Count " + std::to_string(pages.size()) + " >>");
+  objects.push_back(
+      "<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>");
+
+  for (size_t i = 0; i < pages.size(); i++) {
+    std::ostringstream page;
+    page << "<< /Type /Page /Parent 2 0 R /MediaBox [0 0 " << pages[i].width
+         << ' ' << pages[i].height
+         << "] /Resources << /Font << /F1 3 0 R >> >> /Contents "
+         << (5 + i * 2) << " 0 R >>";
+    objects.push_back(page.str());
+
+    std::ostringstream content;
+    if (!pages[i].drawing.empty()) {
+      content << pages[i].drawing << ' ';
+    }
+    content << "BT /F1 12 Tf 10 " << (pages[i].height - 20) << " Td ("
+            << pages[i].text << ") Tj ET";
+    auto stream = content.str();
+    objects.push_back("<< /Length " + std::to_string(stream.size()) +
+                      " >>\nstream\n" + stream + "\nendstream");
+  }
+
+  std::string file = "%PDF-1.7\n";
+  std::vector<size_t> offsets;
+  for (size_t i = 0; i < objects.size(); i++) {
+    offsets.push_back(file.size());
+    file += std::to_string(i + 1) + " 0 obj\n" + objects[i] + "\nendobj\n";
+  }
+
+  auto xref = file.size();
+  file += "xref\n0 " + std::to_string(objects.size() + 1) +
+          "\n0000000000 65535 f \n";
+  for (auto offset : offsets) {
+    char entry[21];
+    std::snprintf(entry, sizeof(entry), "%010zu 00000 n \n", offset);
+    file += entry;
+  }
+  file += "trailer\n<< /Size " + std::to_string(objects.size() + 1) +
+          " /Root 1 0 R >>\nstartxref\n" + std::to_string(xref) +
+          "\n%%EOF\n";
+
+  return std::vector<uint8_t>(file.begin(), file.end());
+}
+
+#endif
@@ -3,10 +3,17 @@
 #include <windows.h>
 
 #include "flutter_window.h"
+#include "printing/raster_worker.h"
 #include "utils.h"
 
 int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
                       _In_ wchar_t *command_line, _In_ int show_command) {
+  // A raster worker of the printing plugin, without Flutter or a window.
+  std::wstring raster_pipe;
+  if (isRasterWorker(command_line, raster_pipe)) {
+    return runRasterWorker(raster_pipe);
+  }
+
   // Attach to console when present (e.g., 'flutter run') or create a
   // new console when running with a debugger.
   if (!::AttachConsole(ATTACH_PARENT_PROCESS) && ::IsDebuggerPresent()) {
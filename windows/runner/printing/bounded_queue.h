@@ -0,0 +1,58 @@
+#ifndef PRINTING_PLUGIN_BOUNDED_QUEUE_H_
+#define PRINTING_PLUGIN_BOUNDED_QUEUE_H_
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+// A blocking FIFO with a fixed capacity, shared between one producer thread
+// and one consumer thread.
+// push() waits while the queue is full, pop() waits while it is empty.
+// Once close() is called, push() fails immediately and pop() drains the
+// remaining items before it fails.
+template <typename T>
+class BoundedQueue {
+ public:
+  explicit BoundedQueue(size_t capacity)
+      : capacity{capacity > 0 ? capacity : 1} {}
+
+  bool push(T item) {
+    std::unique_lock<std::mutex> lock{mutex};
+    notFull.wait(lock, [this] { return closed || items.size() < capacity; });
+    if (closed) {
+      return false;
+    }
+    items.push_back(std::move(item));
+    notEmpty.notify_one();
+    return true;
+  }
+
+  bool pop(T& item) {
+    std::unique_lock<std::mutex> lock{mutex};
+    notEmpty.wait(lock, [this] { return closed || !items.empty(); });
+    if (items.empty()) {
+      return false;
+    }
+    item = std::move(items.front());
+    items.pop_front();
+    notFull.notify_one();
+    return true;
+  }
+
+  void close() {
+    std::lock_guard<std::mutex> lock{mutex};
+    closed = true;
+    notFull.notify_all();
+    notEmpty.notify_all();
+  }
+
+ private:
+  const size_t capacity;
+  std::mutex mutex;
+  std::condition_variable notFull;
+  std::condition_variable notEmpty;
+  std::deque<T> items;
+  bool closed = false;
+};
+
+#endif
@@ -0,0 +1,137 @@
+#include "device_bitmap.h"
+
+#include <algorithm>
+
+#include "fpdf_edit.h"
+
+size_t DeviceBitmap::size(int width, int height, int bitsPerPixel) {
+  // DIB rows are aligned on 32 bits.
+  auto stride = (static_cast<size_t>(width) * bitsPerPixel + 31) / 32 * 4;
+  return stride * height;
+}
+
+int64_t DeviceBitmap::imageBytes(FPDF_PAGE page) {
+  int64_t bytes = 0;
+  auto count = FPDFPage_CountObjects(page);
+  for (auto i = 0; i < count; i++) {
+    auto object = FPDFPage_GetObject(page, i);
+    if (FPDFPageObj_GetType(object) != FPDF_PAGEOBJ_IMAGE) {
+      continue;
+    }
+
+    FPDF_IMAGEOBJ_METADATA metadata;
+    if (!FPDFImageObj_GetImageMetadata(object, page, &metadata)) {
+      continue;
+    }
+
+    auto bitsPerPixel = metadata.bits_per_pixel ? metadata.bits_per_pixel : 24;
+    bytes += static_cast<int64_t>(metadata.width) * metadata.height *
+             bitsPerPixel / 8;
+  }
+  return bytes;
+}
+
+bool DeviceBitmap::render(FPDF_PAGE page,
+                          double dpiX,
+                          double dpiY,
+                          bool monochrome) {
+  auto renderWidth = static_cast<int>(FPDF_GetPageWidth(page) * dpiX);
+  auto renderHeight = static_cast<int>(FPDF_GetPageHeight(page) * dpiY);
+  if (renderWidth <= 0 || renderHeight <= 0) {
+    return false;
+  }
+
+  auto renderStride = renderWidth * 4;
+  std::vector<uint8_t> pixels(static_cast<size_t>(renderStride) *
+                              renderHeight);
+
+  auto bitmap = FPDFBitmap_CreateEx(renderWidth, renderHeight, FPDFBitmap_BGRx,
+                                    pixels.data(), renderStride);
+  FPDFBitmap_FillRect(bitmap, 0, 0, renderWidth, renderHeight, 0xffffffff);
+  FPDF_RenderPageBitmap(bitmap, page, 0, 0, renderWidth, renderHeight, 0,
+                        FPDF_ANNOT | FPDF_PRINTING);
+  FPDFBitmap_Destroy(bitmap);
+
+  pack(pixels.data(), renderStride, renderWidth, renderHeight, monochrome);
+  return true;
+}
+
+void DeviceBitmap::pack(const uint8_t* bgrx,
+                        int srcStride,
+                        int width,
+                        int height,
+                        bool monochrome) {
+  this->width = width;
+  this->height = height;
+  bitsPerPixel = monochrome ? 1 : 24;
+  bits.assign(size(width, height, bitsPerPixel), 0);
+  stride = static_cast<int>(bits.size() / height);
+
+  if (!monochrome) {
+    for (auto y = 0; y < height; y++) {
+      auto src = bgrx + static_cast<size_t>(y) * srcStride;
+      auto dst = bits.data() + static_cast<size_t>(y) * stride;
+      for (auto x = 0; x < width; x++, src += 4, dst += 3) {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+      }
+    }
+    return;
+  }
+
+  // Floyd-Steinberg, errors kept in sixteenths for the current and the next
+  // row, with one pixel of padding on each side.
+  std::vector<int> errors(static_cast<size_t>(width + 2) * 2);
+  auto current = errors.data() + 1;
+  auto next = current + width + 2;
+
+  for (auto y = 0; y < height; y++) {
+    std::fill(next - 1, next + width + 1, 0);
+    auto src = bgrx + static_cast<size_t>(y) * srcStride;
+    auto dst = bits.data() + static_cast<size_t>(y) * stride;
+
+    for (auto x = 0; x < width; x++, src += 4) {
+      auto gray = (src[2] * 77 + src[1] * 150 + src[0] * 29) >> 8;
+      auto value = gray + current[x] / 16;
+      auto white = value >= 128;
+      if (white) {
+        // Palette entry 1 is white.
+        dst[x >> 3] |= 0x80 >> (x & 7);
+      }
+
+      auto error = value - (white ? 255 : 0);
+      current[x + 1] += error * 7;
+      next[x - 1] += error * 3;
+      next[x] += error * 5;
+      next[x + 1] += error;
+    }
+
+    std::swap(current, next);
+  }
+}
+
+void DeviceBitmap::draw(HDC hDC, int x, int y) const {
+  struct {
+    BITMAPINFOHEADER header;
+    RGBQUAD colors[2];
+  } info;
+  ZeroMemory(&info, sizeof(info));
+  info.header.biSize = sizeof(info.header);
+  info.header.biWidth = width;
+  info.header.biHeight = -height;  // top-down
+  info.header.biPlanes = 1;
+  info.header.biBitCount = static_cast<WORD>(bitsPerPixel);
+  info.header.biCompression = BI_RGB;
+
+  if (bitsPerPixel == 1) {
+    info.header.biClrUsed = 2;
+    info.colors[1].rgbBlue = 255;
+    info.colors[1].rgbGreen = 255;
+    info.colors[1].rgbRed = 255;
+  }
+
+  StretchDIBits(hDC, x, y, width, height, 0, 0, width, height, bits.data(),
+                reinterpret_cast<const BITMAPINFO*>(&info), DIB_RGB_COLORS,
+                SRCCOPY);
+}
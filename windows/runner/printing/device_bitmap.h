@@ -0,0 +1,43 @@
+#ifndef PRINTING_PLUGIN_DEVICE_BITMAP_H_
+#define PRINTING_PLUGIN_DEVICE_BITMAP_H_
+
+#include <windows.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "pdfview.h"
+
+// A page rasterized at the printer resolution, in the smallest DIB format
+// the device can use: 1 bit per pixel with error diffusion for monochrome
+// printers, 24 bits otherwise.
+struct DeviceBitmap {
+  int width = 0;
+  int height = 0;
+  int bitsPerPixel = 24;
+  int stride = 0;
+  std::vector<uint8_t> bits;  // top-down rows
+
+  // Size of a width x height bitmap at bitsPerPixel.
+  static size_t size(int width, int height, int bitsPerPixel);
+
+  // Decoded size of the images placed directly on page, images nested in
+  // form objects are not counted. The PDFium lock must be held.
+  static int64_t imageBytes(FPDF_PAGE page);
+
+  // Renders page at dpiX and dpiY device pixels per point.
+  // The PDFium lock must be held.
+  bool render(FPDF_PAGE page, double dpiX, double dpiY, bool monochrome);
+
+  // Converts a BGRx image, to gray then 1 bit per pixel if monochrome.
+  void pack(const uint8_t* bgrx,
+            int srcStride,
+            int width,
+            int height,
+            bool monochrome);
+
+  // Draws the bitmap at its size with its top left corner at x, y.
+  void draw(HDC hDC, int x, int y) const;
+};
+
+#endif
@@ -0,0 +1,80 @@
+#include "document_probe.h"
+
+#include "pdfium.h"
+#include "trace.h"
+
+DocumentProbe DocumentProbe::read(FPDF_DOCUMENT doc) {
+  DocumentProbe result;
+
+  result.pageCount = FPDF_GetPageCount(doc);
+  result.sizes.resize(static_cast<size_t>(result.pageCount) * 2);
+  for (auto i = 0; i < result.pageCount; i++) {
+    FS_SIZEF size{0, 0};
+    FPDF_GetPageSizeByIndexF(doc, i, &size);
+    result.sizes[i * 2] = size.width;
+    result.sizes[i * 2 + 1] = size.height;
+  }
+
+  if (!FPDF_GetFileVersion(doc, &result.fileVersion)) {
+    result.fileVersion = 0;
+  }
+  result.permissions = static_cast<int64_t>(FPDF_GetDocPermissions(doc));
+
+  result.printScaling = FPDF_VIEWERREF_GetPrintScaling(doc) != 0;
+  result.numCopies = FPDF_VIEWERREF_GetNumCopies(doc);
+  result.duplex = static_cast<int>(FPDF_VIEWERREF_GetDuplex(doc));
+
+  // Pairs of 1-based first and last page numbers. A pair that is reversed
+  // or out of the document is dropped as a whole, so that the following
+  // pairs stay aligned.
+  auto range = FPDF_VIEWERREF_GetPrintPageRange(doc);
+  if (range) {
+    auto count = FPDF_VIEWERREF_GetPrintPageRangeCount(range);
+    for (size_t i = 0; i + 1 < count; i += 2) {
+      auto first = FPDF_VIEWERREF_GetPrintPageRangeElement(range, i) - 1;
+      auto last = FPDF_VIEWERREF_GetPrintPageRangeElement(range, i + 1) - 1;
+      if (first >= 0 && first <= last && last < result.pageCount) {
+        result.printPageRange.push_back(first);
+        result.printPageRange.push_back(last);
+      }
+    }
+  }
+
+  return result;
+}
+
+bool DocumentProbe::probe(const std::vector<uint8_t>& data,
+                          DocumentProbe& result,
+                          std::string& error) {
+  PRINTING_TRACE_SCOPE("probeDocument", -1, -1);
+  PdfiumLibrary library;
+  PdfiumLock lock{pdfiumMutex()};
+
+  auto doc = FPDF_LoadMemDocument64(data.data(), data.size(), nullptr);
+  if (!doc) {
+    error = FPDF_GetLastError() == FPDF_ERR_PASSWORD
+                ? "Cannot probe a password protected PDF file"
+                : "Cannot probe a malformed PDF file";
+    return false;
+  }
+
+  result = read(doc);
+  FPDF_CloseDocument(doc);
+  return true;
+}
+
+flutter::EncodableMap DocumentProbe::toMap() const {
+  return flutter::EncodableMap{
+      {flutter::EncodableValue("pageCount"), flutter::EncodableValue(pageCount)},
+      {flutter::EncodableValue("sizes"), flutter::EncodableValue(sizes)},
+      {flutter::EncodableValue("version"), flutter::EncodableValue(fileVersion)},
+      {flutter::EncodableValue("permissions"),
+       flutter::EncodableValue(permissions)},
+      {flutter::EncodableValue("printScaling"),
+       flutter::EncodableValue(printScaling)},
+      {flutter::EncodableValue("numCopies"), flutter::EncodableValue(numCopies)},
+      {flutter::EncodableValue("printPageRange"),
+       flutter::EncodableValue(printPageRange)},
+      {flutter::EncodableValue("duplex"), flutter::EncodableValue(duplex)},
+  };
+}
@@ -0,0 +1,37 @@
+#ifndef PRINTING_PLUGIN_DOCUMENT_PROBE_H_
+#define PRINTING_PLUGIN_DOCUMENT_PROBE_H_
+
+#include <flutter/standard_method_codec.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "pdfview.h"
+
+// What Dart needs to lay out a preview before any page is rendered, read
+// from the document catalog and page tree without loading a page.
+struct DocumentProbe {
+  int pageCount = 0;
+  std::vector<double> sizes;  // width, height per page, in PDF points
+  int fileVersion = 0;        // 17 for PDF 1.7, 0 if unknown
+  int64_t permissions = 0;
+  bool printScaling = true;
+  int numCopies = 1;
+  // Zero-based first and last page of each range, empty for all pages.
+  std::vector<int32_t> printPageRange;
+  int duplex = 0;                       // FPDF_DUPLEXTYPE
+
+  // Must be called while holding a PdfiumLock.
+  static DocumentProbe read(FPDF_DOCUMENT doc);
+
+  // Loads the document only for the probe. Returns false and sets error if
+  // the document cannot be loaded.
+  static bool probe(const std::vector<uint8_t>& data,
+                    DocumentProbe& result,
+                    std::string& error);
+
+  flutter::EncodableMap toMap() const;
+};
+
+#endif
@@ -0,0 +1,128 @@
+#include "flight_recorder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <vector>
+
+// Must be a power of two.
+static const uint64_t capacity = 1 << 12;
+
+static const char* eventNames[] = {
+    "enqueue", "start", "pageRendered", "pageSent", "completed", "error",
+};
+
+// One record, written and read as a seqlock: sequence is 0 while the slot
+// is empty or being written, and the record number + 1 once complete.
+struct Slot {
+  std::atomic<uint64_t> sequence{0};
+  std::atomic<int64_t> time{0};
+  std::atomic<int32_t> job{0};
+  std::atomic<int32_t> page{0};
+  std::atomic<uint8_t> event{0};
+};
+
+struct Record {
+  uint64_t sequence;
+  int64_t time;
+  int32_t job;
+  int32_t page;
+  uint8_t event;
+};
+
+static Slot slots[capacity];
+static std::atomic<uint64_t> head{0};
+static const auto epoch = std::chrono::steady_clock::now();
+
+std::wstring fromUtf8(std::string str);
+
+void FlightRecorder::record(FlightEvent event, int job, int page) {
+  auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - epoch)
+                  .count();
+
+  auto n = head.fetch_add(1, std::memory_order_relaxed);
+  auto& slot = slots[n & (capacity - 1)];
+
+  slot.sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.time.store(time, std::memory_order_relaxed);
+  slot.job.store(job, std::memory_order_relaxed);
+  slot.page.store(page, std::memory_order_relaxed);
+  slot.event.store(static_cast<uint8_t>(event), std::memory_order_relaxed);
+  slot.sequence.store(n + 1, std::memory_order_release);
+}
+
+// Copies the complete records, skipping slots being written concurrently.
+static std::vector<Record> snapshot() {
+  std::vector<Record> records;
+  records.reserve(capacity);
+
+  for (auto& slot : slots) {
+    auto sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence == 0) {
+      continue;
+    }
+
+    Record record{
+        sequence,
+        slot.time.load(std::memory_order_relaxed),
+        slot.job.load(std::memory_order_relaxed),
+        slot.page.load(std::memory_order_relaxed),
+        slot.event.load(std::memory_order_relaxed),
+    };
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) == sequence) {
+      records.push_back(record);
+    }
+  }
+
+  std::sort(records.begin(), records.end(),
+            [](const Record& a, const Record& b) {
+              return a.sequence < b.sequence;
+            });
+  return records;
+}
+
+flutter::EncodableMap FlightRecorder::toMap() {
+  auto records = snapshot();
+
+  auto events = flutter::EncodableList{};
+  for (auto name : eventNames) {
+    events.push_back(flutter::EncodableValue(name));
+  }
+
+  std::vector<int64_t> packed;
+  packed.reserve(records.size() * 4);
+  for (auto& r : records) {
+    packed.push_back(r.time);
+    packed.push_back(r.job);
+    packed.push_back(r.page);
+    packed.push_back(r.event);
+  }
+
+  return flutter::EncodableMap{
+      {flutter::EncodableValue("events"), flutter::EncodableValue(events)},
+      {flutter::EncodableValue("records"),
+       flutter::EncodableValue(std::move(packed))},
+  };
+}
+
+bool FlightRecorder::exportTo(const std::string& path) {
+  auto records = snapshot();
+
+  std::ofstream out{fromUtf8(path), std::ios::out | std::ios::trunc};
+  if (!out) {
+    return false;
+  }
+
+  out << "time_ns,job,page,event\n";
+  for (auto& r : records) {
+    out << r.time << ',' << r.job << ',' << r.page << ','
+        << eventNames[r.event] << '\n';
+  }
+
+  return out.good();
+}
@@ -0,0 +1,33 @@
+#ifndef PRINTING_PLUGIN_FLIGHT_RECORDER_H_
+#define PRINTING_PLUGIN_FLIGHT_RECORDER_H_
+
+#include <flutter/standard_method_codec.h>
+
+#include <cstdint>
+#include <string>
+
+enum class FlightEvent : uint8_t {
+  enqueue,
+  start,
+  pageRendered,
+  pageSent,
+  completed,
+  error,
+};
+
+// Always-on record of the last job and page timings, kept in a fixed-size
+// lock-free ring buffer. Unlike PRINTING_TRACE it is compiled in release
+// builds: recording is one atomic increment and a few relaxed stores.
+class FlightRecorder {
+ public:
+  static void record(FlightEvent event, int job, int page = -1);
+
+  // {"events": [names], "records": [time ns, job, page, event, ...]},
+  // oldest record first.
+  static flutter::EncodableMap toMap();
+
+  // Writes the records as CSV. Returns false if the file cannot be written.
+  static bool exportTo(const std::string& path);
+};
+
+#endif
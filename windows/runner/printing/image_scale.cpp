@@ -0,0 +1,55 @@
+#include "image_scale.h"
+
+#include <algorithm>
+#include <vector>
+
+void downscaleImage(const uint8_t* src,
+                    int srcWidth,
+                    int srcHeight,
+                    int srcStride,
+                    uint8_t* dst,
+                    int dstWidth,
+                    int dstHeight,
+                    int dstStride) {
+  // Source columns covered by each destination column, computed once.
+  std::vector<int> x0(dstWidth), x1(dstWidth);
+  for (auto x = 0; x < dstWidth; x++) {
+    x0[x] = static_cast<int>(static_cast<int64_t>(x) * srcWidth / dstWidth);
+    x1[x] = std::max(
+        x0[x] + 1,
+        static_cast<int>(static_cast<int64_t>(x + 1) * srcWidth / dstWidth));
+  }
+
+  std::vector<uint32_t> sums(static_cast<size_t>(dstWidth) * 4);
+
+  for (auto y = 0; y < dstHeight; y++) {
+    auto y0 = static_cast<int>(static_cast<int64_t>(y) * srcHeight / dstHeight);
+    auto y1 = std::max(
+        y0 + 1,
+        static_cast<int>(static_cast<int64_t>(y + 1) * srcHeight / dstHeight));
+
+    std::fill(sums.begin(), sums.end(), 0);
+    for (auto sy = y0; sy < y1; sy++) {
+      auto row = src + static_cast<size_t>(sy) * srcStride;
+      for (auto x = 0; x < dstWidth; x++) {
+        auto sum = &sums[x * 4];
+        for (auto sx = x0[x]; sx < x1[x]; sx++) {
+          auto p = row + sx * 4;
+          sum[0] += p[0];
+          sum[1] += p[1];
+          sum[2] += p[2];
+          sum[3] += p[3];
+        }
+      }
+    }
+
+    auto out = dst + static_cast<size_t>(y) * dstStride;
+    for (auto x = 0; x < dstWidth; x++) {
+      auto count = static_cast<uint32_t>((x1[x] - x0[x]) * (y1 - y0));
+      auto sum = &sums[x * 4];
+      for (auto c = 0; c < 4; c++) {
+        out[x * 4 + c] = static_cast<uint8_t>((sum[c] + count / 2) / count);
+      }
+    }
+  }
+}
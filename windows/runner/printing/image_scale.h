@@ -0,0 +1,19 @@
+#ifndef PRINTING_PLUGIN_IMAGE_SCALE_H_
+#define PRINTING_PLUGIN_IMAGE_SCALE_H_
+
+#include <cstdint>
+
+// Shrinks a 32 bits per pixel image by averaging the source pixels covered
+// by each destination pixel, which keeps text sharp enough to stand in for a
+// render at the smaller size. The destination must not be larger than the
+// source.
+void downscaleImage(const uint8_t* src,
+                    int srcWidth,
+                    int srcHeight,
+                    int srcStride,
+                    uint8_t* dst,
+                    int dstWidth,
+                    int dstHeight,
+                    int dstStride);
+
+#endif
@@ -0,0 +1,208 @@
+#include "imposition.h"
+
+#include <algorithm>
+
+#include "trace.h"
+
+// Places pages[slot] for every slot in reading order, columns x rows on each
+// sheet. A slot of -1 leaves its cell blank.
+static void placeGrid(const std::vector<int>& pages,
+                      const std::vector<FS_SIZEF>& sizes,
+                      const std::vector<int>& slots,
+                      int columns,
+                      int rows,
+                      double sheetWidth,
+                      double sheetHeight,
+                      std::vector<Sheet>& sheets) {
+  auto cells = static_cast<size_t>(columns) * rows;
+  auto cellWidth = sheetWidth / columns;
+  auto cellHeight = sheetHeight / rows;
+
+  for (size_t i = 0; i < slots.size(); i++) {
+    if (i % cells == 0) {
+      sheets.emplace_back();
+    }
+
+    auto slot = slots[i];
+    if (slot < 0 || sizes[slot].width <= 0 || sizes[slot].height <= 0) {
+      continue;
+    }
+
+    auto column = static_cast<int>(i % cells) % columns;
+    auto row = static_cast<int>(i % cells) / columns;
+    auto& size = sizes[slot];
+    auto scale = std::min(cellWidth / size.width, cellHeight / size.height);
+
+    // Centered in its cell.
+    auto left = column * cellWidth;
+    auto top = row * cellHeight;
+    sheets.back().push_back(Placement{
+        pages[slot], left + (cellWidth - size.width * scale) / 2,
+        top + (cellHeight - size.height * scale) / 2, scale,
+        FS_RECTF{static_cast<float>(left), static_cast<float>(top),
+                 static_cast<float>(left + cellWidth),
+                 static_cast<float>(top + cellHeight)}});
+  }
+}
+
+Imposition::Imposition(Mode mode, int columns, int rows)
+    : layoutMode{mode}, columns{std::max(columns, 1)}, rows{std::max(rows, 1)} {}
+
+Imposition::Mode Imposition::modeNamed(const std::string& name) {
+  if (name == "nUp") {
+    return Mode::nUp;
+  }
+  if (name == "booklet") {
+    return Mode::booklet;
+  }
+  if (name == "tile") {
+    return Mode::tile;
+  }
+  return Mode::none;
+}
+
+std::vector<Sheet> Imposition::layout(FPDF_DOCUMENT doc,
+                                      const std::vector<int>& pages,
+                                      double sheetWidth,
+                                      double sheetHeight) const {
+  std::vector<Sheet> sheets;
+  if (sheetWidth <= 0 || sheetHeight <= 0) {
+    return sheets;
+  }
+
+  auto count = static_cast<int>(pages.size());
+  std::vector<FS_SIZEF> sizes(pages.size(), FS_SIZEF{0, 0});
+  for (auto i = 0; i < count; i++) {
+    FPDF_GetPageSizeByIndexF(doc, pages[i], &sizes[i]);
+  }
+
+  switch (layoutMode) {
+    case Mode::none:
+    case Mode::nUp: {
+      std::vector<int> slots(pages.size());
+      for (auto i = 0; i < count; i++) {
+        slots[i] = i;
+      }
+      auto grid = layoutMode == Mode::nUp;
+      placeGrid(pages, sizes, slots, grid ? columns : 1, grid ? rows : 1,
+                sheetWidth, sheetHeight, sheets);
+      break;
+    }
+
+    case Mode::booklet: {
+      // Padded with blank pages to whole sheets of 4 pages. The front of
+      // sheet s carries the last and the first pages not placed yet, its
+      // back the two next to them.
+      auto padded = (count + 3) / 4 * 4;
+      auto slot = [count](int n) { return n < count ? n : -1; };
+      std::vector<int> slots;
+      slots.reserve(padded);
+      for (auto s = 0; s < padded / 4; s++) {
+        slots.push_back(slot(padded - 1 - 2 * s));
+        slots.push_back(slot(2 * s));
+        slots.push_back(slot(2 * s + 1));
+        slots.push_back(slot(padded - 2 - 2 * s));
+      }
+      placeGrid(pages, sizes, slots, 2, 1, sheetWidth, sheetHeight, sheets);
+      break;
+    }
+
+    case Mode::tile: {
+      for (auto i = 0; i < count; i++) {
+        auto& size = sizes[i];
+        if (size.width <= 0 || size.height <= 0) {
+          continue;
+        }
+
+        // Enlarged to fit the whole grid of sheets, then centered on it.
+        auto scale = std::min(columns * sheetWidth / size.width,
+                              rows * sheetHeight / size.height);
+        auto left = (columns * sheetWidth - size.width * scale) / 2;
+        auto top = (rows * sheetHeight - size.height * scale) / 2;
+
+        for (auto row = 0; row < rows; row++) {
+          for (auto column = 0; column < columns; column++) {
+            sheets.push_back(Sheet{Placement{
+                pages[i], left - column * sheetWidth, top - row * sheetHeight,
+                scale,
+                FS_RECTF{0, 0, static_cast<float>(sheetWidth),
+                         static_cast<float>(sheetHeight)}}});
+          }
+        }
+      }
+      break;
+    }
+  }
+
+  return sheets;
+}
+
+void Imposition::render(FPDF_DOCUMENT doc,
+                        const Sheet& sheet,
+                        FPDF_BITMAP bitmap,
+                        double dpiX,
+                        double dpiY,
+                        int flags) {
+  FPDFBitmap_FillRect(bitmap, 0, 0, FPDFBitmap_GetWidth(bitmap),
+                      FPDFBitmap_GetHeight(bitmap), 0xffffffff);
+
+  for (auto& placement : sheet) {
+    auto page = FPDF_LoadPage(doc, placement.page);
+    if (!page) {
+      continue;
+    }
+
+    PRINTING_TRACE_SCOPE("renderPlacement", -1, placement.page);
+    // From page points, top left origin, to sheet pixels.
+    auto matrix = FS_MATRIX{static_cast<float>(placement.scale * dpiX),
+                            0,
+                            0,
+                            static_cast<float>(placement.scale * dpiY),
+                            static_cast<float>(placement.x * dpiX),
+                            static_cast<float>(placement.y * dpiY)};
+    auto clip = FS_RECTF{static_cast<float>(placement.cell.left * dpiX),
+                         static_cast<float>(placement.cell.top * dpiY),
+                         static_cast<float>(placement.cell.right * dpiX),
+                         static_cast<float>(placement.cell.bottom * dpiY)};
+    FPDF_RenderPageBitmapWithMatrix(bitmap, page, &matrix, &clip, flags);
+    FPDF_ClosePage(page);
+  }
+}
+
+void Imposition::draw(FPDF_DOCUMENT doc,
+                      const Sheet& sheet,
+                      HDC hDC,
+                      double dpiX,
+                      double dpiY,
+                      int offsetX,
+                      int offsetY,
+                      int flags) {
+  for (auto& placement : sheet) {
+    auto page = FPDF_LoadPage(doc, placement.page);
+    if (!page) {
+      continue;
+    }
+
+    PRINTING_TRACE_SCOPE("drawPlacement", -1, placement.page);
+    // A scale and a translation only, which the destination rectangle of
+    // FPDF_RenderPage expresses without a world transform, so the page
+    // stays vector in the spool file.
+    auto scaleX = placement.scale * dpiX;
+    auto scaleY = placement.scale * dpiY;
+
+    SaveDC(hDC);
+    IntersectClipRect(hDC,
+                      static_cast<int>(placement.cell.left * dpiX) - offsetX,
+                      static_cast<int>(placement.cell.top * dpiY) - offsetY,
+                      static_cast<int>(placement.cell.right * dpiX) - offsetX,
+                      static_cast<int>(placement.cell.bottom * dpiY) - offsetY);
+    FPDF_RenderPage(hDC, page, static_cast<int>(placement.x * dpiX) - offsetX,
+                    static_cast<int>(placement.y * dpiY) - offsetY,
+                    static_cast<int>(FPDF_GetPageWidth(page) * scaleX),
+                    static_cast<int>(FPDF_GetPageHeight(page) * scaleY), 0,
+                    flags);
+    RestoreDC(hDC, -1);
+
+    FPDF_ClosePage(page);
+  }
+}
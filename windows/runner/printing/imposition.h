@@ -0,0 +1,85 @@
+#ifndef PRINTING_PLUGIN_IMPOSITION_H_
+#define PRINTING_PLUGIN_IMPOSITION_H_
+
+#include <windows.h>
+
+#include <string>
+#include <vector>
+
+#include "pdfview.h"
+
+// A source page drawn on a sheet, scaled by scale with its top left corner
+// at x, y, and clipped to its cell. All in points from the top left corner
+// of the sheet.
+struct Placement {
+  int page;
+  double x;
+  double y;
+  double scale;
+  FS_RECTF cell;
+};
+
+// One printed side, with no placement if it is left blank.
+using Sheet = std::vector<Placement>;
+
+// Places several source pages on each sheet, or one source page across
+// several sheets, without building a new PDF. Pages are rendered straight
+// at their place on the sheet.
+class Imposition {
+ public:
+  enum class Mode {
+    none,
+    // columns x rows pages on each sheet, in reading order.
+    nUp,
+    // Two pages side by side, ordered so that the sheets printed on both
+    // sides then folded in the middle read in order.
+    booklet,
+    // Each page enlarged over columns x rows sheets.
+    tile,
+  };
+
+  Imposition() = default;
+
+  Imposition(Mode mode, int columns, int rows);
+
+  // "nUp", "booklet" or "tile", none if unknown.
+  static Mode modeNamed(const std::string& name);
+
+  bool enabled() const { return layoutMode != Mode::none; }
+
+  Mode mode() const { return layoutMode; }
+
+  // Lays out pages of doc on sheets of sheetWidth x sheetHeight points.
+  // The PDFium lock must be held.
+  std::vector<Sheet> layout(FPDF_DOCUMENT doc,
+                            const std::vector<int>& pages,
+                            double sheetWidth,
+                            double sheetHeight) const;
+
+  // Renders sheet into bitmap at dpiX and dpiY pixels per point, over a
+  // white background. The PDFium lock must be held.
+  static void render(FPDF_DOCUMENT doc,
+                     const Sheet& sheet,
+                     FPDF_BITMAP bitmap,
+                     double dpiX,
+                     double dpiY,
+                     int flags);
+
+  // Draws sheet on hDC at dpiX and dpiY device pixels per point, the sheet
+  // origin being at -offsetX, -offsetY. The PDFium lock must be held.
+  static void draw(FPDF_DOCUMENT doc,
+                   const Sheet& sheet,
+                   HDC hDC,
+                   double dpiX,
+                   double dpiY,
+                   int offsetX,
+                   int offsetY,
+                   int flags);
+
+ private:
+  Mode layoutMode = Mode::none;
+  int columns = 1;
+  int rows = 1;
+};
+
+#endif
@@ -0,0 +1,64 @@
+#include "layout_cache.h"
+
+#include <sstream>
+
+#include "memory_stats.h"
+
+LayoutCache::~LayoutCache() {
+  MemoryStats::release(MemoryCategory::document, -1, totalBytes);
+}
+
+std::string LayoutCache::key(const std::string& documentId,
+                             double pageWidth,
+                             double pageHeight,
+                             double marginLeft,
+                             double marginTop,
+                             double marginRight,
+                             double marginBottom) {
+  // Hex floats, so two layouts only match on bit-identical metrics.
+  std::stringstream ss;
+  ss << std::hexfloat << documentId << '|' << pageWidth << ',' << pageHeight
+     << ',' << marginLeft << ',' << marginTop << ',' << marginRight << ','
+     << marginBottom;
+  return ss.str();
+}
+
+LayoutCache::Document LayoutCache::find(const std::string& key) {
+  auto it = index.find(key);
+  if (it == index.end()) {
+    missCount++;
+    return nullptr;
+  }
+
+  hitCount++;
+  lru.splice(lru.begin(), lru, it->second);
+  return it->second->second;
+}
+
+void LayoutCache::store(const std::string& key, Document document) {
+  auto it = index.find(key);
+  if (it != index.end()) {
+    totalBytes -= it->second->second->size();
+    MemoryStats::release(MemoryCategory::document, -1,
+                         it->second->second->size());
+    lru.erase(it->second);
+    index.erase(it);
+  }
+
+  if (document->size() > maxBytes) {
+    return;
+  }
+
+  totalBytes += document->size();
+  MemoryStats::allocate(MemoryCategory::document, -1, document->size());
+  lru.emplace_front(key, std::move(document));
+  index[key] = lru.begin();
+
+  while (totalBytes > maxBytes) {
+    auto& last = lru.back();
+    totalBytes -= last.second->size();
+    MemoryStats::release(MemoryCategory::document, -1, last.second->size());
+    index.erase(last.first);
+    lru.pop_back();
+  }
+}
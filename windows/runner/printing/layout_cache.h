@@ -0,0 +1,54 @@
+#ifndef PRINTING_PLUGIN_LAYOUT_CACHE_H_
+#define PRINTING_PLUGIN_LAYOUT_CACHE_H_
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Documents laid out by Dart in answer to onLayout, keyed by the document
+// identity given by Dart and the exact page metrics they were laid out for.
+// A reprint on the same printer is served from here without a round trip.
+// Least recently used documents are evicted above maxBytes.
+class LayoutCache {
+ public:
+  using Document = std::shared_ptr<const std::vector<uint8_t>>;
+
+  explicit LayoutCache(size_t maxBytes) : maxBytes{maxBytes} {}
+
+  ~LayoutCache();
+
+  static std::string key(const std::string& documentId,
+                         double pageWidth,
+                         double pageHeight,
+                         double marginLeft,
+                         double marginTop,
+                         double marginRight,
+                         double marginBottom);
+
+  // Returns nullptr on a miss.
+  Document find(const std::string& key);
+
+  void store(const std::string& key, Document document);
+
+  size_t hits() const { return hitCount; }
+
+  size_t misses() const { return missCount; }
+
+  size_t entries() const { return index.size(); }
+
+  size_t bytes() const { return totalBytes; }
+
+ private:
+  using Entry = std::pair<std::string, Document>;
+
+  const size_t maxBytes;
+  std::list<Entry> lru;  // most recent first
+  std::unordered_map<std::string, std::list<Entry>::iterator> index;
+  size_t totalBytes = 0;
+  size_t hitCount = 0;
+  size_t missCount = 0;
+};
+
+#endif
@@ -0,0 +1,124 @@
+#include "memory_stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <map>
+#include <mutex>
+
+static const auto categories = static_cast<size_t>(MemoryCategory::count);
+
+static const char* categoryNames[categories] = {
+    "document",
+    "bitmap",
+    "output",
+    "message",
+};
+
+// Jobs with no live bytes left are kept for this many jobs, so a finished
+// job can still be inspected.
+static const size_t finishedJobsKept = 64;
+
+struct Counters {
+  int64_t live[categories] = {};
+  int64_t peak[categories] = {};
+
+  bool empty() const {
+    return std::all_of(std::begin(live), std::end(live),
+                       [](int64_t bytes) { return bytes == 0; });
+  }
+};
+
+static std::atomic<int64_t> globalLive[categories];
+static std::atomic<int64_t> globalPeak[categories];
+
+static std::mutex jobsMutex;
+static std::map<int, Counters> jobs;
+static std::deque<int> finishedJobs;
+
+void MemoryStats::allocate(MemoryCategory category, int job, size_t bytes) {
+  auto c = static_cast<size_t>(category);
+  auto delta = static_cast<int64_t>(bytes);
+
+  auto live = globalLive[c].fetch_add(delta, std::memory_order_relaxed) + delta;
+  auto peak = globalPeak[c].load(std::memory_order_relaxed);
+  while (live > peak && !globalPeak[c].compare_exchange_weak(
+                            peak, live, std::memory_order_relaxed)) {
+  }
+
+  if (job < 0) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock{jobsMutex};
+  auto& counters = jobs[job];
+  counters.live[c] += delta;
+  counters.peak[c] = std::max(counters.peak[c], counters.live[c]);
+}
+
+void MemoryStats::release(MemoryCategory category, int job, size_t bytes) {
+  auto c = static_cast<size_t>(category);
+  globalLive[c].fetch_sub(static_cast<int64_t>(bytes),
+                          std::memory_order_relaxed);
+
+  if (job < 0) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock{jobsMutex};
+  auto it = jobs.find(job);
+  if (it == jobs.end()) {
+    return;
+  }
+
+  it->second.live[c] -= static_cast<int64_t>(bytes);
+  // A job may run out of live bytes several times, it is queued once.
+  if (it->second.empty() &&
+      std::find(finishedJobs.begin(), finishedJobs.end(), job) ==
+          finishedJobs.end()) {
+    finishedJobs.push_back(job);
+    while (finishedJobs.size() > finishedJobsKept) {
+      auto old = jobs.find(finishedJobs.front());
+      if (old != jobs.end() && old->second.empty()) {
+        jobs.erase(old);
+      }
+      finishedJobs.pop_front();
+    }
+  }
+}
+
+static flutter::EncodableMap encodeCounters(const int64_t* live,
+                                            const int64_t* peak) {
+  auto map = flutter::EncodableMap{};
+  for (size_t c = 0; c < categories; c++) {
+    map[flutter::EncodableValue(categoryNames[c])] =
+        flutter::EncodableValue(flutter::EncodableMap{
+            {flutter::EncodableValue("live"), flutter::EncodableValue(live[c])},
+            {flutter::EncodableValue("peak"), flutter::EncodableValue(peak[c])},
+        });
+  }
+  return map;
+}
+
+flutter::EncodableMap MemoryStats::toMap() {
+  Counters global;
+  for (size_t c = 0; c < categories; c++) {
+    global.live[c] = globalLive[c].load(std::memory_order_relaxed);
+    global.peak[c] = globalPeak[c].load(std::memory_order_relaxed);
+  }
+
+  auto jobMap = flutter::EncodableMap{};
+  {
+    std::lock_guard<std::mutex> lock{jobsMutex};
+    for (auto& job : jobs) {
+      jobMap[flutter::EncodableValue(job.first)] =
+          flutter::EncodableValue(encodeCounters(job.second.live, job.second.peak));
+    }
+  }
+
+  return flutter::EncodableMap{
+      {flutter::EncodableValue("global"),
+       flutter::EncodableValue(encodeCounters(global.live, global.peak))},
+      {flutter::EncodableValue("jobs"), flutter::EncodableValue(jobMap)},
+  };
+}
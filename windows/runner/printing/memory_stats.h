@@ -0,0 +1,49 @@
+#ifndef PRINTING_PLUGIN_MEMORY_STATS_H_
+#define PRINTING_PLUGIN_MEMORY_STATS_H_
+
+#include <flutter/standard_method_codec.h>
+
+#include <cstddef>
+
+// Where the bytes held by the printing plugin sit. A buffer is counted in
+// one category at a time.
+enum class MemoryCategory {
+  document,  // copies of PDF documents kept by the plugin
+  bitmap,    // PDFium and GDI page bitmaps
+  output,    // pixel vectors waiting to be encoded into a reply
+  message,   // EncodableValue payloads received or being sent
+  count,
+};
+
+// Live and peak byte counters, globally and per job, fed by the raster and
+// print paths and reported by the memoryStats method.
+// All functions are thread-safe.
+class MemoryStats {
+ public:
+  static void allocate(MemoryCategory category, int job, size_t bytes);
+
+  static void release(MemoryCategory category, int job, size_t bytes);
+
+  static flutter::EncodableMap toMap();
+};
+
+// Counts bytes against a category and job for as long as it lives.
+class TrackedBytes {
+ public:
+  TrackedBytes(MemoryCategory category, int job, size_t bytes)
+      : category{category}, job{job}, bytes{bytes} {
+    MemoryStats::allocate(category, job, bytes);
+  }
+
+  ~TrackedBytes() { MemoryStats::release(category, job, bytes); }
+
+  TrackedBytes(const TrackedBytes&) = delete;
+  TrackedBytes& operator=(const TrackedBytes&) = delete;
+
+ private:
+  const MemoryCategory category;
+  const int job;
+  const size_t bytes;
+};
+
+#endif
@@ -0,0 +1,198 @@
+#include "method_dispatch.h"
+
+#include <algorithm>
+
+// Most pages printPdf renders ahead of the spooler. Each one is a bitmap at
+// the printer resolution, about 100 MB for a letter page at 600 dpi.
+const auto maxLookAhead = 2;
+
+const flutter::EncodableValue Keys::batchWindow{"batchWindow"};
+const flutter::EncodableValue Keys::columns{"columns"};
+const flutter::EncodableValue Keys::doc{"doc"};
+const flutter::EncodableValue Keys::docs{"docs"};
+const flutter::EncodableValue Keys::documentId{"documentId"};
+const flutter::EncodableValue Keys::downsample{"downsample"};
+const flutter::EncodableValue Keys::handle{"handle"};
+const flutter::EncodableValue Keys::height{"height"};
+const flutter::EncodableValue Keys::imposition{"imposition"};
+const flutter::EncodableValue Keys::isolated{"isolated"};
+const flutter::EncodableValue Keys::job{"job"};
+const flutter::EncodableValue Keys::limit{"limit"};
+const flutter::EncodableValue Keys::lookAhead{"lookAhead"};
+const flutter::EncodableValue Keys::maxWidth{"maxWidth"};
+const flutter::EncodableValue Keys::name{"name"};
+const flutter::EncodableValue Keys::outputMode{"outputMode"};
+const flutter::EncodableValue Keys::page{"page"};
+const flutter::EncodableValue Keys::pages{"pages"};
+const flutter::EncodableValue Keys::path{"path"};
+const flutter::EncodableValue Keys::printer{"printer"};
+const flutter::EncodableValue Keys::query{"query"};
+const flutter::EncodableValue Keys::rows{"rows"};
+const flutter::EncodableValue Keys::scale{"scale"};
+const flutter::EncodableValue Keys::sheetHeight{"sheetHeight"};
+const flutter::EncodableValue Keys::sheetWidth{"sheetWidth"};
+const flutter::EncodableValue Keys::texture{"texture"};
+const flutter::EncodableValue Keys::textLayer{"textLayer"};
+const flutter::EncodableValue Keys::usePrinterSettings{"usePrinterSettings"};
+const flutter::EncodableValue Keys::width{"width"};
+const flutter::EncodableValue Keys::workers{"workers"};
+
+static const std::vector<uint8_t> noBytes;
+
+Args::Args(const flutter::EncodableValue* arguments)
+    : map{arguments ? std::get_if<flutter::EncodableMap>(arguments)
+                    : nullptr} {}
+
+const flutter::EncodableValue* Args::find(
+    const flutter::EncodableValue& key) const {
+  if (!map) {
+    return nullptr;
+  }
+
+  auto it = map->find(key);
+  if (it == map->end() || it->second.IsNull()) {
+    return nullptr;
+  }
+
+  return &it->second;
+}
+
+std::string Args::string(const flutter::EncodableValue& key,
+                         const std::string& fallback) const {
+  auto value = get<std::string>(key);
+  return value ? *value : fallback;
+}
+
+int Args::integer(const flutter::EncodableValue& key, int fallback) const {
+  auto value = get<int32_t>(key);
+  return value ? *value : fallback;
+}
+
+int64_t Args::integer64(const flutter::EncodableValue& key,
+                        int64_t fallback) const {
+  auto value = get<int64_t>(key);
+  if (value) {
+    return *value;
+  }
+  return integer(key, static_cast<int>(fallback));
+}
+
+double Args::number(const flutter::EncodableValue& key, double fallback) const {
+  auto value = get<double>(key);
+  return value ? *value : fallback;
+}
+
+bool Args::boolean(const flutter::EncodableValue& key, bool fallback) const {
+  auto value = get<bool>(key);
+  return value ? *value : fallback;
+}
+
+const std::vector<uint8_t>& Args::bytes(
+    const flutter::EncodableValue& key) const {
+  auto value = get<std::vector<uint8_t>>(key);
+  return value ? *value : noBytes;
+}
+
+std::vector<int> Args::integers(const flutter::EncodableValue& key) const {
+  auto result = std::vector<int>{};
+  auto list = get<flutter::EncodableList>(key);
+  if (list) {
+    result.reserve(list->size());
+    for (auto& item : *list) {
+      auto value = std::get_if<int32_t>(&item);
+      if (value) {
+        result.push_back(*value);
+      }
+    }
+  }
+  return result;
+}
+
+ImpositionArgs::ImpositionArgs(const Args& args)
+    : mode{args.string(Keys::imposition)},
+      columns{args.integer(Keys::columns, 1)},
+      rows{args.integer(Keys::rows, 1)},
+      sheetWidth{args.number(Keys::sheetWidth)},
+      sheetHeight{args.number(Keys::sheetHeight)} {}
+
+PrintPdfArgs::PrintPdfArgs(const Args& args)
+    : name{args.string(Keys::name, "document")},
+      printer{args.string(Keys::printer)},
+      width{args.number(Keys::width)},
+      height{args.number(Keys::height)},
+      usePrinterSettings{args.boolean(Keys::usePrinterSettings)},
+      job{args.integer(Keys::job, -1)},
+      lookAhead{std::clamp(args.integer(Keys::lookAhead), 0, maxLookAhead)},
+      batchWindow{args.integer(Keys::batchWindow)},
+      documentId{args.string(Keys::documentId)},
+      outputMode{args.string(Keys::outputMode)},
+      downsample{args.boolean(Keys::downsample, true)},
+      imposition{args} {}
+
+SharePdfArgs::SharePdfArgs(const Args& args)
+    : doc{args.bytes(Keys::doc)},
+      name{args.string(Keys::name, "document.pdf")} {}
+
+RasterPdfArgs::RasterPdfArgs(const Args& args)
+    : doc{args.bytes(Keys::doc)},
+      pages{args.integers(Keys::pages)},
+      scale{args.number(Keys::scale, 1)},
+      job{args.integer(Keys::job, -1)},
+      textLayer{args.boolean(Keys::textLayer)},
+      imposition{args},
+      isolated{args.boolean(Keys::isolated)} {}
+
+RasterAtlasArgs::RasterAtlasArgs(const Args& args)
+    : doc{args.bytes(Keys::doc)},
+      pages{args.integers(Keys::pages)},
+      scale{args.number(Keys::scale, 1)},
+      maxWidth{args.integer(Keys::maxWidth, 4096)},
+      job{args.integer(Keys::job, -1)} {}
+
+RasterBatchArgs::RasterBatchArgs(const Args& args)
+    : docs{args.get<flutter::EncodableList>(Keys::docs)},
+      pages{args.integers(Keys::pages)},
+      scale{args.number(Keys::scale, 1)},
+      job{args.integer(Keys::job, -1)} {
+  if (pages.empty()) {
+    pages.push_back(0);
+  }
+}
+
+RasterPageArgs::RasterPageArgs(const Args& args)
+    : handle{args.integer(Keys::handle, -1)},
+      page{args.integer(Keys::page)},
+      scale{args.number(Keys::scale, 1)},
+      width{args.number(Keys::width)},
+      textLayer{args.boolean(Keys::textLayer)} {}
+
+RenderTextureArgs::RenderTextureArgs(const Args& args)
+    : texture{args.integer64(Keys::texture, -1)},
+      page{args.integer(Keys::page)},
+      scale{args.number(Keys::scale, 1)} {}
+
+IndexDocumentArgs::IndexDocumentArgs(const Args& args)
+    : doc{args.bytes(Keys::doc)},
+      documentId{args.string(Keys::documentId)},
+      path{args.string(Keys::path)} {}
+
+SearchTextArgs::SearchTextArgs(const Args& args)
+    : documentId{args.string(Keys::documentId)},
+      query{args.string(Keys::query)},
+      limit{args.integer(Keys::limit, 100)} {}
+
+void MethodDispatcher::add(const std::string& method, Handler handler) {
+  handlers[method] = std::move(handler);
+}
+
+void MethodDispatcher::dispatch(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    Result result) const {
+  auto it = handlers.find(call.method_name());
+  if (it == handlers.end()) {
+    result->NotImplemented();
+    return;
+  }
+
+  it->second(Args{call.arguments()}, std::move(result));
+}
@@ -0,0 +1,203 @@
+#ifndef PRINTING_PLUGIN_METHOD_DISPATCH_H_
+#define PRINTING_PLUGIN_METHOD_DISPATCH_H_
+
+#include <flutter/method_channel.h>
+#include <flutter/standard_method_codec.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Argument keys of the printing channel, built once instead of on every
+// lookup.
+struct Keys {
+  static const flutter::EncodableValue batchWindow;
+  static const flutter::EncodableValue columns;
+  static const flutter::EncodableValue doc;
+  static const flutter::EncodableValue docs;
+  static const flutter::EncodableValue documentId;
+  static const flutter::EncodableValue downsample;
+  static const flutter::EncodableValue handle;
+  static const flutter::EncodableValue height;
+  static const flutter::EncodableValue imposition;
+  static const flutter::EncodableValue isolated;
+  static const flutter::EncodableValue job;
+  static const flutter::EncodableValue limit;
+  static const flutter::EncodableValue lookAhead;
+  static const flutter::EncodableValue maxWidth;
+  static const flutter::EncodableValue name;
+  static const flutter::EncodableValue outputMode;
+  static const flutter::EncodableValue page;
+  static const flutter::EncodableValue pages;
+  static const flutter::EncodableValue path;
+  static const flutter::EncodableValue printer;
+  static const flutter::EncodableValue query;
+  static const flutter::EncodableValue rows;
+  static const flutter::EncodableValue scale;
+  static const flutter::EncodableValue sheetHeight;
+  static const flutter::EncodableValue sheetWidth;
+  static const flutter::EncodableValue texture;
+  static const flutter::EncodableValue textLayer;
+  static const flutter::EncodableValue usePrinterSettings;
+  static const flutter::EncodableValue width;
+  static const flutter::EncodableValue workers;
+};
+
+// Read-only view over the argument map of a method call.
+// Values are returned by reference into the incoming message, nothing is
+// copied unless a getter returns by value.
+class Args {
+ public:
+  explicit Args(const flutter::EncodableValue* arguments);
+
+  // Returns nullptr if the key is missing or null.
+  const flutter::EncodableValue* find(const flutter::EncodableValue& key) const;
+
+  template <typename T>
+  const T* get(const flutter::EncodableValue& key) const {
+    auto value = find(key);
+    return value ? std::get_if<T>(value) : nullptr;
+  }
+
+  std::string string(const flutter::EncodableValue& key,
+                     const std::string& fallback = {}) const;
+
+  int integer(const flutter::EncodableValue& key, int fallback = 0) const;
+
+  // Accepts both encodings of a Dart int.
+  int64_t integer64(const flutter::EncodableValue& key,
+                    int64_t fallback = 0) const;
+
+  double number(const flutter::EncodableValue& key, double fallback = 0) const;
+
+  bool boolean(const flutter::EncodableValue& key, bool fallback = false) const;
+
+  // Empty if missing.
+  const std::vector<uint8_t>& bytes(const flutter::EncodableValue& key) const;
+
+  std::vector<int> integers(const flutter::EncodableValue& key) const;
+
+ private:
+  const flutter::EncodableMap* map;
+};
+
+// How pages are placed on sheets, see Imposition.
+struct ImpositionArgs {
+  std::string mode;
+  int columns;
+  int rows;
+  // Sheet size in points for rasterPdf, printed sheets have the paper size.
+  double sheetWidth;
+  double sheetHeight;
+
+  explicit ImpositionArgs(const Args& args);
+};
+
+struct PrintPdfArgs {
+  std::string name;
+  std::string printer;
+  double width;
+  double height;
+  bool usePrinterSettings;
+  int job;
+  int lookAhead;
+  int batchWindow;
+  std::string documentId;
+  std::string outputMode;
+  bool downsample;
+  ImpositionArgs imposition;
+
+  explicit PrintPdfArgs(const Args& args);
+};
+
+struct SharePdfArgs {
+  const std::vector<uint8_t>& doc;
+  std::string name;
+
+  explicit SharePdfArgs(const Args& args);
+};
+
+struct RasterPdfArgs {
+  const std::vector<uint8_t>& doc;
+  std::vector<int> pages;
+  double scale;
+  int job;
+  bool textLayer;
+  ImpositionArgs imposition;
+  bool isolated;  // rendered by the worker processes
+
+  explicit RasterPdfArgs(const Args& args);
+};
+
+struct IndexDocumentArgs {
+  const std::vector<uint8_t>& doc;
+  std::string documentId;
+  std::string path;
+
+  explicit IndexDocumentArgs(const Args& args);
+};
+
+struct SearchTextArgs {
+  std::string documentId;
+  std::string query;
+  int limit;
+
+  explicit SearchTextArgs(const Args& args);
+};
+
+struct RasterAtlasArgs {
+  const std::vector<uint8_t>& doc;
+  std::vector<int> pages;
+  double scale;
+  int maxWidth;
+  int job;
+
+  explicit RasterAtlasArgs(const Args& args);
+};
+
+struct RasterBatchArgs {
+  // Every item is the bytes of a document or the path of a PDF file.
+  const flutter::EncodableList* docs;
+  std::vector<int> pages;
+  double scale;
+  int job;
+
+  explicit RasterBatchArgs(const Args& args);
+};
+
+struct RasterPageArgs {
+  int handle;
+  int page;
+  double scale;
+  double width;  // logical pixels, replaces scale if set
+  bool textLayer;
+
+  explicit RasterPageArgs(const Args& args);
+};
+
+struct RenderTextureArgs {
+  int64_t texture;
+  int page;
+  double scale;
+
+  explicit RenderTextureArgs(const Args& args);
+};
+
+// Maps the method names of the printing channel to their handlers.
+class MethodDispatcher {
+ public:
+  using Result = std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>>;
+  using Handler = std::function<void(const Args& args, Result result)>;
+
+  void add(const std::string& method, Handler handler);
+
+  void dispatch(const flutter::MethodCall<flutter::EncodableValue>& call,
+                Result result) const;
+
+ private:
+  std::unordered_map<std::string, Handler> handlers;
+};
+
+#endif
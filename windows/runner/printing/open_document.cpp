@@ -0,0 +1,90 @@
+#include "open_document.h"
+
+#include "text_layer.h"
+#include "trace.h"
+
+std::shared_ptr<OpenDocument> OpenDocument::open(Bytes bytes,
+                                                 std::string& error) {
+  PRINTING_TRACE_SCOPE("openDocument", -1, -1);
+  PdfiumLibrary library;
+  PdfiumLock lock{pdfiumMutex()};
+
+  auto doc = FPDF_LoadMemDocument64(bytes->data(), bytes->size(), nullptr);
+  if (!doc) {
+    error = FPDF_GetLastError() == FPDF_ERR_PASSWORD
+                ? "Cannot open a password protected PDF file"
+                : "Cannot open a malformed PDF file";
+    return nullptr;
+  }
+
+  return std::shared_ptr<OpenDocument>(new OpenDocument(std::move(bytes), doc));
+}
+
+OpenDocument::OpenDocument(Bytes bytes, FPDF_DOCUMENT doc)
+    : bytes{std::move(bytes)},
+      tracked{MemoryCategory::document, -1, this->bytes->size()},
+      doc{doc},
+      pages{FPDF_GetPageCount(doc)} {}
+
+OpenDocument::~OpenDocument() {
+  PdfiumLock lock{pdfiumMutex()};
+  FPDF_CloseDocument(doc);
+}
+
+DocumentProbe OpenDocument::probe() const {
+  PdfiumLock lock{pdfiumMutex()};
+  return DocumentProbe::read(doc);
+}
+
+bool OpenDocument::pageSize(int page, double& width, double& height) const {
+  PdfiumLock lock{pdfiumMutex()};
+  FS_SIZEF size;
+  if (!FPDF_GetPageSizeByIndexF(doc, page, &size)) {
+    return false;
+  }
+  width = size.width;
+  height = size.height;
+  return true;
+}
+
+bool OpenDocument::render(int page,
+                          double scale,
+                          Image& image,
+                          std::vector<uint8_t>* textLayer) const {
+  if (page < 0 || page >= pages) {
+    return false;
+  }
+
+  PRINTING_TRACE_SCOPE("renderPage", -1, page);
+  PdfiumLock lock{pdfiumMutex()};
+
+  auto pdfPage = FPDF_LoadPage(doc, page);
+  if (!pdfPage) {
+    return false;
+  }
+
+  image.width = static_cast<int>(FPDF_GetPageWidth(pdfPage) * scale);
+  image.height = static_cast<int>(FPDF_GetPageHeight(pdfPage) * scale);
+  if (image.width <= 0 || image.height <= 0) {
+    FPDF_ClosePage(pdfPage);
+    return false;
+  }
+
+  auto stride = image.width * 4;
+  image.pixels.resize(static_cast<size_t>(stride) * image.height);
+
+  // Rendered straight in RGBA order, no swizzle pass.
+  auto bitmap = FPDFBitmap_CreateEx(image.width, image.height, FPDFBitmap_BGRA,
+                                    image.pixels.data(), stride);
+  FPDFBitmap_FillRect(bitmap, 0, 0, image.width, image.height, 0xffffffff);
+  FPDF_RenderPageBitmap(bitmap, pdfPage, 0, 0, image.width, image.height, 0,
+                        FPDF_ANNOT | FPDF_LCD_TEXT | FPDF_REVERSE_BYTE_ORDER);
+  FPDFBitmap_Destroy(bitmap);
+
+  if (textLayer) {
+    *textLayer = extractTextLayer(pdfPage);
+  }
+
+  FPDF_ClosePage(pdfPage);
+  return true;
+}
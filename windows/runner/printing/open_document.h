@@ -0,0 +1,59 @@
+#ifndef PRINTING_PLUGIN_OPEN_DOCUMENT_H_
+#define PRINTING_PLUGIN_OPEN_DOCUMENT_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "document_probe.h"
+#include "memory_stats.h"
+#include "pdfium.h"
+#include "pdfview.h"
+
+// A document parsed once and kept open, so that its pages can be rendered
+// on demand without sending or parsing the bytes again.
+// All functions are thread-safe.
+class OpenDocument {
+ public:
+  using Bytes = std::shared_ptr<const std::vector<uint8_t>>;
+
+  struct Image {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> pixels;  // RGBA
+  };
+
+  // Returns nullptr and sets error if the document cannot be loaded.
+  static std::shared_ptr<OpenDocument> open(Bytes bytes, std::string& error);
+
+  virtual ~OpenDocument();
+
+  OpenDocument(const OpenDocument&) = delete;
+  OpenDocument& operator=(const OpenDocument&) = delete;
+
+  int pageCount() const { return pages; }
+
+  DocumentProbe probe() const;
+
+  // Size of page in PDF points, without loading it.
+  bool pageSize(int page, double& width, double& height) const;
+
+  // Renders page at scale, with its packed text layer if textLayer is not
+  // null. Returns false if the page cannot be rendered.
+  bool render(int page,
+              double scale,
+              Image& image,
+              std::vector<uint8_t>* textLayer = nullptr) const;
+
+ private:
+  OpenDocument(Bytes bytes, FPDF_DOCUMENT doc);
+
+  Bytes bytes;
+  TrackedBytes tracked;
+  PdfiumLibrary library;
+  FPDF_DOCUMENT doc;
+  int pages;
+};
+
+#endif
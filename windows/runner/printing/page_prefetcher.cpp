@@ -0,0 +1,265 @@
+#include "page_prefetcher.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include "memory_stats.h"
+#include "trace.h"
+
+// Pages rendered ahead cover this much reading time, within these bounds.
+static const double prefetchHorizon = 0.5;  // seconds
+static const int minPrefetch = 1;
+static const int maxPrefetch = 8;
+
+PagePrefetcher::PagePrefetcher(size_t maxBytes)
+    : maxBytes{maxBytes}, worker{[this] { run(); }} {}
+
+PagePrefetcher::~PagePrefetcher() {
+  {
+    std::lock_guard<std::mutex> lock{mutex};
+    stopping = true;
+    tasks.clear();
+  }
+  available.notify_all();
+  worker.join();
+
+  MemoryStats::release(MemoryCategory::bitmap, -1, totalBytes);
+}
+
+std::string PagePrefetcher::key(int handle, int page, double scale) {
+  std::stringstream ss;
+  ss << std::hexfloat << handle << '|' << page << '|' << scale;
+  return ss.str();
+}
+
+PagePrefetcher::Image PagePrefetcher::find(int handle, int page, double scale) {
+  std::lock_guard<std::mutex> lock{mutex};
+  auto it = index.find(key(handle, page, scale));
+  if (it == index.end()) {
+    missCount++;
+    return nullptr;
+  }
+
+  hitCount++;
+  auto& entry = *it->second;
+  if (entry.prefetched) {
+    // Counted once, on the first request of a speculative render.
+    prefetchHitCount++;
+    entry.prefetched = false;
+  }
+  lru.splice(lru.begin(), lru, it->second);
+  return entry.image;
+}
+
+void PagePrefetcher::store(int handle, int page, double scale, Image image) {
+  std::lock_guard<std::mutex> lock{mutex};
+  if (forgotten.count(handle)) {
+    // Rendered while the document was being closed.
+    return;
+  }
+  storeLocked(handle, page, scale, std::move(image), false);
+}
+
+PagePrefetcher::Image PagePrefetcher::findAtLeast(int handle,
+                                                  int page,
+                                                  double scale) {
+  std::lock_guard<std::mutex> lock{mutex};
+  const Entry* best = nullptr;
+  for (auto& entry : lru) {
+    if (entry.handle == handle && entry.page == page && entry.scale >= scale &&
+        (!best || entry.scale < best->scale)) {
+      best = &entry;
+    }
+  }
+  return best ? best->image : nullptr;
+}
+
+void PagePrefetcher::storeLocked(int handle,
+                                 int page,
+                                 double scale,
+                                 Image image,
+                                 bool prefetched) {
+  auto entryKey = key(handle, page, scale);
+  auto it = index.find(entryKey);
+  if (it != index.end()) {
+    totalBytes -= it->second->image->pixels.size();
+    MemoryStats::release(MemoryCategory::bitmap, -1,
+                         it->second->image->pixels.size());
+    lru.erase(it->second);
+    index.erase(it);
+  }
+
+  auto bytes = image->pixels.size();
+  if (bytes > maxBytes) {
+    return;
+  }
+
+  totalBytes += bytes;
+  MemoryStats::allocate(MemoryCategory::bitmap, -1, bytes);
+  lru.push_front(
+      Entry{entryKey, handle, page, scale, std::move(image), prefetched});
+  index[entryKey] = lru.begin();
+
+  while (totalBytes > maxBytes) {
+    auto& last = lru.back();
+    totalBytes -= last.image->pixels.size();
+    MemoryStats::release(MemoryCategory::bitmap, -1, last.image->pixels.size());
+    index.erase(last.key);
+    lru.pop_back();
+  }
+}
+
+void PagePrefetcher::access(int handle,
+                            std::shared_ptr<OpenDocument> document,
+                            int page,
+                            double scale) {
+  auto now = std::chrono::steady_clock::now();
+
+  {
+    std::lock_guard<std::mutex> lock{mutex};
+    auto& pattern = patterns[handle];
+
+    if (pattern.lastPage >= 0 && page != pattern.lastPage) {
+      auto direction = page > pattern.lastPage ? 1 : -1;
+      if (pattern.direction != 0 && direction != pattern.direction) {
+        // The reader turned around, the pages queued ahead are useless.
+        pattern.generation++;
+        auto before = tasks.size();
+        tasks.erase(std::remove_if(tasks.begin(), tasks.end(),
+                                   [handle](const Task& task) {
+                                     return task.handle == handle;
+                                   }),
+                    tasks.end());
+        cancelCount += before - tasks.size();
+        pattern.velocity = 0;
+      }
+      pattern.direction = direction;
+
+      auto seconds =
+          std::chrono::duration<double>(now - pattern.lastAccess).count();
+      if (seconds > 0) {
+        auto velocity = std::abs(page - pattern.lastPage) / seconds;
+        pattern.velocity = pattern.velocity * 0.7 + velocity * 0.3;
+      }
+    }
+
+    pattern.lastPage = page;
+    pattern.lastAccess = now;
+
+    if (pattern.direction == 0) {
+      // No direction yet, the next page is the best guess.
+      pattern.direction = 1;
+    }
+
+    auto ahead = std::clamp(
+        static_cast<int>(std::ceil(pattern.velocity * prefetchHorizon)),
+        minPrefetch, maxPrefetch);
+
+    for (auto i = 1; i <= ahead; i++) {
+      auto next = page + pattern.direction * i;
+      if (next < 0 || next >= document->pageCount()) {
+        break;
+      }
+      if (index.count(key(handle, next, scale))) {
+        continue;
+      }
+      tasks.push_back(Task{handle, document, next, scale, pattern.generation});
+    }
+  }
+
+  available.notify_one();
+}
+
+void PagePrefetcher::forget(int handle) {
+  std::lock_guard<std::mutex> lock{mutex};
+  forgotten.insert(handle);
+  patterns.erase(handle);
+  tasks.erase(std::remove_if(tasks.begin(), tasks.end(),
+                             [handle](const Task& task) {
+                               return task.handle == handle;
+                             }),
+              tasks.end());
+
+  for (auto it = lru.begin(); it != lru.end();) {
+    if (it->handle == handle) {
+      totalBytes -= it->image->pixels.size();
+      MemoryStats::release(MemoryCategory::bitmap, -1, it->image->pixels.size());
+      index.erase(it->key);
+      it = lru.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void PagePrefetcher::run() {
+  // Renders take the global PDFium lock, so this thread keeps a normal
+  // priority: an idle thread holding the lock would stall the reader behind
+  // any busy thread. It yields between pages instead.
+  for (;;) {
+    std::this_thread::yield();
+
+    Task task;
+    std::string taskKey;
+    {
+      std::unique_lock<std::mutex> lock{mutex};
+      available.wait(lock, [this] { return stopping || !tasks.empty(); });
+      if (stopping) {
+        return;
+      }
+
+      task = std::move(tasks.front());
+      tasks.pop_front();
+
+      taskKey = key(task.handle, task.page, task.scale);
+      auto pattern = patterns.find(task.handle);
+      if (pattern == patterns.end() ||
+          pattern->second.generation != task.generation ||
+          index.count(taskKey) || totalBytes >= maxBytes) {
+        continue;
+      }
+    }
+
+    PRINTING_TRACE_SCOPE("prefetchPage", task.handle, task.page);
+    auto image = std::make_shared<OpenDocument::Image>();
+    if (!task.document->render(task.page, task.scale, *image)) {
+      continue;
+    }
+
+    std::lock_guard<std::mutex> lock{mutex};
+    auto pattern = patterns.find(task.handle);
+    if (pattern == patterns.end() ||
+        pattern->second.generation != task.generation) {
+      cancelCount++;
+      continue;
+    }
+    prefetchCount++;
+    storeLocked(task.handle, task.page, task.scale, std::move(image), true);
+  }
+}
+
+flutter::EncodableMap PagePrefetcher::stats() {
+  std::lock_guard<std::mutex> lock{mutex};
+  auto hitRatio = prefetchCount
+                      ? static_cast<double>(prefetchHitCount) / prefetchCount
+                      : 0.0;
+  return flutter::EncodableMap{
+      {flutter::EncodableValue("hits"),
+       flutter::EncodableValue(static_cast<int64_t>(hitCount))},
+      {flutter::EncodableValue("misses"),
+       flutter::EncodableValue(static_cast<int64_t>(missCount))},
+      {flutter::EncodableValue("prefetched"),
+       flutter::EncodableValue(static_cast<int64_t>(prefetchCount))},
+      {flutter::EncodableValue("prefetchHits"),
+       flutter::EncodableValue(static_cast<int64_t>(prefetchHitCount))},
+      {flutter::EncodableValue("prefetchHitRatio"),
+       flutter::EncodableValue(hitRatio)},
+      {flutter::EncodableValue("cancelled"),
+       flutter::EncodableValue(static_cast<int64_t>(cancelCount))},
+      {flutter::EncodableValue("entries"),
+       flutter::EncodableValue(static_cast<int64_t>(index.size()))},
+      {flutter::EncodableValue("bytes"),
+       flutter::EncodableValue(static_cast<int64_t>(totalBytes))},
+  };
+}
@@ -0,0 +1,113 @@
+#ifndef PRINTING_PLUGIN_PAGE_PREFETCHER_H_
+#define PRINTING_PLUGIN_PAGE_PREFETCHER_H_
+
+#include <flutter/standard_method_codec.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "open_document.h"
+
+// Cache of rendered pages of open documents, filled by rasterPage and by
+// speculative renders of the pages a reader is about to reach.
+// The access pattern of each document (direction and pages per second)
+// decides how many pages ahead are rendered, on a background thread.
+// A change of direction cancels the pending renders. Least recently used
+// pages are evicted above maxBytes.
+// All functions are thread-safe.
+class PagePrefetcher {
+ public:
+  using Image = std::shared_ptr<const OpenDocument::Image>;
+
+  explicit PagePrefetcher(size_t maxBytes);
+
+  virtual ~PagePrefetcher();
+
+  PagePrefetcher(const PagePrefetcher&) = delete;
+  PagePrefetcher& operator=(const PagePrefetcher&) = delete;
+
+  // Returns nullptr on a miss.
+  Image find(int handle, int page, double scale);
+
+  // Returns the smallest cached render of page at scale or larger, which a
+  // downscale can turn into the requested one, or nullptr.
+  Image findAtLeast(int handle, int page, double scale);
+
+  void store(int handle, int page, double scale, Image image);
+
+  // Records a request for page and schedules the pages predicted next.
+  void access(int handle,
+              std::shared_ptr<OpenDocument> document,
+              int page,
+              double scale);
+
+  // Drops the pages and pending renders of a closed document. Pages of the
+  // handle stored later are discarded, handles are never reused.
+  void forget(int handle);
+
+  flutter::EncodableMap stats();
+
+ private:
+  struct Pattern {
+    int lastPage = -1;
+    int direction = 0;
+    double velocity = 0;  // pages per second
+    std::chrono::steady_clock::time_point lastAccess;
+    int generation = 0;
+  };
+
+  struct Task {
+    int handle;
+    std::shared_ptr<OpenDocument> document;
+    int page;
+    double scale;
+    int generation;
+  };
+
+  struct Entry {
+    std::string key;
+    int handle;
+    int page;
+    double scale;
+    Image image;
+    bool prefetched;
+  };
+
+  static std::string key(int handle, int page, double scale);
+
+  void storeLocked(int handle, int page, double scale, Image image,
+                   bool prefetched);
+
+  void run();
+
+  const size_t maxBytes;
+
+  std::mutex mutex;
+  std::condition_variable available;
+  std::deque<Task> tasks;
+  std::map<int, Pattern> patterns;
+  std::set<int> forgotten;
+  std::list<Entry> lru;  // most recent first
+  std::unordered_map<std::string, std::list<Entry>::iterator> index;
+  size_t totalBytes = 0;
+  bool stopping = false;
+
+  size_t hitCount = 0;
+  size_t missCount = 0;
+  size_t prefetchCount = 0;
+  size_t prefetchHitCount = 0;
+  size_t cancelCount = 0;
+
+  std::thread worker;
+};
+
+#endif
@@ -0,0 +1,90 @@
+#include "page_texture.h"
+
+#include "memory_stats.h"
+#include "trace.h"
+
+PageTexture::PageTexture(flutter::TextureRegistrar* registrar,
+                         std::shared_ptr<OpenDocument> document)
+    : registrar{registrar},
+      document{std::move(document)},
+      frames{std::make_shared<Frames>()} {
+  texture = std::make_shared<flutter::TextureVariant>(flutter::PixelBufferTexture(
+      [frames = frames](size_t width, size_t height) {
+        return frames->copy(width, height);
+      }));
+  textureId = registrar->RegisterTexture(texture.get());
+}
+
+void PageTexture::release() {
+  if (released.exchange(true)) {
+    return;
+  }
+
+  // The engine may be copying the last frame, the callback releases the
+  // frames and the texture once it no longer can.
+  registrar->UnregisterTexture(
+      textureId, [frames = frames, texture = texture] {});
+}
+
+bool PageTexture::render(int request,
+                         int page,
+                         double scale,
+                         int& width,
+                         int& height) {
+  std::lock_guard<std::mutex> render{renderMutex};
+  if (request != generation || released) {
+    return false;
+  }
+
+  PRINTING_TRACE_SCOPE("renderTexture", -1, page);
+  auto frame = std::make_shared<Frame>();
+  if (!document->render(page, scale, *frame)) {
+    return false;
+  }
+
+  MemoryStats::allocate(MemoryCategory::bitmap, -1, frame->pixels.size());
+  width = frame->width;
+  height = frame->height;
+
+  {
+    std::lock_guard<std::mutex> lock{frames->mutex};
+    if (frames->front && frames->front != frames->shown) {
+      MemoryStats::release(MemoryCategory::bitmap, -1,
+                           frames->front->pixels.size());
+    }
+    frames->front = std::move(frame);
+  }
+
+  if (released) {
+    return false;
+  }
+  registrar->MarkTextureFrameAvailable(textureId);
+  return true;
+}
+
+PageTexture::Frames::~Frames() {
+  if (front) {
+    MemoryStats::release(MemoryCategory::bitmap, -1, front->pixels.size());
+  }
+  if (shown && shown != front) {
+    MemoryStats::release(MemoryCategory::bitmap, -1, shown->pixels.size());
+  }
+}
+
+const FlutterDesktopPixelBuffer* PageTexture::Frames::copy(size_t width,
+                                                           size_t height) {
+  std::lock_guard<std::mutex> lock{mutex};
+  if (!front) {
+    return nullptr;
+  }
+
+  if (shown && shown != front) {
+    MemoryStats::release(MemoryCategory::bitmap, -1, shown->pixels.size());
+  }
+  shown = front;
+
+  pixelBuffer.buffer = shown->pixels.data();
+  pixelBuffer.width = shown->width;
+  pixelBuffer.height = shown->height;
+  return &pixelBuffer;
+}
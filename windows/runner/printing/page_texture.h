@@ -0,0 +1,70 @@
+#ifndef PRINTING_PLUGIN_PAGE_TEXTURE_H_
+#define PRINTING_PLUGIN_PAGE_TEXTURE_H_
+
+#include <flutter/texture_registrar.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "open_document.h"
+
+// A Flutter pixel-buffer texture showing one page of an open document at a
+// time. A zoom or scroll only renders the page again and swaps the new frame
+// in; no pixels cross the method channel.
+class PageTexture {
+ public:
+  PageTexture(flutter::TextureRegistrar* registrar,
+              std::shared_ptr<OpenDocument> document);
+
+  // Unregisters the texture. Must be called on the platform thread before
+  // the last reference is dropped, which may be on any thread. The frames
+  // stay alive until the engine has stopped copying them.
+  void release();
+
+  PageTexture(const PageTexture&) = delete;
+  PageTexture& operator=(const PageTexture&) = delete;
+
+  int64_t id() const { return textureId; }
+
+  // Starts a new render request and returns its number. A render whose
+  // request is no longer the latest one is skipped.
+  int request() { return ++generation; }
+
+  // Renders page at scale into a new frame and shows it. Runs on any
+  // thread. Returns false if the page cannot be rendered, the request
+  // was superseded or the texture was released.
+  bool render(int request, int page, double scale, int& width, int& height);
+
+ private:
+  using Frame = OpenDocument::Image;
+
+  // Shared with the engine's copy callback, which may run until the
+  // unregistration completes, after the PageTexture is gone.
+  struct Frames {
+    ~Frames();
+
+    const FlutterDesktopPixelBuffer* copy(size_t width, size_t height);
+
+    // Guards front, shown and pixelBuffer, shared with the raster thread.
+    std::mutex mutex;
+    std::shared_ptr<Frame> front;
+    // Frame last handed to the engine, kept alive until the next copy.
+    std::shared_ptr<Frame> shown;
+    FlutterDesktopPixelBuffer pixelBuffer{};
+  };
+
+  flutter::TextureRegistrar* registrar;
+  std::shared_ptr<OpenDocument> document;
+  std::shared_ptr<Frames> frames;
+  std::shared_ptr<flutter::TextureVariant> texture;
+  int64_t textureId = -1;
+  std::atomic<int> generation{0};
+  std::atomic<bool> released{false};
+
+  // Held while rendering, one render at a time per texture.
+  std::mutex renderMutex;
+};
+
+#endif
@@ -0,0 +1,31 @@
+#include "pdfium.h"
+
+#include "pdfview.h"
+
+static int libraryUsers = 0;
+
+std::recursive_mutex& pdfiumMutex() {
+  static std::recursive_mutex mutex;
+  return mutex;
+}
+
+PdfiumLibrary::PdfiumLibrary() {
+  PdfiumLock lock{pdfiumMutex()};
+  if (libraryUsers++ > 0) {
+    return;
+  }
+
+  FPDF_LIBRARY_CONFIG config;
+  config.version = 2;
+  config.m_pUserFontPaths = nullptr;
+  config.m_pIsolate = nullptr;
+  config.m_v8EmbedderSlot = 0;
+  FPDF_InitLibraryWithConfig(&config);
+}
+
+PdfiumLibrary::~PdfiumLibrary() {
+  PdfiumLock lock{pdfiumMutex()};
+  if (--libraryUsers == 0) {
+    FPDF_DestroyLibrary();
+  }
+}
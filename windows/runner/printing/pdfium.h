@@ -0,0 +1,25 @@
+#ifndef PRINTING_PLUGIN_PDFIUM_H_
+#define PRINTING_PLUGIN_PDFIUM_H_
+
+#include <mutex>
+
+// PDFium keeps process-wide state and is not thread-safe.
+// Every PDFium call must be made while holding a PdfiumLock, and the library
+// stays initialized for as long as at least one PdfiumLibrary is alive, so a
+// document can outlive the lock that loaded it.
+
+std::recursive_mutex& pdfiumMutex();
+
+using PdfiumLock = std::lock_guard<std::recursive_mutex>;
+
+class PdfiumLibrary {
+ public:
+  PdfiumLibrary();
+
+  ~PdfiumLibrary();
+
+  PdfiumLibrary(const PdfiumLibrary&) = delete;
+  PdfiumLibrary& operator=(const PdfiumLibrary&) = delete;
+};
+
+#endif
@@ -1,19 +1,48 @@
 #include "print_job.h"
 
-//#include "printing.h"
-
-//#include <objbase.h>
-//#include <shlobj.h>
-//#include <shlwapi.h>
-//#include <tchar.h>
-//#include <codecvt>
-//#include <fstream>
-//#include <iterator>
-//#include <numeric>
-//#include <runner/printing/pdfview.h>
+#include "printing.h"
+
+#include <objbase.h>
+#include <shlobj.h>
+#include <shlwapi.h>
+#include <tchar.h>
+#include <algorithm>
+#include <chrono>
+#include <codecvt>
+#include <fstream>
+#include <iterator>
+#include <numeric>
+#include <thread>
+
+#include "bounded_queue.h"
+#include "device_bitmap.h"
+#include "flight_recorder.h"
+#include "memory_stats.h"
+#include "pdfium.h"
+#include "pdfview.h"
+#include "print_session.h"
+#include "printer_cache.h"
+#include "text_layer.h"
+#include "trace.h"
 
     const auto pdfDpi = 72;
 
+    // Chunk size of the RAW spool writes.
+    const DWORD rawChunk = 64 * 1024;
+
+    // Shortest time between two onPageSpooled events, pages spooled faster
+    // are sent together.
+    const auto progressInterval = std::chrono::milliseconds(250);
+
+    // Tallest thumbnail atlas, the largest texture most GPUs accept. Pages
+    // that do not fit are left out of it.
+    const auto maxAtlasHeight = 16384;
+
+    static double millisecondsBetween(std::chrono::steady_clock::time_point from,
+        std::chrono::steady_clock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+
     std::string toUtf8(std::wstring wstr) {
         int cbMultiByte = WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), -1, nullptr,
             0, nullptr, nullptr);
@@ -53,108 +82,165 @@
         return wstr;
     }
 
-    PrintJob(int index)
-        : index{ index } {}
+    PrintJob::PrintJob(Printing* printing, int index)
+        : printing{ printing }, index{ index } {}
 
-    //Printing printing;
+    PrintJob::~PrintJob() {
+        if (session) {
+            // The layout never came back, give the batch back.
+            session->release(batchWindow);
+        }
+    }
 
-    bool printPdf(const std::string& name,
+    bool PrintJob::printPdf(const std::string& name,
         std::string printer,
         double width,
         double height,
         bool usePrinterSettings) {
         documentName = name;
 
-        auto dm = static_cast<DEVMODE*>(GlobalAlloc(0, sizeof(DEVMODE)));
+        if (printer.empty()) {
+            return pickAndLayout(width, height, usePrinterSettings);
+        }
 
-        if (usePrinterSettings) {
-            dm = nullptr;  // to use default driver config
+        printerName = printer;
+        auto key = PrintSession::key(printer, width, height, usePrinterSettings);
+
+        auto cached = PrinterCache::find(key);
+        if (!cached) {
+            auto dm = createDevMode(width, height, usePrinterSettings);
+            hDC = CreateDC(TEXT("WINSPOOL"), fromUtf8(printer).c_str(), nullptr, dm);
+            if (!hDC) {
+                GlobalFree(dm);
+                return false;
+            }
+            cached = PrinterCache::store(key, printer, dm,
+                PageMetrics::measure(hDC));
+            GlobalFree(dm);
         }
-        else {
-            ZeroMemory(dm, sizeof(DEVMODE));
-            dm->dmSize = sizeof(DEVMODE);
-            dm->dmFields =
-                DM_ORIENTATION | DM_PAPERSIZE | DM_PAPERLENGTH | DM_PAPERWIDTH;
-            dm->dmPaperSize = 0;
-            if (width > height) {
-                dm->dmOrientation = DMORIENT_LANDSCAPE;
-                dm->dmPaperWidth = static_cast<short>(round(height * 254 / 72));
-                dm->dmPaperLength = static_cast<short>(round(width * 254 / 72));
+
+        // A known printer goes straight to the layout, the DC is only
+        // created once the document comes back.
+        devMode = cached->devMode;
+        metrics = cached->metrics;
+
+        if (batchWindow > 0 && outputMode != OutputMode::pdf) {
+            session = PrintSession::find(key);
+            if (session) {
+                // Append to the open batch, its DC is already configured.
+                if (hDC) {
+                    DeleteDC(hDC);
+                }
             }
             else {
-                dm->dmOrientation = DMORIENT_PORTRAIT;
-                dm->dmPaperWidth = static_cast<short>(round(width * 254 / 72));
-                dm->dmPaperLength = static_cast<short>(round(height * 254 / 72));
+                if (!hDC && !createDC()) {
+                    return false;
+                }
+                // The session owns the DC from now on.
+                session = PrintSession::open(key, hDC);
             }
+            session->acquire();
+            hDC = session->dc();
         }
 
-        if (printer.empty()) {
-            PRINTDLG pd;
-
-            // Initialize PRINTDLG
-            ZeroMemory(&pd, sizeof(pd));
-            pd.lStructSize = sizeof(pd);
-
-            // Initialize PRINTDLG
-            pd.hwndOwner = nullptr;
-            pd.hDevMode = dm;
-            pd.hDevNames = nullptr;  // Don't forget to free or store hDevNames.
-            pd.hDC = nullptr;
-            pd.Flags = PD_USEDEVMODECOPIES | PD_RETURNDC | PD_PRINTSETUP |
-                PD_NOSELECTION | PD_NOPAGENUMS;
-            pd.nCopies = 1;
-            pd.nFromPage = 0xFFFF;
-            pd.nToPage = 0xFFFF;
-            pd.nMinPage = 1;
-            pd.nMaxPage = 0xFFFF;
-
-            auto r = PrintDlg(&pd);
-
-            if (r != 1) {
-                printing.onCompleted(this, false, "");
-                DeleteDC(hDC);
-                GlobalFree(hDevNames);
-                ClosePrinter(hDevMode);
-                return true;
-            }
+        sendLayout();
+        return true;
+    }
 
-            hDC = pd.hDC;
-            hDevMode = pd.hDevMode;
-            hDevNames = pd.hDevNames;
+    DEVMODE* PrintJob::createDevMode(double width,
+        double height,
+        bool usePrinterSettings) {
+        if (usePrinterSettings) {
+            return nullptr;  // to use default driver config
+        }
 
+        auto dm = static_cast<DEVMODE*>(GlobalAlloc(0, sizeof(DEVMODE)));
+        ZeroMemory(dm, sizeof(DEVMODE));
+        dm->dmSize = sizeof(DEVMODE);
+        dm->dmFields =
+            DM_ORIENTATION | DM_PAPERSIZE | DM_PAPERLENGTH | DM_PAPERWIDTH;
+        dm->dmPaperSize = 0;
+        if (width > height) {
+            dm->dmOrientation = DMORIENT_LANDSCAPE;
+            dm->dmPaperWidth = static_cast<short>(round(height * 254 / 72));
+            dm->dmPaperLength = static_cast<short>(round(width * 254 / 72));
         }
         else {
-            hDC = CreateDC(TEXT("WINSPOOL"), fromUtf8(printer).c_str(), nullptr, dm);
-            if (!hDC) {
-                return false;
-            }
-            hDevMode = dm;
-            hDevNames = nullptr;
-        }
-
-        auto dpiX = static_cast<double>(GetDeviceCaps(hDC, LOGPIXELSX)) / pdfDpi;
-        auto dpiY = static_cast<double>(GetDeviceCaps(hDC, LOGPIXELSY)) / pdfDpi;
-        auto pageWidth =
-            static_cast<double>(GetDeviceCaps(hDC, PHYSICALWIDTH)) / dpiX;
-        auto pageHeight =
-            static_cast<double>(GetDeviceCaps(hDC, PHYSICALHEIGHT)) / dpiY;
-        auto printableWidth = static_cast<double>(GetDeviceCaps(hDC, HORZRES)) / dpiX;
-        auto printableHeight =
-            static_cast<double>(GetDeviceCaps(hDC, VERTRES)) / dpiY;
-        auto marginLeft =
-            static_cast<double>(GetDeviceCaps(hDC, PHYSICALOFFSETX)) / dpiX;
-        auto marginTop =
-            static_cast<double>(GetDeviceCaps(hDC, PHYSICALOFFSETY)) / dpiY;
-        auto marginRight = pageWidth - printableWidth - marginLeft;
-        auto marginBottom = pageHeight - printableHeight - marginTop;
-
-       // 
-       // printing.onLayout(this, pageWidth, pageHeight, marginLeft, marginTop,
-        //    marginRight, marginBottom);
+            dm->dmOrientation = DMORIENT_PORTRAIT;
+            dm->dmPaperWidth = static_cast<short>(round(width * 254 / 72));
+            dm->dmPaperLength = static_cast<short>(round(height * 254 / 72));
+        }
+        return dm;
+    }
+
+    bool PrintJob::createDC() {
+        auto dm = devMode.empty()
+            ? nullptr
+            : reinterpret_cast<const DEVMODE*>(devMode.data());
+        hDC = CreateDC(TEXT("WINSPOOL"), fromUtf8(printerName).c_str(), nullptr, dm);
+        return hDC != nullptr;
+    }
+
+    bool PrintJob::pickAndLayout(double width,
+        double height,
+        bool usePrinterSettings) {
+        PRINTDLG pd;
+
+        // Initialize PRINTDLG
+        ZeroMemory(&pd, sizeof(pd));
+        pd.lStructSize = sizeof(pd);
+
+        // Initialize PRINTDLG
+        pd.hwndOwner = nullptr;
+        pd.hDevMode = createDevMode(width, height, usePrinterSettings);
+        pd.hDevNames = nullptr;  // Don't forget to free or store hDevNames.
+        pd.hDC = nullptr;
+        pd.Flags = PD_USEDEVMODECOPIES | PD_RETURNDC | PD_PRINTSETUP |
+            PD_NOSELECTION | PD_NOPAGENUMS;
+        pd.nCopies = 1;
+        pd.nFromPage = 0xFFFF;
+        pd.nToPage = 0xFFFF;
+        pd.nMinPage = 1;
+        pd.nMaxPage = 0xFFFF;
+
+        auto r = PrintDlg(&pd);
+
+        if (r != 1) {
+            printing->onCompleted(this, false, "");
+            DeleteDC(pd.hDC);
+            GlobalFree(pd.hDevNames);
+            GlobalFree(pd.hDevMode);
+            return true;
+        }
+
+        hDC = pd.hDC;
+        hDevMode = pd.hDevMode;
+        hDevNames = pd.hDevNames;
+
+        metrics = PageMetrics::measure(hDC);
+        sendLayout();
         return true;
     }
 
-    /*
+    OutputMode PrintJob::outputModeNamed(const std::string& name) {
+        if (name == "postScript2") {
+            return OutputMode::postScript2;
+        }
+        if (name == "postScript3") {
+            return OutputMode::postScript3;
+        }
+        if (name == "pdf") {
+            return OutputMode::pdf;
+        }
+        return OutputMode::gdi;
+    }
+
+    void PrintJob::sendLayout() {
+        printing->onLayout(this, metrics.pageWidth, metrics.pageHeight,
+            metrics.marginLeft, metrics.marginTop, metrics.marginRight,
+            metrics.marginBottom);
+    }
+
     std::vector<Printer> PrintJob::listPrinters() {
         LPTSTR defaultPrinter;
         DWORD size = 0;
@@ -201,9 +287,39 @@
         return printers;
     }
 
-    void PrintJob::writeJob(std::vector<uint8_t> data) {
-        auto dpiX = static_cast<double>(GetDeviceCaps(hDC, LOGPIXELSX)) / pdfDpi;
-        auto dpiY = static_cast<double>(GetDeviceCaps(hDC, LOGPIXELSY)) / pdfDpi;
+    void PrintJob::writeJob(const std::vector<uint8_t>& data) {
+        PRINTING_TRACE_SCOPE("writeJob", index, -1);
+        FlightRecorder::record(FlightEvent::start, index);
+
+        auto start = std::chrono::steady_clock::now();
+        progressStart = start;
+        progressSent = start;
+        stats.documentBytes = static_cast<int64_t>(data.size());
+        auto completed = [this, start](bool written, const std::string& error) {
+            flushProgress();
+            stats.seconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+            printing->onSpooled(this, written, stats);
+            printing->onCompleted(this, written, written ? "" : error);
+        };
+
+        if (outputMode == OutputMode::pdf) {
+            auto written = writeRaw(data);
+
+            if (hDC) {
+                DeleteDC(hDC);
+            }
+            GlobalFree(hDevNames);
+            GlobalFree(hDevMode);
+
+            completed(written, "Cannot send the document to the printer");
+            return;
+        }
+
+        if (!hDC && !createDC()) {
+            printing->onCompleted(this, false, "Cannot open the printer");
+            return;
+        }
 
         DOCINFO docInfo;
 
@@ -212,62 +328,426 @@
 
         auto docName = fromUtf8(documentName);
         docInfo.lpszDocName = docName.c_str();
+        docInfo.lpszOutput = outputFile.empty() ? nullptr : outputFile.c_str();
 
-        auto r = StartDoc(hDC, &docInfo);
+        auto jobId = StartDoc(hDC, &docInfo);
+        stats.printerJob = jobId > 0 ? jobId : 0;
 
-        FPDF_LIBRARY_CONFIG config;
-        config.version = 2;
-        config.m_pUserFontPaths = nullptr;
-        config.m_pIsolate = nullptr;
-        config.m_v8EmbedderSlot = 0;
-        FPDF_InitLibraryWithConfig(&config);
+        auto written = jobId > 0 && writeDocument(data);
 
-        auto doc = FPDF_LoadMemDocument64(data.data(), data.size(), nullptr);
-        if (!doc) {
-            FPDF_DestroyLibrary();
-            return;
+        if (written) {
+            // Measured while the job is still spooling, it may be gone once
+            // printed.
+            stats.spoolBytes = spooledBytes(jobId);
+            written = EndDoc(hDC) > 0;
+        }
+        else if (jobId > 0) {
+            AbortDoc(hDC);
+        }
+
+        if (session) {
+            // The DC stays open for the next job of the batch.
+            session->release(batchWindow);
+            session = nullptr;
+            hDC = nullptr;
+        }
+        else {
+            DeleteDC(hDC);
+        }
+        GlobalFree(hDevNames);
+        GlobalFree(hDevMode);
+
+        completed(written, "Cannot print a malformed PDF file");
+    }
+
+    bool PrintJob::writeDocument(const std::vector<uint8_t>& data) {
+        if (imposition.enabled()) {
+            return writeSheets(data);
+        }
+
+        // PostScript needs the page content, not a bitmap of it.
+        auto vector = outputMode == OutputMode::postScript2 ||
+            outputMode == OutputMode::postScript3;
+        return lookAhead > 0 && !vector ? writePagesPipelined(data)
+            : writePages(data);
+    }
+
+    bool PrintJob::writePages(const std::vector<uint8_t>& data) {
+        auto dpiX = metrics.dpiX;
+        auto dpiY = metrics.dpiY;
+
+        // The lock is only held around PDFium calls, StartPage and EndPage
+        // may wait on the spooler while other threads render previews.
+        PdfiumLibrary library;
+        FPDF_DOCUMENT doc;
+        int pages;
+        {
+            PRINTING_TRACE_SCOPE("loadDocument", index, -1);
+            PdfiumLock lock{ pdfiumMutex() };
+            doc = FPDF_LoadMemDocument64(data.data(), data.size(), nullptr);
+            if (!doc) {
+                return false;
+            }
+            pages = FPDF_GetPageCount(doc);
         }
 
-        auto pages = FPDF_GetPageCount(doc);
-        auto marginLeft = GetDeviceCaps(hDC, PHYSICALOFFSETX);
-        auto marginTop = GetDeviceCaps(hDC, PHYSICALOFFSETY);
+        auto marginLeft = metrics.offsetX;
+        auto marginTop = metrics.offsetY;
+        auto printMode = printModeFor(hDC, outputMode);
 
         for (auto pageNum = 0; pageNum < pages; pageNum++) {
+            PRINTING_TRACE_SCOPE("spoolPage", index, pageNum);
+            auto pageStart = std::chrono::steady_clock::now();
             StartPage(hDC);
 
-            auto page = FPDF_LoadPage(doc, pageNum);
-            if (!page) {
+            auto loaded = false;
+            {
+                PdfiumLock lock{ pdfiumMutex() };
+                FPDF_PAGE page;
+                {
+                    PRINTING_TRACE_SCOPE("loadPage", index, pageNum);
+                    page = FPDF_LoadPage(doc, pageNum);
+                }
+                if (page) {
+                    loaded = true;
+                    auto pdfWidth = FPDF_GetPageWidth(page);
+                    auto pdfHeight = FPDF_GetPageHeight(page);
+
+                    int bWidth = static_cast<int>(pdfWidth * dpiX);
+                    int bHeight = static_cast<int>(pdfHeight * dpiY);
+
+                    PRINTING_TRACE_SCOPE("renderPage", index, pageNum);
+                    if (!downsample || !writeDownsampled(page, bWidth, bHeight)) {
+                        // The print mode is global to PDFium, set and reset
+                        // under the same lock.
+                        FPDF_SetPrintMode(printMode);
+                        FPDF_RenderPage(hDC, page, -marginLeft, -marginTop, bWidth,
+                            bHeight, 0, FPDF_ANNOT | FPDF_PRINTING);
+                        FPDF_SetPrintMode(printModeEmf);
+                    }
+                    FPDF_ClosePage(page);
+                }
+            }
+            if (!loaded) {
                 EndPage(hDC);
                 continue;
             }
 
-            auto pdfWidth = FPDF_GetPageWidth(page);
-            auto pdfHeight = FPDF_GetPageHeight(page);
+            FlightRecorder::record(FlightEvent::pageRendered, index, pageNum);
+            auto rendered = std::chrono::steady_clock::now();
+            EndPage(hDC);
+            stats.pages++;
+            FlightRecorder::record(FlightEvent::pageSent, index, pageNum);
+            pageSpooled(pageNum, millisecondsBetween(pageStart, rendered),
+                millisecondsBetween(rendered, std::chrono::steady_clock::now()));
+        }
 
-            int bWidth = static_cast<int>(pdfWidth * dpiX);
-            int bHeight = static_cast<int>(pdfHeight * dpiY);
+        PdfiumLock lock{ pdfiumMutex() };
+        FPDF_CloseDocument(doc);
+        return true;
+    }
 
-            FPDF_RenderPage(hDC, page, -marginLeft, -marginTop, bWidth, bHeight, 0,
-                FPDF_ANNOT | FPDF_PRINTING);
-            FPDF_ClosePage(page);
-            r = EndPage(hDC);
+    bool PrintJob::writeSheets(const std::vector<uint8_t>& data) {
+        PdfiumLibrary library;
+        FPDF_DOCUMENT doc;
+        std::vector<Sheet> sheets;
+        {
+            PRINTING_TRACE_SCOPE("loadDocument", index, -1);
+            PdfiumLock lock{ pdfiumMutex() };
+            doc = FPDF_LoadMemDocument64(data.data(), data.size(), nullptr);
+            if (!doc) {
+                return false;
+            }
+
+            std::vector<int> pages(FPDF_GetPageCount(doc));
+            std::iota(std::begin(pages), std::end(pages), 0);
+            sheets = imposition.layout(doc, pages, metrics.pageWidth,
+                metrics.pageHeight);
+        }
+
+        auto printMode = printModeFor(hDC, outputMode);
+
+        for (size_t sheetNum = 0; sheetNum < sheets.size(); sheetNum++) {
+            auto n = static_cast<int>(sheetNum);
+            PRINTING_TRACE_SCOPE("spoolSheet", index, n);
+            auto sheetStart = std::chrono::steady_clock::now();
+            StartPage(hDC);
+            {
+                PdfiumLock lock{ pdfiumMutex() };
+                FPDF_SetPrintMode(printMode);
+                Imposition::draw(doc, sheets[sheetNum], hDC, metrics.dpiX,
+                    metrics.dpiY, metrics.offsetX, metrics.offsetY,
+                    FPDF_ANNOT | FPDF_PRINTING);
+                FPDF_SetPrintMode(printModeEmf);
+            }
+            FlightRecorder::record(FlightEvent::pageRendered, index, n);
+            auto rendered = std::chrono::steady_clock::now();
+            EndPage(hDC);
+            stats.pages++;
+            FlightRecorder::record(FlightEvent::pageSent, index, n);
+            pageSpooled(n, millisecondsBetween(sheetStart, rendered),
+                millisecondsBetween(rendered, std::chrono::steady_clock::now()));
         }
 
+        PdfiumLock lock{ pdfiumMutex() };
         FPDF_CloseDocument(doc);
-        FPDF_DestroyLibrary();
+        return true;
+    }
 
-        EndDoc(hDC);
+    void PrintJob::pageSpooled(int page, double renderMs, double spoolMs) {
+        progress.pages.push_back(page);
+        progress.renderMs.push_back(renderMs);
+        progress.spoolMs.push_back(spoolMs);
+        progress.spooled++;
 
-        DeleteDC(hDC);
-        GlobalFree(hDevNames);
-        ClosePrinter(hDevMode);
+        if (std::chrono::steady_clock::now() - progressSent >= progressInterval) {
+            flushProgress();
+        }
+    }
+
+    void PrintJob::flushProgress() {
+        if (progress.pages.empty()) {
+            return;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        auto seconds = std::chrono::duration<double>(now - progressStart).count();
+        progress.pagesPerSecond = seconds > 0 ? progress.spooled / seconds : 0;
+        progress.spoolBytes = spooledBytes(stats.printerJob);
+        printing->onPageSpooled(this, progress);
+
+        progress.pages.clear();
+        progress.renderMs.clear();
+        progress.spoolMs.clear();
+        progressSent = now;
+    }
+
+    bool PrintJob::writeRaw(const std::vector<uint8_t>& data) {
+        PRINTING_TRACE_SCOPE("writeRaw", index, -1);
+        auto name = deviceName();
+
+        HANDLE printer;
+        if (!OpenPrinter(name.data(), &printer, nullptr)) {
+            return false;
+        }
+
+        auto docName = fromUtf8(documentName);
+        auto output = outputFile;
+        TCHAR dataType[] = TEXT("RAW");
+        DOC_INFO_1 docInfo;
+        docInfo.pDocName = docName.data();
+        docInfo.pOutputFile = output.empty() ? nullptr : output.data();
+        docInfo.pDatatype = dataType;
+
+        auto jobId = StartDocPrinter(printer, 1, reinterpret_cast<LPBYTE>(&docInfo));
+        if (!jobId) {
+            ClosePrinter(printer);
+            return false;
+        }
+        stats.printerJob = static_cast<int>(jobId);
+
+        auto written = StartPagePrinter(printer) != 0;
+        for (size_t offset = 0; written && offset < data.size();) {
+            auto chunk = static_cast<DWORD>(
+                std::min<size_t>(rawChunk, data.size() - offset));
+            DWORD count = 0;
+            written = WritePrinter(printer, data.data() + offset, chunk, &count) &&
+                count == chunk;
+            offset += chunk;
+        }
+
+        if (written) {
+            EndPagePrinter(printer);
+            EndDocPrinter(printer);
+            stats.spoolBytes = static_cast<int64_t>(data.size());
+            FlightRecorder::record(FlightEvent::pageSent, index);
+        }
+        else {
+            AbortPrinter(printer);
+        }
+
+        ClosePrinter(printer);
+        return written;
+    }
+
+    // Whether the images alone outweigh a bitmap of the whole page, vector
+    // content spools smaller than its bitmap.
+    static bool imageHeavy(int64_t imageBytes, size_t rasterBytes) {
+        return imageBytes > 2 * static_cast<int64_t>(rasterBytes);
+    }
+
+    bool PrintJob::writeDownsampled(FPDF_PAGE page, int width, int height) {
+        auto imageBytes = DeviceBitmap::imageBytes(page);
+        auto rasterBytes = DeviceBitmap::size(width, height,
+            metrics.monochrome ? 1 : 24);
+        if (!imageHeavy(imageBytes, rasterBytes)) {
+            return false;
+        }
+
+        DeviceBitmap bitmap;
+        TrackedBytes tracked{ MemoryCategory::bitmap, index, rasterBytes };
+        if (!bitmap.render(page, metrics.dpiX, metrics.dpiY,
+            metrics.monochrome)) {
+            return false;
+        }
+
+        bitmap.draw(hDC, -metrics.offsetX, -metrics.offsetY);
+        stats.rasterPages++;
+        stats.imageBytes += imageBytes;
+        stats.rasterBytes += static_cast<int64_t>(bitmap.bits.size());
+        return true;
+    }
+
+    // A page rendered at device resolution, waiting to be spooled.
+    struct RenderedPage {
+        DeviceBitmap bitmap;
+        double renderMs = 0;
+        std::unique_ptr<TrackedBytes> tracked;
+    };
+
+    bool PrintJob::writePagesPipelined(const std::vector<uint8_t>& data) {
+        auto dpiX = metrics.dpiX;
+        auto dpiY = metrics.dpiY;
+        auto marginLeft = metrics.offsetX;
+        auto marginTop = metrics.offsetY;
+
+        // The worker owns every PDFium call. This thread only talks to GDI and
+        // the spooler, so page N is spooled while page N+1 is being rendered.
+        BoundedQueue<std::unique_ptr<RenderedPage>> queue{
+            static_cast<size_t>(lookAhead) };
+        auto loaded = true;
+        auto spooled = true;
+
+        std::thread worker([&] {
+            PdfiumLibrary library;
+            FPDF_DOCUMENT doc;
+            {
+                PRINTING_TRACE_SCOPE("loadDocument", index, -1);
+                PdfiumLock lock{ pdfiumMutex() };
+                doc = FPDF_LoadMemDocument64(data.data(), data.size(), nullptr);
+            }
+
+            if (!doc) {
+                loaded = false;
+                queue.close();
+                return;
+            }
+
+            int pages;
+            {
+                PdfiumLock lock{ pdfiumMutex() };
+                pages = FPDF_GetPageCount(doc);
+            }
+
+            for (auto pageNum = 0; pageNum < pages; pageNum++) {
+                auto rendered = std::make_unique<RenderedPage>();
+                auto renderStart = std::chrono::steady_clock::now();
+                {
+                    PRINTING_TRACE_SCOPE("renderPage", index, pageNum);
+                    PdfiumLock lock{ pdfiumMutex() };
+                    auto page = FPDF_LoadPage(doc, pageNum);
+                    if (page) {
+                        // Packed to 24 or 1 bits per pixel, a quarter or less
+                        // of the render to spool.
+                        auto& bitmap = rendered->bitmap;
+                        if (bitmap.render(page, dpiX, dpiY, metrics.monochrome)) {
+                            rendered->tracked = std::make_unique<TrackedBytes>(
+                                MemoryCategory::bitmap, index, bitmap.bits.size());
+                            // Every page goes out as a bitmap here, only the
+                            // ones writeDownsampled would have replaced count
+                            // as downsampled.
+                            auto imageBytes = DeviceBitmap::imageBytes(page);
+                            if (imageHeavy(imageBytes, bitmap.bits.size())) {
+                                stats.rasterPages++;
+                                stats.imageBytes += imageBytes;
+                                stats.rasterBytes +=
+                                    static_cast<int64_t>(bitmap.bits.size());
+                            }
+                        }
+                        FPDF_ClosePage(page);
+                    }
+                }
+                FlightRecorder::record(FlightEvent::pageRendered, index, pageNum);
+                rendered->renderMs = millisecondsBetween(renderStart,
+                    std::chrono::steady_clock::now());
+
+                // Blocks while the look-ahead window is full, fails once the
+                // spooler side gave up.
+                if (!queue.push(std::move(rendered))) {
+                    break;
+                }
+            }
+
+            PdfiumLock lock{ pdfiumMutex() };
+            FPDF_CloseDocument(doc);
+            queue.close();
+        });
+
+        std::unique_ptr<RenderedPage> rendered;
+        for (auto pageNum = 0; queue.pop(rendered); pageNum++) {
+            PRINTING_TRACE_SCOPE("spoolPage", index, pageNum);
+            auto spoolStart = std::chrono::steady_clock::now();
+            StartPage(hDC);
+
+            if (!rendered->bitmap.bits.empty()) {
+                rendered->bitmap.draw(hDC, -marginLeft, -marginTop);
+            }
+            stats.pages++;
+
+            if (EndPage(hDC) <= 0) {
+                // The spooler failed, stop the worker and let the caller
+                // abort the document.
+                FlightRecorder::record(FlightEvent::error, index, pageNum);
+                spooled = false;
+                queue.close();
+                break;
+            }
+
+            FlightRecorder::record(FlightEvent::pageSent, index, pageNum);
+            pageSpooled(pageNum, rendered->renderMs,
+                millisecondsBetween(spoolStart,
+                    std::chrono::steady_clock::now()));
+        }
+
+        worker.join();
+        return loaded && spooled;
+    }
+
+    std::wstring PrintJob::deviceName() {
+        if (!printerName.empty() || !hDevNames) {
+            return fromUtf8(printerName);
+        }
+
+        // Chosen in the print dialog.
+        auto names = static_cast<DEVNAMES*>(GlobalLock(hDevNames));
+        std::wstring name = reinterpret_cast<LPCTSTR>(names) + names->wDeviceOffset;
+        GlobalUnlock(hDevNames);
+        return name;
+    }
+
+    int64_t PrintJob::spooledBytes(int jobId) {
+        auto name = deviceName();
+        HANDLE printer;
+        if (jobId <= 0 || !OpenPrinter(name.data(), &printer, nullptr)) {
+            return -1;
+        }
+
+        int64_t size = -1;
+        DWORD needed = 0;
+        GetJob(printer, jobId, 2, nullptr, 0, &needed);
+        std::vector<BYTE> buffer(needed);
+        if (needed > 0 &&
+            GetJob(printer, jobId, 2, buffer.data(), needed, &needed)) {
+            size = reinterpret_cast<JOB_INFO_2*>(buffer.data())->Size;
+        }
 
-        printing.onCompleted(this, true, "");
+        ClosePrinter(printer);
+        return size;
     }
 
     void PrintJob::cancelJob(const std::string& error) {}
 
-    bool PrintJob::sharePdf(std::vector<uint8_t> data, const std::string& name) {
+    bool PrintJob::sharePdf(const std::vector<uint8_t>& data, const std::string& name) {
         TCHAR lpTempPathBuffer[MAX_PATH];
 
         auto ret = GetTempPath(MAX_PATH, lpTempPathBuffer);
@@ -300,20 +780,23 @@
 
     void PrintJob::pickPrinter(void* result) {}
 
-    void PrintJob::rasterPdf(std::vector<uint8_t> data,
+    void PrintJob::rasterPdf(const std::vector<uint8_t>& data,
         std::vector<int> pages,
-        double scale) {
-        FPDF_LIBRARY_CONFIG config;
-        config.version = 2;
-        config.m_pUserFontPaths = nullptr;
-        config.m_pIsolate = nullptr;
-        config.m_v8EmbedderSlot = 0;
-        FPDF_InitLibraryWithConfig(&config);
-
-        auto doc = FPDF_LoadMemDocument64(data.data(), data.size(), nullptr);
+        double scale,
+        bool textLayer) {
+        PRINTING_TRACE_SCOPE("rasterPdf", index, -1);
+        TrackedBytes payload{ MemoryCategory::message, index, data.size() };
+        FlightRecorder::record(FlightEvent::start, index);
+        PdfiumLibrary library;
+        PdfiumLock lock{ pdfiumMutex() };
+
+        FPDF_DOCUMENT doc;
+        {
+            PRINTING_TRACE_SCOPE("loadDocument", index, -1);
+            doc = FPDF_LoadMemDocument64(data.data(), data.size(), nullptr);
+        }
         if (!doc) {
-            FPDF_DestroyLibrary();
-            printing.onPageRasterEnd(this, "Cannot raster a malformed PDF file");
+            printing->onPageRasterEnd(this, "Cannot raster a malformed PDF file");
             return;
         }
 
@@ -325,12 +808,26 @@
             std::iota(std::begin(pages), std::end(pages), 0);
         }
 
+        if (imposition.enabled()) {
+            pages.erase(std::remove_if(pages.begin(), pages.end(),
+                [pageCount](int n) { return n < 0 || n >= pageCount; }),
+                pages.end());
+            rasterSheets(doc, pages, scale);
+            FPDF_CloseDocument(doc);
+            printing->onPageRasterEnd(this, "");
+            return;
+        }
+
         for (auto n : pages) {
             if (n >= pageCount) {
                 continue;
             }
 
-            auto page = FPDF_LoadPage(doc, n);
+            FPDF_PAGE page;
+            {
+                PRINTING_TRACE_SCOPE("loadPage", index, n);
+                page = FPDF_LoadPage(doc, n);
+            }
             if (!page) {
                 continue;
             }
@@ -342,38 +839,214 @@
             auto bHeight = static_cast<int>(height * scale);
 
             auto bitmap = FPDFBitmap_Create(bWidth, bHeight, 0);
-            FPDFBitmap_FillRect(bitmap, 0, 0, bWidth, bHeight, 0xffffffff);
+            {
+                PRINTING_TRACE_SCOPE("renderPage", index, n);
+                FPDFBitmap_FillRect(bitmap, 0, 0, bWidth, bHeight, 0xffffffff);
 
-            FPDF_RenderPageBitmap(bitmap, page, 0, 0, bWidth, bHeight, 0,
-                FPDF_ANNOT | FPDF_LCD_TEXT);
+                FPDF_RenderPageBitmap(bitmap, page, 0, 0, bWidth, bHeight, 0,
+                    FPDF_ANNOT | FPDF_LCD_TEXT);
+            }
+            FlightRecorder::record(FlightEvent::pageRendered, index, n);
+
+            std::vector<uint8_t> text;
+            if (textLayer) {
+                PRINTING_TRACE_SCOPE("textLayer", index, n);
+                text = extractTextLayer(page);
+            }
 
             uint8_t* p = static_cast<uint8_t*>(FPDFBitmap_GetBuffer(bitmap));
             auto stride = FPDFBitmap_GetStride(bitmap);
             size_t l = static_cast<size_t>(bHeight * stride);
+            MemoryStats::allocate(MemoryCategory::bitmap, index, l);
+
+            {
+                PRINTING_TRACE_SCOPE("swizzle", index, n);
+                // BGRA to RGBA conversion
+                for (auto y = 0; y < bHeight; y++) {
+                    auto offset = y * stride;
+                    for (auto x = 0; x < bWidth; x++) {
+                        auto t = p[offset];
+                        p[offset] = p[offset + 2];
+                        p[offset + 2] = t;
+                        offset += 4;
+                    }
+                }
+            }
+
+            std::vector<uint8_t> image;
+            {
+                PRINTING_TRACE_SCOPE("copyPixels", index, n);
+                image.assign(p, p + l);
+            }
+
+            // Counted as a message from here on, the pixels are moved into it.
+            printing->onPageRasterized(std::move(image), std::move(text),
+                bWidth, bHeight, this);
+            FlightRecorder::record(FlightEvent::pageSent, index, n);
+
+            FPDFBitmap_Destroy(bitmap);
+            MemoryStats::release(MemoryCategory::bitmap, index, l);
+            FPDF_ClosePage(page);
+        }
+
+        FPDF_CloseDocument(doc);
+
+        printing->onPageRasterEnd(this, "");
+    }
+
+    void PrintJob::rasterSheets(FPDF_DOCUMENT doc,
+        const std::vector<int>& pages,
+        double scale) {
+        auto width = sheetWidth;
+        auto height = sheetHeight;
+        FS_SIZEF first;
+        if ((width <= 0 || height <= 0) && !pages.empty() &&
+            FPDF_GetPageSizeByIndexF(doc, pages[0], &first)) {
+            // Booklet sheets hold two pages side by side.
+            auto booklet = imposition.mode() == Imposition::Mode::booklet;
+            width = first.width * (booklet ? 2 : 1);
+            height = first.height;
+        }
+
+        auto sheets = imposition.layout(doc, pages, width, height);
+        auto bWidth = static_cast<int>(width * scale);
+        auto bHeight = static_cast<int>(height * scale);
+        if (bWidth <= 0 || bHeight <= 0) {
+            return;
+        }
+
+        for (size_t sheetNum = 0; sheetNum < sheets.size(); sheetNum++) {
+            auto n = static_cast<int>(sheetNum);
+            std::vector<uint8_t> image(static_cast<size_t>(bWidth) * 4 * bHeight);
+            TrackedBytes tracked{ MemoryCategory::bitmap, index, image.size() };
+            {
+                PRINTING_TRACE_SCOPE("renderSheet", index, n);
+                auto bitmap = FPDFBitmap_CreateEx(bWidth, bHeight,
+                    FPDFBitmap_BGRA, image.data(), bWidth * 4);
+                Imposition::render(doc, sheets[sheetNum], bitmap, scale, scale,
+                    FPDF_ANNOT | FPDF_LCD_TEXT);
+                FPDFBitmap_Destroy(bitmap);
+            }
+            FlightRecorder::record(FlightEvent::pageRendered, index, n);
 
             // BGRA to RGBA conversion
-            for (auto y = 0; y < bHeight; y++) {
-                auto offset = y * stride;
-                for (auto x = 0; x < bWidth; x++) {
-                    auto t = p[offset];
-                    p[offset] = p[offset + 2];
-                    p[offset + 2] = t;
-                    offset += 4;
-                }
+            for (size_t offset = 0; offset < image.size(); offset += 4) {
+                std::swap(image[offset], image[offset + 2]);
             }
 
-            printing.onPageRasterized(std::vector<uint8_t>{p, p + l}, bWidth, bHeight,
+            printing->onPageRasterized(std::move(image), {}, bWidth, bHeight,
                 this);
+            FlightRecorder::record(FlightEvent::pageSent, index, n);
+        }
+    }
+
+    bool PrintJob::rasterAtlas(const std::vector<uint8_t>& data,
+        std::vector<int> pages,
+        double scale,
+        int maxWidth,
+        RasterAtlas& atlas) {
+        PRINTING_TRACE_SCOPE("rasterAtlas", index, -1);
+        TrackedBytes payload{ MemoryCategory::message, index, data.size() };
+        FlightRecorder::record(FlightEvent::start, index);
+        PdfiumLibrary library;
+        PdfiumLock lock{ pdfiumMutex() };
+
+        FPDF_DOCUMENT doc;
+        {
+            PRINTING_TRACE_SCOPE("loadDocument", index, -1);
+            doc = FPDF_LoadMemDocument64(data.data(), data.size(), nullptr);
+        }
+        if (!doc) {
+            return false;
+        }
+
+        auto pageCount = FPDF_GetPageCount(doc);
+
+        if (pages.size() == 0) {
+            // Use all pages
+            pages.resize(pageCount);
+            std::iota(std::begin(pages), std::end(pages), 0);
+        }
+
+        // Shelf packing from the page sizes alone, so that every page renders
+        // in place at its final position without another copy.
+        atlas.rects.clear();
+        auto x = 0, y = 0, shelfHeight = 0;
+        for (auto n : pages) {
+            FS_SIZEF size;
+            if (n < 0 || n >= pageCount ||
+                !FPDF_GetPageSizeByIndexF(doc, n, &size)) {
+                continue;
+            }
+
+            // Pages wider than the atlas are scaled down as a whole, not
+            // squeezed.
+            auto pageScale = std::min<double>(scale, maxWidth / size.width);
+            auto w = std::min(static_cast<int>(size.width * pageScale), maxWidth);
+            auto h = static_cast<int>(size.height * pageScale);
+            if (w <= 0 || h <= 0) {
+                continue;
+            }
+
+            if (x + w > maxWidth) {
+                x = 0;
+                y += shelfHeight;
+                shelfHeight = 0;
+            }
+            if (y + h > maxAtlasHeight) {
+                break;
+            }
+
+            atlas.rects.insert(atlas.rects.end(), { n, x, y, w, h });
+            atlas.width = std::max(atlas.width, x + w);
+            shelfHeight = std::max(shelfHeight, h);
+            x += w;
+        }
+        atlas.height = y + shelfHeight;
+
+        auto stride = atlas.width * 4;
+        atlas.pixels.assign(static_cast<size_t>(stride) * atlas.height, 0);
+        TrackedBytes bitmap{ MemoryCategory::bitmap, index, atlas.pixels.size() };
+
+        for (size_t i = 0; i < atlas.rects.size(); i += 5) {
+            auto n = atlas.rects[i];
+            auto rx = atlas.rects[i + 1];
+            auto ry = atlas.rects[i + 2];
+            auto rw = atlas.rects[i + 3];
+            auto rh = atlas.rects[i + 4];
+
+            auto page = FPDF_LoadPage(doc, n);
+            if (!page) {
+                continue;
+            }
+
+            {
+                PRINTING_TRACE_SCOPE("renderPage", index, n);
+                auto target = FPDFBitmap_CreateEx(rw, rh, FPDFBitmap_BGRA,
+                    atlas.pixels.data() + static_cast<size_t>(ry) * stride + rx * 4,
+                    stride);
+                FPDFBitmap_FillRect(target, 0, 0, rw, rh, 0xffffffff);
+                FPDF_RenderPageBitmap(target, page, 0, 0, rw, rh, 0,
+                    FPDF_ANNOT | FPDF_LCD_TEXT);
+                FPDFBitmap_Destroy(target);
+            }
+            FlightRecorder::record(FlightEvent::pageRendered, index, n);
 
-            FPDFBitmap_Destroy(bitmap);
             FPDF_ClosePage(page);
         }
 
         FPDF_CloseDocument(doc);
 
-        FPDF_DestroyLibrary();
+        {
+            PRINTING_TRACE_SCOPE("swizzle", index, -1);
+            // BGRA to RGBA conversion
+            auto p = atlas.pixels.data();
+            for (size_t offset = 0; offset < atlas.pixels.size(); offset += 4) {
+                std::swap(p[offset], p[offset + 2]);
+            }
+        }
 
-        printing.onPageRasterEnd(this, "");
+        return true;
     }
 
     std::map<std::string, bool> PrintJob::printingInfo() {
@@ -383,5 +1056,4 @@
             { "canRaster", true },
         };
     }
-//}
-*/
\ No newline at end of file
+//}
\ No newline at end of file
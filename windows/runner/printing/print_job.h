@@ -1,16 +1,25 @@
 #ifndef PRINTING_PLUGIN_PRINT_JOB_H_
 #define PRINTING_PLUGIN_PRINT_JOB_H_
 
-//#include <flutter/standard_method_codec.h>
-//#include <windows.h>
+#include <flutter/standard_method_codec.h>
+#include <windows.h>
 
-//#include <map>
-//#include <memory>
-//#include <sstream>
-//#include <vector>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include "imposition.h"
+#include "pdfview.h"
+#include "print_mode.h"
+#include "printer_cache.h"
 
 //namespace printingPdf {
 
+    class Printing;
+    class PrintSession;
+
     struct Printer {
         const std::string name;
         const std::string url;
@@ -36,20 +45,167 @@
             available(available) {}
     };
 
+    // Thumbnails packed into one RGBA bitmap.
+    struct RasterAtlas {
+        int width = 0;
+        int height = 0;
+        std::vector<uint8_t> pixels;
+        // page, x, y, width, height for each page, in the order requested
+        std::vector<int32_t> rects;
+    };
+
+    // What writeJob sent to the printer.
+    struct SpoolStats {
+        int64_t documentBytes = 0;
+        int printerJob = 0;  // spooler job id, 0 if unknown
+        int pages = 0;
+        // Image-heavy pages rendered at the printer resolution instead, the
+        // decoded size of their images and of the bitmaps that replaced them.
+        int rasterPages = 0;
+        int64_t imageBytes = 0;
+        int64_t rasterBytes = 0;
+        int64_t spoolBytes = -1;  // size of the spool job, -1 if unknown
+        double seconds = 0;
+    };
+
+    // Pages spooled since the last onPageSpooled event, in the order sent.
+    struct SpoolProgress {
+        std::vector<int32_t> pages;
+        std::vector<double> renderMs;
+        std::vector<double> spoolMs;
+        int spooled = 0;  // pages spooled since the job started
+        int64_t spoolBytes = -1;  // size of the spool job, -1 if unknown
+        double pagesPerSecond = 0;
+    };
+
     class PrintJob {
     private:
+        Printing* printing;
         int index;
         HGLOBAL hDevMode = nullptr;
         HGLOBAL hDevNames = nullptr;
         HDC hDC = nullptr;
         std::string documentName;
+        std::string docId;
+        std::string printerName;
+        std::vector<uint8_t> devMode;
+        PageMetrics metrics;
+        int lookAhead = 0;
+        int batchWindow = 0;
+        OutputMode outputMode = OutputMode::gdi;
+        bool downsample = true;
+        std::wstring outputFile;
+        Imposition imposition;
+        double sheetWidth = 0;
+        double sheetHeight = 0;
+        SpoolStats stats;
+        SpoolProgress progress;
+        std::chrono::steady_clock::time_point progressStart;
+        std::chrono::steady_clock::time_point progressSent;
+        PrintSession* session = nullptr;
+
+        // Returns nullptr to use the driver defaults.
+        static DEVMODE* createDevMode(double width,
+            double height,
+            bool usePrinterSettings);
+
+        // Creates hDC for printerName from the cached devMode.
+        bool createDC();
+
+        // Lets the user choose a printer, then sends its layout.
+        bool pickAndLayout(double width, double height, bool usePrinterSettings);
+
+        // Sends the page metrics to Dart through Printing::onLayout.
+        void sendLayout();
+
+        bool writeDocument(const std::vector<uint8_t>& data);
+
+        // Renders each page straight onto the printer DC, one after the other.
+        bool writePages(const std::vector<uint8_t>& data);
+
+        // Draws the imposed sheets on the printer DC, pages stay vector.
+        bool writeSheets(const std::vector<uint8_t>& data);
+
+        // Draws page as a bitmap at the printer resolution if its images
+        // spool larger. Returns false to render it normally.
+        bool writeDownsampled(FPDF_PAGE page, int width, int height);
+
+        // Records a page handed to the spooler. Pages are reported in
+        // batches through onPageSpooled, at most every progressInterval.
+        void pageSpooled(int page, double renderMs, double spoolMs);
+
+        // Reports the pages not sent yet.
+        void flushProgress();
+
+        // Spools data as is, without a DC.
+        bool writeRaw(const std::vector<uint8_t>& data);
+
+        // printerName, or the printer chosen in the print dialog.
+        std::wstring deviceName();
+
+        // Size of the spool job jobId so far, -1 if unknown.
+        int64_t spooledBytes(int jobId);
+
+        // Renders up to lookAhead pages ahead into bitmaps on a worker thread
+        // while the current page is being spooled.
+        bool writePagesPipelined(const std::vector<uint8_t>& data);
+
+        // Sends the imposed sheets of pages through onPageRasterized.
+        void rasterSheets(FPDF_DOCUMENT doc,
+            const std::vector<int>& pages,
+            double scale);
 
     public:
-        PrintJob(int index);
+        PrintJob(Printing* printing, int index);
+
+        ~PrintJob();
 
         int id() { return index; }
 
-        std::vector<Printer> listPrinters();
+        const std::string& name() { return documentName; }
+
+        // Identifies the document across print jobs for the layout cache,
+        // empty if Dart did not provide one.
+        const std::string& documentId() { return docId; }
+
+        void setDocumentId(const std::string& id) { docId = id; }
+
+        // Number of pages pre-rendered ahead of the spooler by writeJob.
+        // 0 disables the pipeline and renders each page directly to the DC.
+        void setLookAhead(int pages) { lookAhead = pages; }
+
+        // Keeps the printer document open for windowMs after this job, so
+        // that following jobs to the same printer join the same spool job.
+        // 0 opens and closes a document for this job alone.
+        void setBatchWindow(int windowMs) { batchWindow = windowMs; }
+
+        // Must be set before printPdf. The pdf mode never joins a batch.
+        void setOutputMode(OutputMode mode) { outputMode = mode; }
+
+        // Renders image-heavy pages at the printer resolution when that
+        // spools less than the images themselves. On by default.
+        void setDownsample(bool enabled) { downsample = enabled; }
+
+        // Writes what would be spooled to path instead of printing it, as
+        // spool_benchmark does. Empty, the default, prints.
+        void setOutputFile(const std::wstring& path) { outputFile = path; }
+
+        // Places several pages on each printed or rasterized sheet, or a page
+        // across several sheets. Printed sheets have the paper size,
+        // rasterized ones are width x height points, or fit the first page
+        // if 0.
+        void setImposition(const Imposition& layout,
+            double width = 0,
+            double height = 0) {
+            imposition = layout;
+            sheetWidth = width;
+            sheetHeight = height;
+        }
+
+        // "gdi", "postScript2", "postScript3" or "pdf", gdi if unknown.
+        static OutputMode outputModeNamed(const std::string& name);
+
+        static std::vector<Printer> listPrinters();
 
         bool printPdf(const std::string& name,
             std::string printer,
@@ -57,20 +213,29 @@
             double height,
             bool usePrinterSettings);
 
-        void writeJob(std::vector<uint8_t> data);
+        void writeJob(const std::vector<uint8_t>& data);
 
         void cancelJob(const std::string& error);
 
-        bool sharePdf(std::vector<uint8_t> data, const std::string& name);
+        bool sharePdf(const std::vector<uint8_t>& data, const std::string& name);
 
         void pickPrinter(void* result);
 
-        void rasterPdf(std::vector<uint8_t> data,
+        void rasterPdf(const std::vector<uint8_t>& data,
             std::vector<int> pages,
-            double scale);
+            double scale,
+            bool textLayer);
+
+        // Renders the pages straight into one atlas no wider than maxWidth.
+        // Returns false if the document cannot be loaded.
+        bool rasterAtlas(const std::vector<uint8_t>& data,
+            std::vector<int> pages,
+            double scale,
+            int maxWidth,
+            RasterAtlas& atlas);
 
-        std::map<std::string, bool> printingInfo();
+        static std::map<std::string, bool> printingInfo();
     };
 //}
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,25 @@
+#include "print_mode.h"
+
+static bool supportsEscape(HDC hDC, int escape) {
+  return ExtEscape(hDC, QUERYESCSUPPORT, sizeof(escape),
+                   reinterpret_cast<LPCSTR>(&escape), 0, nullptr) > 0;
+}
+
+int printModeFor(HDC hDC, OutputMode mode) {
+  if (mode != OutputMode::postScript2 && mode != OutputMode::postScript3) {
+    return printModeEmf;
+  }
+
+  if (!supportsEscape(hDC, POSTSCRIPT_PASSTHROUGH)) {
+    // Not a PostScript driver.
+    return printModeEmf;
+  }
+
+  auto passthrough = supportsEscape(hDC, PASSTHROUGH);
+  if (mode == OutputMode::postScript2) {
+    return passthrough ? printModePostScript2Passthrough
+                       : printModePostScript2;
+  }
+  return passthrough ? printModePostScript3Type42Passthrough
+                     : printModePostScript3Type42;
+}
@@ -0,0 +1,32 @@
+#ifndef PRINTING_PLUGIN_PRINT_MODE_H_
+#define PRINTING_PLUGIN_PRINT_MODE_H_
+
+#include <windows.h>
+
+// FPDF_SetPrintMode values, not defined by this pdfview.h.
+const int printModeEmf = 0;
+const int printModePostScript2 = 2;
+const int printModePostScript2Passthrough = 4;
+const int printModePostScript3Type42 = 7;
+const int printModePostScript3Type42Passthrough = 8;
+
+// How writeJob hands the document to the printer.
+enum class OutputMode {
+  // PDFium draws every page on the printer DC, spooled as EMF.
+  gdi,
+  // PDFium converts the pages to PostScript for a PostScript driver, vector
+  // graphics and fonts included. Falls back to gdi if the driver does not
+  // take PostScript.
+  postScript2,
+  postScript3,
+  // The PDF bytes are spooled untouched as a RAW job, for printers that read
+  // PDF themselves.
+  pdf,
+};
+
+// Picks the PDFium print mode of mode for the driver behind hDC. PostScript
+// goes through the PASSTHROUGH escape when the driver has it, as GDI
+// comments in the EMF otherwise.
+int printModeFor(HDC hDC, OutputMode mode);
+
+#endif
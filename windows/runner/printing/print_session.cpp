@@ -0,0 +1,88 @@
+#include "print_session.h"
+
+#include <sstream>
+
+std::map<std::string, std::unique_ptr<PrintSession>> PrintSession::sessions;
+
+PrintSession* PrintSession::find(const std::string& key) {
+  auto it = sessions.find(key);
+  return it != sessions.end() ? it->second.get() : nullptr;
+}
+
+PrintSession* PrintSession::open(const std::string& key, HDC hDC) {
+  auto session = std::unique_ptr<PrintSession>(new PrintSession{key, hDC});
+  auto ptr = session.get();
+  sessions[key] = std::move(session);
+  return ptr;
+}
+
+std::string PrintSession::key(const std::string& printer,
+                              double width,
+                              double height,
+                              bool usePrinterSettings) {
+  std::stringstream ss;
+  ss << printer << '|';
+  if (usePrinterSettings) {
+    ss << "default";
+  } else {
+    ss << width << 'x' << height;
+  }
+  return ss.str();
+}
+
+PrintSession::PrintSession(const std::string& key, HDC hDC)
+    : sessionKey{key}, hDC{hDC} {}
+
+PrintSession::~PrintSession() {
+  if (timer) {
+    KillTimer(nullptr, timer);
+  }
+
+  DeleteDC(hDC);
+}
+
+void PrintSession::acquire() {
+  users++;
+  if (timer) {
+    KillTimer(nullptr, timer);
+    timer = 0;
+  }
+}
+
+void PrintSession::release(int windowMs) {
+  if (--users > 0) {
+    return;
+  }
+
+  if (windowMs <= 0) {
+    close();
+    return;
+  }
+
+  // Thread timers fire on the platform thread message loop, the same thread
+  // every print job runs on.
+  timer = SetTimer(nullptr, 0, static_cast<UINT>(windowMs), onTimer);
+  if (!timer) {
+    close();
+  }
+}
+
+void CALLBACK PrintSession::onTimer(HWND hwnd,
+                                    UINT message,
+                                    UINT_PTR timerId,
+                                    DWORD time) {
+  for (auto& it : sessions) {
+    if (it.second->timer == timerId) {
+      it.second->close();
+      return;
+    }
+  }
+
+  KillTimer(nullptr, timerId);
+}
+
+void PrintSession::close() {
+  // Destroys this session.
+  auto key = sessionKey;
+  sessions.erase(key);
+}
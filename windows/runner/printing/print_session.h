@@ -0,0 +1,57 @@
+#ifndef PRINTING_PLUGIN_PRINT_SESSION_H_
+#define PRINTING_PLUGIN_PRINT_SESSION_H_
+
+#include <windows.h>
+
+#include <map>
+#include <memory>
+#include <string>
+
+// A printer DC kept open across several print jobs.
+// Jobs sent to the same printer with the same page settings within the batch
+// window share one DC, so the driver setup is paid once per burst instead of
+// per job. Each job still runs its own StartDoc/EndDoc under its own name,
+// and reports its completion once its document is ended.
+class PrintSession {
+ public:
+  // Returns the open session for this printer configuration, or nullptr.
+  static PrintSession* find(const std::string& key);
+
+  // Takes ownership of the DC of a freshly configured printer.
+  static PrintSession* open(const std::string& key, HDC hDC);
+
+  static std::string key(const std::string& printer,
+                         double width,
+                         double height,
+                         bool usePrinterSettings);
+
+  ~PrintSession();
+
+  HDC dc() { return hDC; }
+
+  // A job starts using the session; it stays open until released.
+  void acquire();
+
+  // A job is done with the session. Once no job uses it, the DC is deleted
+  // after windowMs unless another job acquires it meanwhile.
+  void release(int windowMs);
+
+ private:
+  PrintSession(const std::string& key, HDC hDC);
+
+  static void CALLBACK onTimer(HWND hwnd,
+                               UINT message,
+                               UINT_PTR timerId,
+                               DWORD time);
+
+  void close();
+
+  const std::string sessionKey;
+  HDC hDC;
+  int users = 0;
+  UINT_PTR timer = 0;
+
+  static std::map<std::string, std::unique_ptr<PrintSession>> sessions;
+};
+
+#endif
@@ -0,0 +1,61 @@
+#include "printer_cache.h"
+
+static const auto pdfDpi = 72;
+
+std::map<std::string, PrinterCache::Entry> PrinterCache::entries;
+
+PageMetrics PageMetrics::measure(HDC hDC) {
+  PageMetrics m;
+  m.dpiX = static_cast<double>(GetDeviceCaps(hDC, LOGPIXELSX)) / pdfDpi;
+  m.dpiY = static_cast<double>(GetDeviceCaps(hDC, LOGPIXELSY)) / pdfDpi;
+  m.pageWidth = static_cast<double>(GetDeviceCaps(hDC, PHYSICALWIDTH)) / m.dpiX;
+  m.pageHeight =
+      static_cast<double>(GetDeviceCaps(hDC, PHYSICALHEIGHT)) / m.dpiY;
+  auto printableWidth = static_cast<double>(GetDeviceCaps(hDC, HORZRES)) / m.dpiX;
+  auto printableHeight =
+      static_cast<double>(GetDeviceCaps(hDC, VERTRES)) / m.dpiY;
+  m.offsetX = GetDeviceCaps(hDC, PHYSICALOFFSETX);
+  m.offsetY = GetDeviceCaps(hDC, PHYSICALOFFSETY);
+  m.marginLeft = static_cast<double>(m.offsetX) / m.dpiX;
+  m.marginTop = static_cast<double>(m.offsetY) / m.dpiY;
+  m.marginRight = m.pageWidth - printableWidth - m.marginLeft;
+  m.marginBottom = m.pageHeight - printableHeight - m.marginTop;
+  m.monochrome =
+      GetDeviceCaps(hDC, BITSPIXEL) * GetDeviceCaps(hDC, PLANES) == 1 ||
+      GetDeviceCaps(hDC, NUMCOLORS) == 2;
+  return m;
+}
+
+const PrinterCache::Entry* PrinterCache::find(const std::string& key) {
+  auto it = entries.find(key);
+  return it != entries.end() ? &it->second : nullptr;
+}
+
+const PrinterCache::Entry* PrinterCache::store(const std::string& key,
+                                               const std::string& printer,
+                                               const DEVMODE* dm,
+                                               const PageMetrics& metrics) {
+  auto& entry = entries[key];
+  entry.printer = printer;
+  entry.devMode.clear();
+  if (dm) {
+    auto bytes = reinterpret_cast<const uint8_t*>(dm);
+    entry.devMode.assign(bytes, bytes + dm->dmSize + dm->dmDriverExtra);
+  }
+  entry.metrics = metrics;
+  return &entry;
+}
+
+void PrinterCache::invalidate(const std::string& printer) {
+  for (auto it = entries.begin(); it != entries.end();) {
+    if (it->second.printer == printer) {
+      it = entries.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void PrinterCache::clear() {
+  entries.clear();
+}
@@ -0,0 +1,57 @@
+#ifndef PRINTING_PLUGIN_PRINTER_CACHE_H_
+#define PRINTING_PLUGIN_PRINTER_CACHE_H_
+
+#include <windows.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Page geometry of a configured printer DC, in PDF points unless noted.
+struct PageMetrics {
+  double dpiX = 1;  // device pixels per point
+  double dpiY = 1;
+  double pageWidth = 0;
+  double pageHeight = 0;
+  double marginLeft = 0;
+  double marginTop = 0;
+  double marginRight = 0;
+  double marginBottom = 0;
+  int offsetX = 0;  // device pixels
+  int offsetY = 0;
+  bool monochrome = false;
+
+  static PageMetrics measure(HDC hDC);
+};
+
+// Remembers, per printer configuration, the DEVMODE used to create the DC
+// and the resulting page metrics, so a repeat job can ask Dart for its
+// layout without creating a DC or querying the driver first.
+// Entries are dropped when the printer settings change, and all of them when
+// PrinterWatcher sees a printer added, removed or reconfigured.
+// Only used from the platform thread.
+class PrinterCache {
+ public:
+  struct Entry {
+    std::string printer;
+    std::vector<uint8_t> devMode;  // empty to use the driver defaults
+    PageMetrics metrics;
+  };
+
+  static const Entry* find(const std::string& key);
+
+  static const Entry* store(const std::string& key,
+                            const std::string& printer,
+                            const DEVMODE* dm,
+                            const PageMetrics& metrics);
+
+  // Forgets every entry for this printer.
+  static void invalidate(const std::string& printer);
+
+  static void clear();
+
+ private:
+  static std::map<std::string, Entry> entries;
+};
+
+#endif
@@ -0,0 +1,125 @@
+#include "printer_watcher.h"
+
+#include "printer_cache.h"
+#include "task_runner.h"
+
+static bool samePrinters(const std::vector<Printer>& a,
+                         const std::vector<Printer>& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i].name != b[i].name || a[i].url != b[i].url ||
+        a[i].model != b[i].model || a[i].location != b[i].location ||
+        a[i].comment != b[i].comment || a[i].default != b[i].default ||
+        a[i].available != b[i].available) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+PrinterWatcher::PrinterWatcher(TaskRunner* runner,
+                               std::function<void(PrinterList)> listener)
+    : runner{runner}, listener{std::move(listener)} {}
+
+PrinterWatcher::~PrinterWatcher() {
+  if (thread.joinable()) {
+    SetEvent(stopEvent);
+    thread.join();
+  }
+
+  if (stopEvent) {
+    CloseHandle(stopEvent);
+  }
+}
+
+PrinterWatcher::PrinterList PrinterWatcher::printers() {
+  if (!thread.joinable()) {
+    refresh();
+    stopEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+    thread = std::thread(&PrinterWatcher::watch, this);
+  }
+
+  std::lock_guard<std::mutex> lock{mutex};
+  return encoded;
+}
+
+void PrinterWatcher::watch() {
+  HANDLE server = nullptr;
+  if (!OpenPrinter(nullptr, &server, nullptr)) {
+    return;
+  }
+
+  auto change = FindFirstPrinterChangeNotification(
+      server, PRINTER_CHANGE_PRINTER, 0, nullptr);
+  if (change == INVALID_HANDLE_VALUE) {
+    ClosePrinter(server);
+    return;
+  }
+
+  HANDLE handles[] = {change, stopEvent};
+  while (WaitForMultipleObjects(2, handles, FALSE, INFINITE) ==
+         WAIT_OBJECT_0) {
+    DWORD what = 0;
+    FindNextPrinterChangeNotification(change, &what, nullptr, nullptr);
+
+    // A printer removed, added back or reconfigured may not match its cached
+    // DEVMODE and metrics anymore. The notification does not say which one.
+    if (what & (PRINTER_CHANGE_ADD_PRINTER | PRINTER_CHANGE_DELETE_PRINTER |
+                PRINTER_CHANGE_SET_PRINTER)) {
+      runner->post([] { PrinterCache::clear(); });
+    }
+
+    // Jobs, ports and drivers do not show in the list, status changes do.
+    if (refresh() && listener) {
+      PrinterList list;
+      {
+        std::lock_guard<std::mutex> lock{mutex};
+        list = encoded;
+      }
+      runner->post([listener = listener, list] { listener(list); });
+    }
+  }
+
+  FindClosePrinterChangeNotification(change);
+  ClosePrinter(server);
+}
+
+bool PrinterWatcher::refresh() {
+  auto printers = PrintJob::listPrinters();
+  auto list = std::make_shared<const flutter::EncodableList>(encode(printers));
+
+  std::lock_guard<std::mutex> lock{mutex};
+  if (encoded && samePrinters(current, printers)) {
+    return false;
+  }
+
+  current.swap(printers);
+  encoded = std::move(list);
+  return true;
+}
+
+flutter::EncodableList PrinterWatcher::encode(
+    const std::vector<Printer>& printers) {
+  auto pl = flutter::EncodableList{};
+  for (auto& printer : printers) {
+    auto mp = flutter::EncodableMap{};
+    mp[flutter::EncodableValue("name")] = flutter::EncodableValue(printer.name);
+    mp[flutter::EncodableValue("url")] = flutter::EncodableValue(printer.url);
+    mp[flutter::EncodableValue("model")] =
+        flutter::EncodableValue(printer.model);
+    mp[flutter::EncodableValue("location")] =
+        flutter::EncodableValue(printer.location);
+    mp[flutter::EncodableValue("comment")] =
+        flutter::EncodableValue(printer.comment);
+    mp[flutter::EncodableValue("default")] =
+        flutter::EncodableValue(printer.default);
+    mp[flutter::EncodableValue("available")] =
+        flutter::EncodableValue(printer.available);
+    pl.push_back(mp);
+  }
+  return pl;
+}
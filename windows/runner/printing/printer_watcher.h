@@ -0,0 +1,51 @@
+#ifndef PRINTING_PLUGIN_PRINTER_WATCHER_H_
+#define PRINTING_PLUGIN_PRINTER_WATCHER_H_
+
+#include <flutter/standard_method_codec.h>
+#include <windows.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "print_job.h"
+
+class TaskRunner;
+
+// Keeps the list of installed printers in memory, encoded for the channel.
+// A background thread waits for spooler change notifications and refreshes
+// the list, and the listener only hears about it when a printer was added,
+// removed, renamed or changed availability.
+class PrinterWatcher {
+ public:
+  using PrinterList = std::shared_ptr<const flutter::EncodableList>;
+
+  // The listener is called on the platform thread through the task runner.
+  PrinterWatcher(TaskRunner* runner, std::function<void(PrinterList)> listener);
+
+  virtual ~PrinterWatcher();
+
+  // Returns the cached list, enumerating and starting the watcher on first
+  // use.
+  PrinterList printers();
+
+ private:
+  void watch();
+
+  // Enumerates the printers and swaps them in, returns true if they differ.
+  bool refresh();
+
+  static flutter::EncodableList encode(const std::vector<Printer>& printers);
+
+  TaskRunner* runner;
+  std::function<void(PrinterList)> listener;
+  std::mutex mutex;
+  std::vector<Printer> current;
+  PrinterList encoded;
+  HANDLE stopEvent = nullptr;
+  std::thread thread;
+};
+
+#endif
@@ -1,34 +1,47 @@
 #include "printing.h"
 
+#include "flight_recorder.h"
+#include "memory_stats.h"
 #include "print_job.h"
+#include "task_runner.h"
+#include "trace.h"
 
 //namespace printingPdf {
 
 extern std::unique_ptr<flutter::MethodChannel<flutter::EncodableValue>> channel;
 
-Printing::Printing() {}
+Printing::Printing(TaskRunner* runner) : runner{runner} {}
 
 Printing::~Printing() {}
 
 void Printing::onPageRasterized(std::vector<uint8_t> data,
+                                std::vector<uint8_t> text,
                                 int width,
                                 int height,
                                 PrintJob* job) {
+  PRINTING_TRACE_SCOPE("onPageRasterized", job->id(), -1);
+  TrackedBytes payload{MemoryCategory::message, job->id(),
+                       data.size() + text.size()};
+  auto map = flutter::EncodableMap{
+      {flutter::EncodableValue("image"), flutter::EncodableValue(std::move(data))},
+      {flutter::EncodableValue("width"), flutter::EncodableValue(width)},
+      {flutter::EncodableValue("height"), flutter::EncodableValue(height)},
+      {flutter::EncodableValue("job"), flutter::EncodableValue(job->id())},
+  };
+
+  if (!text.empty()) {
+    map[flutter::EncodableValue("text")] = flutter::EncodableValue(std::move(text));
+  }
+
   channel->InvokeMethod(
       "onPageRasterized",
       std::make_unique<flutter::EncodableValue>(
-          flutter::EncodableValue(flutter::EncodableMap{
-              {flutter::EncodableValue("image"), flutter::EncodableValue(data)},
-              {flutter::EncodableValue("width"),
-               flutter::EncodableValue(width)},
-              {flutter::EncodableValue("height"),
-               flutter::EncodableValue(height)},
-              {flutter::EncodableValue("job"),
-               flutter::EncodableValue(job->id())},
-          })));
+          flutter::EncodableValue(std::move(map))));
 }
 
 void Printing::onPageRasterEnd(PrintJob* job, const std::string& error) {
+  FlightRecorder::record(
+      error.empty() ? FlightEvent::completed : FlightEvent::error, job->id());
   auto map = flutter::EncodableMap{
       {flutter::EncodableValue("job"), flutter::EncodableValue(job->id())},
   };
@@ -42,18 +55,77 @@ void Printing::onPageRasterEnd(PrintJob* job, const std::string& error) {
       std::make_unique<flutter::EncodableValue>(flutter::EncodableValue(map)));
 }
 
+void Printing::onBatchRasterized(int job,
+                                 int document,
+                                 int page,
+                                 std::vector<uint8_t> image,
+                                 int width,
+                                 int height,
+                                 const std::string& error) {
+  TrackedBytes payload{MemoryCategory::message, job, image.size()};
+  auto map = flutter::EncodableMap{
+      {flutter::EncodableValue("job"), flutter::EncodableValue(job)},
+      {flutter::EncodableValue("document"), flutter::EncodableValue(document)},
+      {flutter::EncodableValue("page"), flutter::EncodableValue(page)},
+  };
+
+  if (error.empty()) {
+    map[flutter::EncodableValue("image")] =
+        flutter::EncodableValue(std::move(image));
+    map[flutter::EncodableValue("width")] = flutter::EncodableValue(width);
+    map[flutter::EncodableValue("height")] = flutter::EncodableValue(height);
+  } else {
+    map[flutter::EncodableValue("error")] = flutter::EncodableValue(error);
+  }
+
+  channel->InvokeMethod(
+      "onBatchRasterized",
+      std::make_unique<flutter::EncodableValue>(
+          flutter::EncodableValue(std::move(map))));
+}
+
+void Printing::onBatchEnd(int job) {
+  FlightRecorder::record(FlightEvent::completed, job);
+  channel->InvokeMethod(
+      "onBatchEnd",
+      std::make_unique<flutter::EncodableValue>(
+          flutter::EncodableValue(flutter::EncodableMap{
+              {flutter::EncodableValue("job"), flutter::EncodableValue(job)},
+          })));
+}
+
 class OnLayoutResult : public flutter::MethodResult<flutter::EncodableValue> {
  public:
-  OnLayoutResult(PrintJob* job) : job{job} {}
+  OnLayoutResult(Printing* printing,
+                 PrintJob* job,
+                 LayoutCache* cache,
+                 const std::string& key)
+      : printing{printing}, job{job}, cache{cache}, key{key} {}
 
  private:
+  Printing* printing;
   PrintJob* job;
+  LayoutCache* cache;
+  std::string key;
 
  protected:
   void SuccessInternal(const flutter::EncodableValue* result) {
-    auto doc = std::get<std::vector<uint8_t>>(*result);
+    auto doc = result ? std::get_if<std::vector<uint8_t>>(result) : nullptr;
+    if (!doc) {
+      printing->onCompleted(job, false, "The layout did not return a document");
+      delete job;
+      return;
+    }
+    TrackedBytes payload{MemoryCategory::message, job->id(), doc->size()};
 
-    job->writeJob(doc);
+    if (key.empty()) {
+      job->writeJob(*doc);
+    } else {
+      // The reply belongs to the channel, the cache keeps its own copy.
+      auto cached = std::make_shared<const std::vector<uint8_t>>(*doc);
+      cache->store(key, cached);
+      job->writeJob(*cached);
+    }
     delete job;
   }
 
@@ -73,6 +145,23 @@ void Printing::onLayout(PrintJob* job,
                         double marginTop,
                         double marginRight,
                         double marginBottom) {
+  PRINTING_TRACE_SCOPE("onLayout", job->id(), -1);
+  std::string key;
+  if (!job->documentId().empty()) {
+    key = LayoutCache::key(job->documentId(), pageWidth, pageHeight,
+                           marginLeft, marginTop, marginRight, marginBottom);
+    auto cached = layoutCache.find(key);
+    if (cached) {
+      // Same document on the same page metrics, skip the Dart layout. Still
+      // printed after the printPdf call has returned, like a layout reply.
+      runner->post([job, cached] {
+        job->writeJob(*cached);
+        delete job;
+      });
+      return;
+    }
+  }
+
   channel->InvokeMethod("onLayout",
                         std::make_unique<flutter::EncodableValue>(
                             flutter::EncodableValue(flutter::EncodableMap{
@@ -91,13 +180,17 @@ void Printing::onLayout(PrintJob* job,
                                 {flutter::EncodableValue("marginBottom"),
                                  flutter::EncodableValue(marginBottom)},
                             })),
-                        std::make_unique<OnLayoutResult>(job));
+                        std::make_unique<OnLayoutResult>(this, job,
+                                                         &layoutCache, key));
 }
 
 // send completion status to flutter
 void Printing::onCompleted(PrintJob* job,
                            bool completed,
                            const std::string& error) {
+  PRINTING_TRACE_SCOPE("onCompleted", job->id(), -1);
+  FlightRecorder::record(
+      completed ? FlightEvent::completed : FlightEvent::error, job->id());
   auto map = flutter::EncodableMap{
       {flutter::EncodableValue("job"), flutter::EncodableValue(job->id())},
       {flutter::EncodableValue("completed"),
@@ -112,4 +205,110 @@ void Printing::onCompleted(PrintJob* job,
       "onCompleted",
       std::make_unique<flutter::EncodableValue>(flutter::EncodableValue(map)));
 }
+void Printing::onSpooled(PrintJob* job,
+                         bool completed,
+                         const SpoolStats& stats) {
+  channel->InvokeMethod(
+      "onJobProgress",
+      std::make_unique<flutter::EncodableValue>(flutter::EncodableValue(
+          flutter::EncodableMap{
+              {flutter::EncodableValue("job"), flutter::EncodableValue(job->id())},
+              {flutter::EncodableValue("name"),
+               flutter::EncodableValue(job->name())},
+              {flutter::EncodableValue("state"),
+               flutter::EncodableValue(completed ? "sent" : "failed")},
+              {flutter::EncodableValue("sent"),
+               flutter::EncodableValue(completed ? stats.documentBytes : 0)},
+              {flutter::EncodableValue("total"),
+               flutter::EncodableValue(stats.documentBytes)},
+              {flutter::EncodableValue("printerJob"),
+               flutter::EncodableValue(stats.printerJob)},
+              {flutter::EncodableValue("pages"),
+               flutter::EncodableValue(stats.pages)},
+              {flutter::EncodableValue("rasterPages"),
+               flutter::EncodableValue(stats.rasterPages)},
+              {flutter::EncodableValue("imageBytes"),
+               flutter::EncodableValue(stats.imageBytes)},
+              {flutter::EncodableValue("rasterBytes"),
+               flutter::EncodableValue(stats.rasterBytes)},
+              {flutter::EncodableValue("spoolBytes"),
+               flutter::EncodableValue(stats.spoolBytes)},
+              {flutter::EncodableValue("spoolTime"),
+               flutter::EncodableValue(stats.seconds * 1000)},
+          })));
+}
+
+void Printing::onPageSpooled(PrintJob* job, const SpoolProgress& progress) {
+  channel->InvokeMethod(
+      "onPageSpooled",
+      std::make_unique<flutter::EncodableValue>(flutter::EncodableValue(
+          flutter::EncodableMap{
+              {flutter::EncodableValue("job"), flutter::EncodableValue(job->id())},
+              {flutter::EncodableValue("pages"),
+               flutter::EncodableValue(progress.pages)},
+              {flutter::EncodableValue("renderTime"),
+               flutter::EncodableValue(progress.renderMs)},
+              {flutter::EncodableValue("spoolTime"),
+               flutter::EncodableValue(progress.spoolMs)},
+              {flutter::EncodableValue("spooled"),
+               flutter::EncodableValue(progress.spooled)},
+              {flutter::EncodableValue("spoolBytes"),
+               flutter::EncodableValue(progress.spoolBytes)},
+              {flutter::EncodableValue("pagesPerSecond"),
+               flutter::EncodableValue(progress.pagesPerSecond)},
+          })));
+}
+
+// send the new printer list to flutter
+void Printing::onPrintersChanged(const flutter::EncodableList& printers) {
+  channel->InvokeMethod(
+      "onPrintersChanged",
+      std::make_unique<flutter::EncodableValue>(flutter::EncodableValue(
+          flutter::EncodableMap{
+              {flutter::EncodableValue("printers"),
+               flutter::EncodableValue(printers)},
+          })));
+}
+void Printing::onDevicePixelRatioChanged(double ratio) {
+  channel->InvokeMethod(
+      "onDevicePixelRatioChanged",
+      std::make_unique<flutter::EncodableValue>(flutter::EncodableValue(
+          flutter::EncodableMap{
+              {flutter::EncodableValue("devicePixelRatio"),
+               flutter::EncodableValue(ratio)},
+          })));
+}
+
+void Printing::onPageRerendered(int handle,
+                                int page,
+                                std::vector<uint8_t> image,
+                                int width,
+                                int height) {
+  TrackedBytes payload{MemoryCategory::message, -1, image.size()};
+  channel->InvokeMethod(
+      "onPageRerendered",
+      std::make_unique<flutter::EncodableValue>(flutter::EncodableValue(
+          flutter::EncodableMap{
+              {flutter::EncodableValue("handle"), flutter::EncodableValue(handle)},
+              {flutter::EncodableValue("page"), flutter::EncodableValue(page)},
+              {flutter::EncodableValue("image"),
+               flutter::EncodableValue(std::move(image))},
+              {flutter::EncodableValue("width"), flutter::EncodableValue(width)},
+              {flutter::EncodableValue("height"),
+               flutter::EncodableValue(height)},
+          })));
+}
+
+flutter::EncodableMap Printing::layoutCacheStats() {
+  return flutter::EncodableMap{
+      {flutter::EncodableValue("hits"),
+       flutter::EncodableValue(static_cast<int64_t>(layoutCache.hits()))},
+      {flutter::EncodableValue("misses"),
+       flutter::EncodableValue(static_cast<int64_t>(layoutCache.misses()))},
+      {flutter::EncodableValue("entries"),
+       flutter::EncodableValue(static_cast<int64_t>(layoutCache.entries()))},
+      {flutter::EncodableValue("bytes"),
+       flutter::EncodableValue(static_cast<int64_t>(layoutCache.bytes()))},
+  };
+}
 //}
\ No newline at end of file
@@ -8,22 +8,46 @@
 
 #include <flutter/method_channel.h>
 
+#include "layout_cache.h"
+
 class PrintJob;
+class TaskRunner;
+struct SpoolProgress;
+struct SpoolStats;
 
 class Printing {
  private:
+  TaskRunner* runner;
+  LayoutCache layoutCache{32 * 1024 * 1024};
+
  public:
-  Printing();
+  // runner defers the work that must not run inside a method call.
+  explicit Printing(TaskRunner* runner);
 
   virtual ~Printing();
 
+  // text is the packed text layer of the page, empty if not requested.
   void onPageRasterized(std::vector<uint8_t> data,
+                        std::vector<uint8_t> text,
                         int width,
                         int height,
                         PrintJob* job);
 
   void onPageRasterEnd(PrintJob* job, const std::string& error);
 
+  // A page of the document-th document of a rasterBatch job, or the reason
+  // the document could not be rendered if error is set.
+  void onBatchRasterized(int job,
+                         int document,
+                         int page,
+                         std::vector<uint8_t> image,
+                         int width,
+                         int height,
+                         const std::string& error);
+
+  // Sent once every document of a rasterBatch job is done.
+  void onBatchEnd(int job);
+
   void onLayout(PrintJob* job,
                 double pageWidth,
                 double pageHeight,
@@ -35,6 +59,26 @@ class Printing {
   void onCompleted(PrintJob* job,
                              bool completed,
                              const std::string& error);
+
+  // Sent as onJobProgress once the document is spooled, or failed.
+  void onSpooled(PrintJob* job, bool completed, const SpoolStats& stats);
+
+  // Pages spooled since the previous event, with their timings.
+  void onPageSpooled(PrintJob* job, const SpoolProgress& progress);
+
+  void onPrintersChanged(const flutter::EncodableList& printers);
+
+  void onDevicePixelRatioChanged(double ratio);
+
+  // A visible page of an open document rendered again for a new device
+  // pixel ratio.
+  void onPageRerendered(int handle,
+                        int page,
+                        std::vector<uint8_t> image,
+                        int width,
+                        int height);
+
+  flutter::EncodableMap layoutCacheStats();
 };
 
 #endif
\ No newline at end of file
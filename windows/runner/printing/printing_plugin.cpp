@@ -5,16 +5,43 @@
 #include <flutter/method_channel.h>
 #include <flutter/plugin_registrar_windows.h>
 #include <flutter/standard_method_codec.h>
+#include <flutter_windows.h>
 
+#include <atomic>
+#include <fstream>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <numeric>
 #include <sstream>
+#include <thread>
 
+#include "document_probe.h"
+#include "flight_recorder.h"
+#include "image_scale.h"
+#include "imposition.h"
+#include "memory_stats.h"
+#include "method_dispatch.h"
+#include "open_document.h"
+#include "page_prefetcher.h"
+#include "page_texture.h"
+#include "pdfium.h"
 #include "print_job.h"
+#include "printer_cache.h"
+#include "printer_watcher.h"
 #include "printing.h"
+#include "raster_farm.h"
+#include "task_runner.h"
+#include "text_index.h"
+#include "trace.h"
+#include "worker_pool.h"
 
 //namespace printingPdf {
 
+std::string toUtf8(TCHAR* tstr);
+std::wstring fromUtf8(std::string str);
+
 std::unique_ptr<flutter::MethodChannel<flutter::EncodableValue>> channel;
 
 class PrintingPlugin : public flutter::Plugin {
@@ -25,124 +52,774 @@ class PrintingPlugin : public flutter::Plugin {
           registrar->messenger(), "printing",
           &flutter::StandardMethodCodec::GetInstance());
 
-    auto plugin = std::make_unique<PrintingPlugin>();
+    auto plugin =
+        std::make_unique<PrintingPlugin>(registrar->texture_registrar());
 
     channel->SetMethodCallHandler(
         [plugin_pointer = plugin.get()](const auto& call, auto result) {
           plugin_pointer->HandleMethodCall(call, std::move(result));
         });
 
+    auto view = registrar->GetView();
+    if (view) {
+      auto window = GetAncestor(view->GetNativeWindow(), GA_ROOT);
+      plugin->devicePixelRatio =
+          FlutterDesktopGetDpiForMonitor(
+              MonitorFromWindow(window, MONITOR_DEFAULTTONEAREST)) /
+          96.0;
+    }
+
+    // Cached printer settings are stale once the user edits them, and
+    // visible pages are blurry or oversized once the window changes DPI.
+    registrar->RegisterTopLevelWindowProcDelegate(
+        [plugin_pointer = plugin.get()](HWND hwnd, UINT message, WPARAM wparam,
+                                        LPARAM lparam) -> std::optional<LRESULT> {
+          if (message == WM_DEVMODECHANGE) {
+            PrinterCache::invalidate(toUtf8(reinterpret_cast<TCHAR*>(lparam)));
+          } else if (message == WM_DPICHANGED) {
+            plugin_pointer->onDpiChanged(LOWORD(wparam) / 96.0);
+          }
+          return std::nullopt;
+        });
+
     registrar->AddPlugin(std::move(plugin));
   }
 
-  PrintingPlugin() {}
+  explicit PrintingPlugin(flutter::TextureRegistrar* textureRegistrar)
+      : textureRegistrar{textureRegistrar},
+        runner{std::make_unique<TaskRunner>()},
+        owner{std::make_shared<Owner>(runner.get())},
+        printing{runner.get()},
+        watcher{std::make_unique<PrinterWatcher>(
+            runner.get(), [this](PrinterWatcher::PrinterList printers) {
+              printing.onPrintersChanged(*printers);
+            })} {
+    dispatcher.add("printPdf", [this](const Args& args, Result result) {
+      printPdf(PrintPdfArgs{args}, std::move(result));
+    });
+    dispatcher.add("sharePdf", [this](const Args& args, Result result) {
+      sharePdf(SharePdfArgs{args}, std::move(result));
+    });
+    dispatcher.add("listPrinters", [this](const Args& args, Result result) {
+      result->Success(*watcher->printers());
+    });
+    dispatcher.add("rasterPdf", [this](const Args& args, Result result) {
+      rasterPdf(RasterPdfArgs{args}, std::move(result));
+    });
+    dispatcher.add("startRasterWorkers", [this](const Args& args, Result result) {
+      auto workers = rasterFarm(args.integer(Keys::workers));
+      WorkerPool::shared().post([workers] { workers->warmUp(); });
+      result->Success(flutter::EncodableValue(static_cast<int>(workers->size())));
+    });
+    dispatcher.add("rasterAtlas", [this](const Args& args, Result result) {
+      rasterAtlas(RasterAtlasArgs{args}, std::move(result));
+    });
+    dispatcher.add("rasterBatch", [this](const Args& args, Result result) {
+      rasterBatch(RasterBatchArgs{args}, std::move(result));
+    });
+    dispatcher.add("probeDocument", [](const Args& args, Result result) {
+      DocumentProbe probe;
+      std::string error;
+      if (!DocumentProbe::probe(args.bytes(Keys::doc), probe, error)) {
+        result->Error("probeDocument", error);
+        return;
+      }
+      result->Success(flutter::EncodableValue(probe.toMap()));
+    });
+    dispatcher.add("openDocument", [this](const Args& args, Result result) {
+      openDocument(args.bytes(Keys::doc), std::move(result));
+    });
+    dispatcher.add("rasterPage", [this](const Args& args, Result result) {
+      rasterPage(RasterPageArgs{args}, std::move(result));
+    });
+    dispatcher.add("closeDocument", [this](const Args& args, Result result) {
+      auto handle = args.integer(Keys::handle, -1);
+      documents.erase(handle);
+      visiblePages.erase(handle);
+      prefetcher->forget(handle);
+      result->Success(nullptr);
+    });
+    dispatcher.add("setVisiblePages", [this](const Args& args, Result result) {
+      visiblePages[args.integer(Keys::handle, -1)] =
+          VisiblePages{args.integers(Keys::pages), args.number(Keys::width)};
+      result->Success(nullptr);
+    });
+    dispatcher.add("devicePixelRatio", [this](const Args& args, Result result) {
+      result->Success(flutter::EncodableValue(devicePixelRatio));
+    });
+    dispatcher.add("createTexture", [this](const Args& args, Result result) {
+      createTexture(args, std::move(result));
+    });
+    dispatcher.add("renderTexture", [this](const Args& args, Result result) {
+      renderTexture(RenderTextureArgs{args}, std::move(result));
+    });
+    dispatcher.add("disposeTexture", [this](const Args& args, Result result) {
+      auto it = textures.find(args.integer64(Keys::texture, -1));
+      if (it != textures.end()) {
+        it->second->release();
+        textures.erase(it);
+      }
+      result->Success(nullptr);
+    });
+    dispatcher.add("prefetchStats", [this](const Args& args, Result result) {
+      result->Success(flutter::EncodableValue(prefetcher->stats()));
+    });
+    dispatcher.add("layoutCacheStats",
+                   [this](const Args& args, Result result) {
+                     result->Success(printing.layoutCacheStats());
+                   });
+    dispatcher.add("memoryStats", [](const Args& args, Result result) {
+      result->Success(flutter::EncodableValue(MemoryStats::toMap()));
+    });
+    dispatcher.add("flightRecorder", [](const Args& args, Result result) {
+      result->Success(flutter::EncodableValue(FlightRecorder::toMap()));
+    });
+    dispatcher.add("exportFlightRecorder",
+                   [](const Args& args, Result result) {
+                     result->Success(flutter::EncodableValue(
+                         FlightRecorder::exportTo(args.string(Keys::path))));
+                   });
+    dispatcher.add("exportTrace", [this](const Args& args, Result result) {
+      result->Success(flutter::EncodableValue(exportTrace(args.string(Keys::path))));
+    });
+    dispatcher.add("indexDocument", [this](const Args& args, Result result) {
+      indexDocument(IndexDocumentArgs{args}, std::move(result));
+    });
+    dispatcher.add("loadTextIndex", [this](const Args& args, Result result) {
+      loadTextIndex(IndexDocumentArgs{args}, std::move(result));
+    });
+    dispatcher.add("searchText", [this](const Args& args, Result result) {
+      searchText(SearchTextArgs{args}, std::move(result));
+    });
+    dispatcher.add("closeTextIndex", [this](const Args& args, Result result) {
+      textIndexes.erase(args.string(Keys::documentId));
+      result->Success(nullptr);
+    });
+    dispatcher.add("printingInfo", [this](const Args& args, Result result) {
+      printingInfo(std::move(result));
+    });
+  }
 
-  virtual ~PrintingPlugin() {}
+  virtual ~PrintingPlugin() {
+    owner->detach();
+    for (auto& texture : textures) {
+      texture.second->release();
+    }
+  }
 
  private:
-  Printing printing{};
+  using Result = MethodDispatcher::Result;
+
+  // Shared with the tasks on the worker pool, which may finish after the
+  // plugin is destroyed. They post back to the platform thread through it,
+  // and their results are dropped once the plugin is gone.
+  class Owner {
+   public:
+    explicit Owner(TaskRunner* runner) : runner{runner} {}
+
+    void post(std::function<void()> task) {
+      std::lock_guard<std::mutex> lock{mutex};
+      if (runner) {
+        runner->post(std::move(task));
+      }
+    }
+
+    void detach() {
+      std::lock_guard<std::mutex> lock{mutex};
+      runner = nullptr;
+    }
+
+   private:
+    std::mutex mutex;
+    TaskRunner* runner;
+  };
+
+  flutter::TextureRegistrar* textureRegistrar;
+  std::unique_ptr<TaskRunner> runner;
+  std::shared_ptr<Owner> owner;
+  Printing printing;
+  std::unique_ptr<PrinterWatcher> watcher;
+  std::shared_ptr<RasterFarm> farm;
+  MethodDispatcher dispatcher;
+  std::map<std::string, std::shared_ptr<const TextIndex>> textIndexes;
+  std::map<int64_t, std::shared_ptr<PageTexture>> textures;
+  std::map<int, std::shared_ptr<OpenDocument>> documents;
+  int nextDocument = 1;
+  // Shared with the render tasks, which may outlive the plugin.
+  std::shared_ptr<PagePrefetcher> prefetcher =
+      std::make_shared<PagePrefetcher>(64 * 1024 * 1024);
+
+  // Pages of an open document on screen, and their width in logical pixels.
+  struct VisiblePages {
+    std::vector<int> pages;
+    double width;
+  };
+
+  double devicePixelRatio = 1.0;
+  std::map<int, VisiblePages> visiblePages;
 
   void HandleMethodCall(
       const flutter::MethodCall<flutter::EncodableValue>& method_call,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-    if (method_call.method_name().compare("printPdf") == 0) {
-      const auto* arguments =
-          std::get_if<flutter::EncodableMap>(method_call.arguments());
-      auto vName = arguments->find(flutter::EncodableValue("name"));
-      auto name = vName != arguments->end() && !vName->second.IsNull()
-                      ? std::get<std::string>(vName->second)
-                      : std::string{"document"};
-      auto vPrinter = arguments->find(flutter::EncodableValue("printer"));
-      auto printer = vPrinter != arguments->end()
-                         ? std::get<std::string>(vPrinter->second)
-                         : std::string{};
-      auto width = std::get<double>(
-          arguments->find(flutter::EncodableValue("width"))->second);
-      auto height = std::get<double>(
-          arguments->find(flutter::EncodableValue("height"))->second);
-      auto usePrinterSettings = std::get<bool>(
-          arguments->find(flutter::EncodableValue("usePrinterSettings"))
-              ->second);
-      auto vJob = arguments->find(flutter::EncodableValue("job"));
-      auto jobNum = vJob != arguments->end() ? std::get<int>(vJob->second) : -1;
-      auto job = new PrintJob{&printing, jobNum};
-      auto res =
-          job->printPdf(name, printer, width, height, usePrinterSettings);
-      if (!res) {
-        delete job;
+    dispatcher.dispatch(method_call, std::move(result));
+  }
+
+  void printPdf(const PrintPdfArgs& args, Result result) {
+    FlightRecorder::record(FlightEvent::enqueue, args.job);
+    auto job = new PrintJob{&printing, args.job};
+    job->setLookAhead(args.lookAhead);
+    job->setDocumentId(args.documentId);
+    job->setBatchWindow(args.batchWindow);
+    job->setOutputMode(PrintJob::outputModeNamed(args.outputMode));
+    job->setDownsample(args.downsample);
+    job->setImposition(imposition(args.imposition));
+    auto res = job->printPdf(args.name, args.printer, args.width, args.height,
+                             args.usePrinterSettings);
+    if (!res) {
+      delete job;
+    }
+    result->Success(flutter::EncodableValue(res ? 1 : 0));
+  }
+
+  static Imposition imposition(const ImpositionArgs& args) {
+    return Imposition{Imposition::modeNamed(args.mode), args.columns,
+                      args.rows};
+  }
+
+  void sharePdf(const SharePdfArgs& args, Result result) {
+    auto job = std::make_unique<PrintJob>(&printing, -1);
+    auto res = job->sharePdf(args.doc, args.name);
+    result->Success(flutter::EncodableValue(res ? 1 : 0));
+  }
+
+  void rasterPdf(const RasterPdfArgs& args, Result result) {
+    FlightRecorder::record(FlightEvent::enqueue, args.job);
+    if (args.isolated) {
+      rasterIsolated(args);
+      result->Success(nullptr);
+      return;
+    }
+
+    auto job = std::make_unique<PrintJob>(&printing, args.job);
+    job->setImposition(imposition(args.imposition), args.imposition.sheetWidth,
+                       args.imposition.sheetHeight);
+    job->rasterPdf(args.doc, args.pages, args.scale, args.textLayer);
+    result->Success(nullptr);
+  }
+
+  // Created by the first isolated raster, batch or startRasterWorkers, with
+  // half the cores by default.
+  std::shared_ptr<RasterFarm> rasterFarm(int workers = 0) {
+    if (!farm) {
+      auto count = workers > 0 ? static_cast<size_t>(workers)
+                               : std::max<size_t>(
+                                     std::thread::hardware_concurrency() / 2, 2);
+      farm = std::make_shared<RasterFarm>(count);
+    }
+    return farm;
+  }
+
+  // Same events as rasterPdf, with the pages rendered by the worker
+  // processes, as many at once as there are workers, and sent in order.
+  // A worker crashing on the document ends the stream with an error.
+  // Only the tasks posted through the owner use the plugin.
+  void rasterIsolated(const RasterPdfArgs& args) {
+    auto job = std::make_shared<PrintJob>(&printing, args.job);
+    auto document = RasterFarm::Document::create(args.doc);
+    if (!document) {
+      printing.onPageRasterEnd(job.get(), "Cannot share the document");
+      return;
+    }
+
+    WorkerPool::shared().post([this, owner = owner, job,
+                               workers = rasterFarm(), document,
+                               pages = args.pages,
+                               scale = args.scale]() mutable {
+      PRINTING_TRACE_SCOPE("rasterIsolated", job->id(), -1);
+      std::string error;
+      auto count = workers->pageCount(document, error);
+      if (pages.empty() && count > 0) {
+        pages.resize(count);
+        std::iota(pages.begin(), pages.end(), 0);
       }
-      result->Success(flutter::EncodableValue(res ? 1 : 0));
-    } else if (method_call.method_name().compare("sharePdf") == 0) {
-      const auto* arguments =
-          std::get_if<flutter::EncodableMap>(method_call.arguments());
-      auto vName = arguments->find(flutter::EncodableValue("name"));
-      auto name = vName != arguments->end() && !vName->second.IsNull()
-                      ? std::get<std::string>(vName->second)
-                      : std::string{"document.pdf"};
-      auto vDoc = arguments->find(flutter::EncodableValue("doc"));
-      auto doc = vDoc != arguments->end()
-                     ? std::get<std::vector<uint8_t>>(vDoc->second)
-                     : std::vector<uint8_t>{};
-      auto job = std::make_unique<PrintJob>(&printing, -1);
-      auto res = job->sharePdf(doc, name);
-      result->Success(flutter::EncodableValue(res ? 1 : 0));
-    } else if (method_call.method_name().compare("listPrinters") == 0) {
-      auto job = std::make_unique<PrintJob>(&printing, -1);
-      auto printers = job->listPrinters();
-      auto pl = flutter::EncodableList{};
-      for (auto printer : printers) {
-        auto mp = flutter::EncodableMap{};
-        mp[flutter::EncodableValue("name")] =
-            flutter::EncodableValue(printer.name);
-        mp[flutter::EncodableValue("url")] =
-            flutter::EncodableValue(printer.url);
-        mp[flutter::EncodableValue("model")] =
-            flutter::EncodableValue(printer.model);
-        mp[flutter::EncodableValue("location")] =
-            flutter::EncodableValue(printer.location);
-        mp[flutter::EncodableValue("comment")] =
-            flutter::EncodableValue(printer.comment);
-        mp[flutter::EncodableValue("default")] =
-            flutter::EncodableValue(printer.default);
-        mp[flutter::EncodableValue("available")] =
-            flutter::EncodableValue(printer.available);
-        pl.push_back(mp);
+      pages.erase(std::remove_if(pages.begin(), pages.end(),
+                                 [count](int n) { return n < 0 || n >= count; }),
+                  pages.end());
+
+      for (size_t first = 0; first < pages.size() && error.empty();
+           first += workers->size()) {
+        auto batch = std::min(workers->size(), pages.size() - first);
+        std::vector<std::shared_ptr<OpenDocument::Image>> images(batch);
+        std::vector<std::string> errors(batch);
+        WorkerPool::shared().parallelFor(batch, [&](size_t i) {
+          auto image = std::make_shared<OpenDocument::Image>();
+          if (workers->render(document, pages[first + i], scale, *image,
+                              errors[i])) {
+            images[i] = image;
+          }
+        });
+
+        for (size_t i = 0; i < batch && error.empty(); i++) {
+          if (!images[i]) {
+            error = errors[i];
+            break;
+          }
+          owner->post([this, job, image = images[i]] {
+            printing.onPageRasterized(std::move(image->pixels), {},
+                                      image->width, image->height, job.get());
+          });
+        }
       }
-      result->Success(pl);
-    } else if (method_call.method_name().compare("rasterPdf") == 0) {
-      const auto* arguments =
-          std::get_if<flutter::EncodableMap>(method_call.arguments());
-      auto vDoc = arguments->find(flutter::EncodableValue("doc"));
-      auto doc = vDoc != arguments->end()
-                     ? std::get<std::vector<uint8_t>>(vDoc->second)
-                     : std::vector<uint8_t>{};
-      auto vPages = arguments->find(flutter::EncodableValue("pages"));
-      auto lPages = vPages != arguments->end() && !vPages->second.IsNull()
-                        ? std::get<flutter::EncodableList>(vPages->second)
-                        : flutter::EncodableList{};
-      auto pages = std::vector<int>{};
-      for (auto page : lPages) {
-        pages.push_back(std::get<int>(page));
+
+      owner->post([this, job, error] {
+        printing.onPageRasterEnd(job.get(), error);
+      });
+    });
+  }
+
+  // Answers with the whole atlas, one message for every thumbnail.
+  void rasterAtlas(const RasterAtlasArgs& args, Result result) {
+    FlightRecorder::record(FlightEvent::enqueue, args.job);
+    auto job = std::make_unique<PrintJob>(&printing, args.job);
+    RasterAtlas atlas;
+    if (!job->rasterAtlas(args.doc, args.pages, args.scale,
+                          std::max(args.maxWidth, 1), atlas)) {
+      FlightRecorder::record(FlightEvent::error, args.job);
+      result->Error("rasterAtlas", "Cannot raster a malformed PDF file");
+      return;
+    }
+
+    TrackedBytes output{MemoryCategory::output, args.job, atlas.pixels.size()};
+    result->Success(flutter::EncodableValue(flutter::EncodableMap{
+        {flutter::EncodableValue("image"),
+         flutter::EncodableValue(std::move(atlas.pixels))},
+        {flutter::EncodableValue("width"), flutter::EncodableValue(atlas.width)},
+        {flutter::EncodableValue("height"),
+         flutter::EncodableValue(atlas.height)},
+        {flutter::EncodableValue("rects"),
+         flutter::EncodableValue(std::move(atlas.rects))},
+    }));
+    FlightRecorder::record(FlightEvent::completed, args.job);
+  }
+
+  // Renders the same pages of many documents on the raster worker
+  // processes, each with its own PDFium, so that as many documents render at
+  // once as there are workers. One task per worker on the pool takes the
+  // documents in turn. Pages are sent as soon as they are ready, so they
+  // arrive in no particular order, tagged with the index of their document.
+  // A document that cannot be read or loaded is reported and does not stop
+  // the others.
+  void rasterBatch(const RasterBatchArgs& args, Result result) {
+    if (!args.docs) {
+      result->Error("rasterBatch", "No documents");
+      return;
+    }
+
+    FlightRecorder::record(FlightEvent::enqueue, args.job);
+    result->Success(nullptr);
+
+    if (args.docs->empty()) {
+      printing.onBatchEnd(args.job);
+      return;
+    }
+
+    struct Batch {
+      std::vector<OpenDocument::Bytes> docs;  // nullptr to read the path
+      std::vector<std::string> paths;
+      std::atomic<size_t> next{0};
+      std::atomic<size_t> running{0};
+    };
+    auto batch = std::make_shared<Batch>();
+    for (auto& item : *args.docs) {
+      auto path = std::get_if<std::string>(&item);
+      auto bytes = std::get_if<std::vector<uint8_t>>(&item);
+      batch->docs.push_back(
+          bytes ? std::make_shared<const std::vector<uint8_t>>(*bytes)
+                : nullptr);
+      batch->paths.push_back(path ? *path : std::string{});
+    }
+
+    auto workers = rasterFarm();
+    auto tasks = std::min(workers->size(), batch->docs.size());
+    batch->running = tasks;
+    for (size_t task = 0; task < tasks; task++) {
+      WorkerPool::shared().post([this, owner = owner, workers, batch,
+                                 job = args.job, pages = args.pages,
+                                 scale = args.scale] {
+        for (auto i = batch->next++; i < batch->docs.size();
+             i = batch->next++) {
+          renderBatchDocument(this, owner, *workers, job, static_cast<int>(i),
+                              batch->docs[i], batch->paths[i], pages, scale);
+        }
+        if (--batch->running == 0) {
+          owner->post([this, job] { printing.onBatchEnd(job); });
+        }
+      });
+    }
+  }
+
+  // Runs on the worker pool, plugin is only used by the tasks posted
+  // through owner.
+  static void renderBatchDocument(PrintingPlugin* plugin,
+                                  const std::shared_ptr<Owner>& owner,
+                                  RasterFarm& workers,
+                                  int job,
+                                  int index,
+                                  OpenDocument::Bytes doc,
+                                  const std::string& path,
+                                  const std::vector<int>& pages,
+                                  double scale) {
+    PRINTING_TRACE_SCOPE("rasterBatch", job, index);
+    auto fail = [plugin, &owner, job, index](int page,
+                                              const std::string& error) {
+      owner->post([plugin, job, index, page, error] {
+        plugin->printing.onBatchRasterized(job, index, page, {}, 0, 0, error);
+      });
+    };
+
+    if (!doc) {
+      auto bytes = std::make_shared<std::vector<uint8_t>>();
+      if (path.empty() || !readFile(path, *bytes)) {
+        fail(-1, "Cannot read " + path);
+        return;
       }
-      auto vScale = arguments->find(flutter::EncodableValue("scale"));
-      auto scale =
-          vScale != arguments->end() ? std::get<double>(vScale->second) : 1;
-      auto vJob = arguments->find(flutter::EncodableValue("job"));
-      auto jobNum = vJob != arguments->end() ? std::get<int>(vJob->second) : -1;
-      auto job = std::make_unique<PrintJob>(&printing, jobNum);
-      job->rasterPdf(doc, pages, scale);
-      result->Success(nullptr);
-    } else if (method_call.method_name().compare("printingInfo") == 0) {
-      auto job = std::make_unique<PrintJob>(&printing, -1);
-      auto map = flutter::EncodableMap{};
-      for (auto item : job->printingInfo()) {
-        map[flutter::EncodableValue(item.first)] =
-            flutter::EncodableValue(item.second);
+      doc = bytes;
+    }
+
+    auto document = RasterFarm::Document::create(*doc);
+    if (!document) {
+      fail(-1, "Cannot share the document");
+      return;
+    }
+
+    std::string error;
+    if (workers.pageCount(document, error) < 0) {
+      fail(-1, error);
+      return;
+    }
+
+    for (auto page : pages) {
+      auto image = std::make_shared<OpenDocument::Image>();
+      if (!workers.render(document, page, scale, *image, error)) {
+        fail(page, error);
+        continue;
       }
-      result->Success(map);
+
+      owner->post([plugin, job, index, page, image] {
+        plugin->printing.onBatchRasterized(job, index, page,
+                                           std::move(image->pixels),
+                                           image->width, image->height, {});
+      });
+    }
+  }
+
+  static bool readFile(const std::string& path, std::vector<uint8_t>& bytes) {
+    std::ifstream in{fromUtf8(path), std::ios::in | std::ios::binary};
+    if (!in) {
+      return false;
+    }
+
+    in.seekg(0, std::ios::end);
+    auto size = in.tellg();
+    if (size <= 0) {
+      return false;
+    }
+
+    bytes.resize(static_cast<size_t>(size));
+    in.seekg(0, std::ios::beg);
+    in.read(reinterpret_cast<char*>(bytes.data()), size);
+    return static_cast<bool>(in);
+  }
+
+  // Answers with the document handle and the probe of the document.
+  void openDocument(const std::vector<uint8_t>& doc, Result result) {
+    std::string error;
+    auto document = OpenDocument::open(
+        std::make_shared<const std::vector<uint8_t>>(doc), error);
+    if (!document) {
+      result->Error("openDocument", error);
+      return;
+    }
+
+    auto handle = nextDocument++;
+    documents[handle] = document;
+
+    auto map = document->probe().toMap();
+    map[flutter::EncodableValue("handle")] = flutter::EncodableValue(handle);
+    result->Success(flutter::EncodableValue(map));
+  }
+
+  static flutter::EncodableValue encodePage(const OpenDocument::Image& image,
+                                            std::vector<uint8_t> text) {
+    TrackedBytes output{MemoryCategory::output, -1, image.pixels.size()};
+    auto map = flutter::EncodableMap{
+        {flutter::EncodableValue("image"), flutter::EncodableValue(image.pixels)},
+        {flutter::EncodableValue("width"), flutter::EncodableValue(image.width)},
+        {flutter::EncodableValue("height"),
+         flutter::EncodableValue(image.height)},
+    };
+    if (!text.empty()) {
+      map[flutter::EncodableValue("text")] =
+          flutter::EncodableValue(std::move(text));
+    }
+    return flutter::EncodableValue(map);
+  }
+
+  // Served from the prefetch cache when the page was predicted, otherwise
+  // rendered on the worker pool. The request carries only the handle.
+  void rasterPage(const RasterPageArgs& args, Result result) {
+    auto it = documents.find(args.handle);
+    if (it == documents.end()) {
+      result->Error("rasterPage", "Unknown document");
+      return;
+    }
+
+    auto document = it->second;
+
+    // Exactly the physical resolution of the page on screen.
+    auto scale = args.scale;
+    double pageWidth, pageHeight;
+    if (args.width > 0 && document->pageSize(args.page, pageWidth, pageHeight) &&
+        pageWidth > 0) {
+      scale = args.width * devicePixelRatio / pageWidth;
+    }
+
+    // The cache holds images only, a text layer is always extracted.
+    auto cached = args.textLayer
+                      ? nullptr
+                      : prefetcher->find(args.handle, args.page, scale);
+    prefetcher->access(args.handle, document, args.page, scale);
+
+    if (cached) {
+      result->Success(encodePage(*cached, {}));
+      return;
+    }
+
+    auto pending = std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>>(
+        std::move(result));
+
+    WorkerPool::shared().post([owner = owner, prefetcher = prefetcher,
+                               document, args, scale, pending] {
+      auto image = std::make_shared<OpenDocument::Image>();
+      auto text = std::make_shared<std::vector<uint8_t>>();
+      auto rendered = document->render(args.page, scale, *image,
+                                       args.textLayer ? text.get() : nullptr);
+      if (rendered) {
+        prefetcher->store(args.handle, args.page, scale, image);
+      }
+
+      owner->post([rendered, image, text, pending] {
+        if (!rendered) {
+          pending->Error("rasterPage", "Cannot raster this page");
+          return;
+        }
+        pending->Success(encodePage(*image, std::move(*text)));
+      });
+    });
+  }
+
+  // Renders the visible pages again at the new physical resolution. Pages
+  // already cached at a higher resolution are only downscaled.
+  void onDpiChanged(double ratio) {
+    if (ratio == devicePixelRatio) {
+      return;
+    }
+    devicePixelRatio = ratio;
+    printing.onDevicePixelRatioChanged(ratio);
+
+    for (auto& visible : visiblePages) {
+      auto it = documents.find(visible.first);
+      if (it == documents.end()) {
+        continue;
+      }
+
+      for (auto page : visible.second.pages) {
+        double pageWidth, pageHeight;
+        if (!it->second->pageSize(page, pageWidth, pageHeight) ||
+            pageWidth <= 0) {
+          continue;
+        }
+        rerenderPage(visible.first, it->second, page,
+                     visible.second.width * ratio / pageWidth);
+      }
+    }
+  }
+
+  // Renders on the worker pool, the plugin is only used by the task posted
+  // back through the owner.
+  void rerenderPage(int handle,
+                    std::shared_ptr<OpenDocument> document,
+                    int page,
+                    double scale) {
+    WorkerPool::shared().post([this, owner = owner, prefetcher = prefetcher,
+                               handle, document, page, scale] {
+      auto image = std::make_shared<OpenDocument::Image>();
+      auto cached = prefetcher->findAtLeast(handle, page, scale);
+      double pageWidth, pageHeight;
+
+      if (cached && document->pageSize(page, pageWidth, pageHeight)) {
+        PRINTING_TRACE_SCOPE("downscalePage", -1, page);
+        image->width = static_cast<int>(pageWidth * scale);
+        image->height = static_cast<int>(pageHeight * scale);
+        if (image->width > 0 && image->height > 0 &&
+            image->width <= cached->width && image->height <= cached->height) {
+          image->pixels.resize(static_cast<size_t>(image->width) * 4 *
+                               image->height);
+          downscaleImage(cached->pixels.data(), cached->width, cached->height,
+                         cached->width * 4, image->pixels.data(), image->width,
+                         image->height, image->width * 4);
+        } else {
+          cached = nullptr;
+        }
+      }
+
+      if (!cached && !document->render(page, scale, *image)) {
+        return;
+      }
+      prefetcher->store(handle, page, scale, image);
+
+      owner->post([this, handle, page, image] {
+        printing.onPageRerendered(handle, page, image->pixels, image->width,
+                                  image->height);
+      });
+    });
+  }
+
+  // Shows an open document, or a document given as bytes.
+  void createTexture(const Args& args, Result result) {
+    std::shared_ptr<OpenDocument> document;
+    auto it = documents.find(args.integer(Keys::handle, -1));
+    if (it != documents.end()) {
+      document = it->second;
     } else {
-      result->NotImplemented();
+      std::string error;
+      document = OpenDocument::open(
+          std::make_shared<const std::vector<uint8_t>>(args.bytes(Keys::doc)),
+          error);
+      if (!document) {
+        result->Error("createTexture", error);
+        return;
+      }
+    }
+
+    auto texture = std::make_shared<PageTexture>(textureRegistrar, document);
+    textures[texture->id()] = texture;
+    result->Success(flutter::EncodableValue(texture->id()));
+  }
+
+  // Renders on the worker pool and answers with the frame size, or null if
+  // the page cannot be rendered or a newer render was requested meanwhile.
+  void renderTexture(const RenderTextureArgs& args, Result result) {
+    auto it = textures.find(args.texture);
+    if (it == textures.end()) {
+      result->Error("renderTexture", "Unknown texture");
+      return;
+    }
+
+    auto texture = it->second;
+    auto request = texture->request();
+    auto pending = std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>>(
+        std::move(result));
+    auto page = args.page;
+    auto scale = args.scale;
+
+    WorkerPool::shared().post([owner = owner, texture, request, page, scale,
+                               pending] {
+      auto width = 0, height = 0;
+      auto rendered = texture->render(request, page, scale, width, height);
+
+      owner->post([rendered, width, height, pending] {
+        if (!rendered) {
+          pending->Success(nullptr);
+          return;
+        }
+        pending->Success(flutter::EncodableValue(flutter::EncodableMap{
+            {flutter::EncodableValue("width"), flutter::EncodableValue(width)},
+            {flutter::EncodableValue("height"), flutter::EncodableValue(height)},
+        }));
+      });
+    });
+  }
+
+  // Extracts and indexes the text on the worker pool, the index is stored
+  // and the result sent back on the platform thread. Tasks posted to the
+  // runner never run after the plugin is destroyed, only the worker side
+  // needs the owner.
+  void indexDocument(const IndexDocumentArgs& args, Result result) {
+    auto doc = std::make_shared<std::vector<uint8_t>>(args.doc);
+    auto pending = std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>>(
+        std::move(result));
+    auto documentId = args.documentId;
+    auto path = args.path;
+
+    WorkerPool::shared().post([this, owner = owner, doc, pending, documentId,
+                               path] {
+      std::shared_ptr<const TextIndex> index;
+      {
+        TrackedBytes copy{MemoryCategory::document, -1, doc->size()};
+        index = TextIndex::build(*doc, WorkerPool::shared());
+      }
+      auto saved = index && !path.empty() && index->save(path);
+
+      owner->post([this, index, pending, documentId, saved] {
+        if (!index) {
+          pending->Error("indexDocument", "Cannot index a malformed PDF file");
+          return;
+        }
+        textIndexes[documentId] = index;
+        pending->Success(flutter::EncodableValue(flutter::EncodableMap{
+            {flutter::EncodableValue("pages"),
+             flutter::EncodableValue(static_cast<int>(index->pageCount()))},
+            {flutter::EncodableValue("saved"), flutter::EncodableValue(saved)},
+        }));
+      });
+    });
+  }
+
+  void loadTextIndex(const IndexDocumentArgs& args, Result result) {
+    auto index = TextIndex::load(args.path, WorkerPool::shared());
+    if (!index) {
+      result->Success(flutter::EncodableValue(false));
+      return;
+    }
+    textIndexes[args.documentId] = index;
+    result->Success(flutter::EncodableValue(true));
+  }
+
+  void searchText(const SearchTextArgs& args, Result result) {
+    auto it = textIndexes.find(args.documentId);
+    if (it == textIndexes.end()) {
+      result->Error("searchText", "Document not indexed");
+      return;
+    }
+
+    auto hits = flutter::EncodableList{};
+    for (auto& hit : it->second->search(args.query, args.limit)) {
+      hits.push_back(flutter::EncodableValue(flutter::EncodableMap{
+          {flutter::EncodableValue("page"), flutter::EncodableValue(hit.page)},
+          {flutter::EncodableValue("start"), flutter::EncodableValue(hit.start)},
+          {flutter::EncodableValue("length"),
+           flutter::EncodableValue(hit.length)},
+          {flutter::EncodableValue("left"),
+           flutter::EncodableValue(static_cast<double>(hit.left))},
+          {flutter::EncodableValue("top"),
+           flutter::EncodableValue(static_cast<double>(hit.top))},
+          {flutter::EncodableValue("right"),
+           flutter::EncodableValue(static_cast<double>(hit.right))},
+          {flutter::EncodableValue("bottom"),
+           flutter::EncodableValue(static_cast<double>(hit.bottom))},
+      }));
+    }
+    result->Success(flutter::EncodableValue(hits));
+  }
+
+  void printingInfo(Result result) {
+    auto map = flutter::EncodableMap{};
+    for (auto item : PrintJob::printingInfo()) {
+      map[flutter::EncodableValue(item.first)] =
+          flutter::EncodableValue(item.second);
     }
+    result->Success(map);
   }
 };
 //}
@@ -151,7 +828,7 @@ class PrintingPlugin : public flutter::Plugin {
 void PrintingPluginRegisterWithRegistrar(
     FlutterDesktopPluginRegistrarRef registrar) {
 
-  printing::PrintingPlugin::RegisterWithRegistrar(
+  PrintingPlugin::RegisterWithRegistrar(
       flutter::PluginRegistrarManager::GetInstance()
           ->GetRegistrar<flutter::PluginRegistrarWindows>(registrar));
 }
\ No newline at end of file
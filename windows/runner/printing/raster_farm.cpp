@@ -0,0 +1,359 @@
+#include "raster_farm.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cwchar>
+
+#include "memory_stats.h"
+#include "trace.h"
+
+// Time for a worker to start and connect, and to answer one request.
+static const DWORD startTimeout = 10000;
+static const DWORD requestTimeout = 60000;
+
+// Largest page a worker may ask the host to map, 8192 x 16384 RGBA pixels.
+static const uint64_t maxOutputSize = 512ull * 1024 * 1024;
+
+static std::atomic<uint64_t> nextId{1};
+
+// Unique to this process, the workers open objects by name.
+static std::wstring uniqueName(const wchar_t* prefix, uint64_t id) {
+  return std::wstring{prefix} + std::to_wstring(GetCurrentProcessId()) + L"-" +
+         std::to_wstring(id);
+}
+
+static void copyName(wchar_t (&target)[64], const std::wstring& name) {
+  wcsncpy_s(target, name.c_str(), _TRUNCATE);
+}
+
+static HANDLE createMapping(const std::wstring& name, uint64_t size) {
+  return CreateFileMapping(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                           static_cast<DWORD>(size >> 32),
+                           static_cast<DWORD>(size & 0xffffffff), name.c_str());
+}
+
+std::shared_ptr<RasterFarm::Document> RasterFarm::Document::create(
+    const std::vector<uint8_t>& bytes) {
+  auto document = std::shared_ptr<Document>(new Document());
+  document->id = nextId++;
+  document->name = uniqueName(L"Local\\printing-document-", document->id);
+  document->size = bytes.size();
+  document->mapping =
+      createMapping(document->name, std::max<size_t>(bytes.size(), 1));
+  if (!document->mapping) {
+    return nullptr;
+  }
+
+  auto view = MapViewOfFile(document->mapping, FILE_MAP_WRITE, 0, 0, 0);
+  if (!view) {
+    return nullptr;
+  }
+  CopyMemory(view, bytes.data(), bytes.size());
+  UnmapViewOfFile(view);
+  return document;
+}
+
+RasterFarm::Document::~Document() {
+  if (mapping) {
+    CloseHandle(mapping);
+  }
+}
+
+RasterFarm::RasterFarm(size_t count) : workers(std::max<size_t>(count, 1)) {}
+
+RasterFarm::~RasterFarm() {
+  std::lock_guard<std::mutex> lock{mutex};
+  for (auto& worker : workers) {
+    stop(worker);
+  }
+}
+
+void RasterFarm::warmUp() {
+  std::vector<Worker*> started;
+  for (auto i = workers.size(); i > 0; i--) {
+    auto worker = acquire();
+    if (worker) {
+      started.push_back(worker);
+    }
+  }
+  for (auto worker : started) {
+    release(worker);
+  }
+}
+
+int RasterFarm::pageCount(const std::shared_ptr<Document>& document,
+                          std::string& error) {
+  auto worker = acquire();
+  if (!worker) {
+    error = "Cannot start a raster worker";
+    return -1;
+  }
+
+  RasterRequest request{};
+  request.command = RasterCommand::pageCount;
+  request.document = document->id;
+  request.documentSize = document->size;
+  copyName(request.documentMapping, document->name);
+
+  RasterReply reply;
+  auto count = -1;
+  if (!exchange(*worker, request, reply, requestTimeout)) {
+    error = "The raster worker stopped";
+    stop(*worker);
+  } else if (reply.status != RasterStatus::ok) {
+    error = "Cannot raster a malformed PDF file";
+  } else {
+    count = reply.pageCount;
+  }
+
+  release(worker);
+  return count;
+}
+
+bool RasterFarm::render(const std::shared_ptr<Document>& document,
+                        int page,
+                        double scale,
+                        OpenDocument::Image& image,
+                        std::string& error) {
+  PRINTING_TRACE_SCOPE("farmRender", -1, page);
+  auto worker = acquire();
+  if (!worker) {
+    error = "Cannot start a raster worker";
+    return false;
+  }
+
+  RasterRequest request{};
+  request.command = RasterCommand::render;
+  request.page = page;
+  request.scale = scale;
+  request.document = document->id;
+  request.documentSize = document->size;
+  copyName(request.documentMapping, document->name);
+
+  // Asked again with a larger output if the page did not fit.
+  RasterReply reply{};
+  for (auto attempt = 0; attempt < 2; attempt++) {
+    request.outputSize = worker->outputSize;
+    copyName(request.outputMapping, worker->outputName);
+
+    if (!exchange(*worker, request, reply, requestTimeout)) {
+      // Crashed or stuck on this page, the next request gets a new worker.
+      stop(*worker);
+      release(worker);
+      error = "The raster worker stopped";
+      return false;
+    }
+
+    if (reply.status != RasterStatus::outputTooSmall ||
+        reply.size > maxOutputSize || !reserveOutput(*worker, reply.size)) {
+      break;
+    }
+  }
+
+  // The reply comes from another process, which may be corrupted. Nothing
+  // is read outside of the mapping.
+  if (reply.status == RasterStatus::ok &&
+      (reply.width <= 0 || reply.height <= 0 ||
+       reply.size != static_cast<uint64_t>(reply.width) * reply.height * 4 ||
+       reply.size > worker->outputSize)) {
+    stop(*worker);
+    release(worker);
+    error = "The raster worker sent an invalid page";
+    return false;
+  }
+
+  auto rendered = reply.status == RasterStatus::ok;
+  if (rendered) {
+    auto pixels = static_cast<const uint8_t*>(worker->view);
+    image.width = reply.width;
+    image.height = reply.height;
+    image.pixels.assign(pixels, pixels + reply.size);
+  } else {
+    error = reply.status == RasterStatus::badDocument
+                ? "Cannot raster a malformed PDF file"
+                : "Cannot raster this page";
+  }
+
+  release(worker);
+  return rendered;
+}
+
+RasterFarm::Worker* RasterFarm::acquire() {
+  Worker* worker = nullptr;
+  {
+    std::unique_lock<std::mutex> lock{mutex};
+    idle.wait(lock, [this, &worker] {
+      for (auto& candidate : workers) {
+        if (!candidate.busy) {
+          worker = &candidate;
+          return true;
+        }
+      }
+      return false;
+    });
+    worker->busy = true;
+  }
+
+  // Started outside of the lock, other workers stay usable meanwhile.
+  if (!worker->process && !start(*worker)) {
+    release(worker);
+    return nullptr;
+  }
+  return worker;
+}
+
+void RasterFarm::release(Worker* worker) {
+  {
+    std::lock_guard<std::mutex> lock{mutex};
+    worker->busy = false;
+  }
+  idle.notify_one();
+}
+
+bool RasterFarm::start(Worker& worker) {
+  PRINTING_TRACE_SCOPE("startRasterWorker", -1, -1);
+  auto pipeName = uniqueName(L"\\\\.\\pipe\\printing-raster-", nextId++);
+  worker.pipe = CreateNamedPipe(
+      pipeName.c_str(), PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED,
+      PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_WAIT, 1,
+      sizeof(RasterRequest), sizeof(RasterReply), 0, nullptr);
+  if (worker.pipe == INVALID_HANDLE_VALUE) {
+    worker.pipe = nullptr;
+    return false;
+  }
+  worker.event = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+
+  wchar_t path[MAX_PATH];
+  GetModuleFileName(nullptr, path, MAX_PATH);
+  auto commandLine = std::wstring{L"\""} + path + L"\" " +
+                     rasterWorkerArgument + L" " + pipeName;
+
+  STARTUPINFO startup;
+  ZeroMemory(&startup, sizeof(startup));
+  startup.cb = sizeof(startup);
+  PROCESS_INFORMATION info;
+  if (!CreateProcess(path, &commandLine[0], nullptr, nullptr, FALSE,
+                     CREATE_NO_WINDOW, nullptr, nullptr, &startup, &info)) {
+    stop(worker);
+    return false;
+  }
+  CloseHandle(info.hThread);
+  worker.process = info.hProcess;
+
+  OVERLAPPED overlapped;
+  ZeroMemory(&overlapped, sizeof(overlapped));
+  overlapped.hEvent = worker.event;
+  if (!ConnectNamedPipe(worker.pipe, &overlapped)) {
+    auto connected = GetLastError() == ERROR_PIPE_CONNECTED;
+    if (!connected && GetLastError() == ERROR_IO_PENDING) {
+      HANDLE handles[] = {worker.event, worker.process};
+      DWORD count;
+      connected =
+          WaitForMultipleObjects(2, handles, FALSE, startTimeout) ==
+              WAIT_OBJECT_0 &&
+          GetOverlappedResult(worker.pipe, &overlapped, &count, FALSE);
+    }
+    if (!connected) {
+      stop(worker);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void RasterFarm::stop(Worker& worker) {
+  if (worker.pipe) {
+    CancelIo(worker.pipe);
+    CloseHandle(worker.pipe);
+    worker.pipe = nullptr;
+  }
+  if (worker.process) {
+    // A healthy worker exits once its pipe is closed.
+    if (WaitForSingleObject(worker.process, 1000) != WAIT_OBJECT_0) {
+      TerminateProcess(worker.process, EXIT_FAILURE);
+    }
+    CloseHandle(worker.process);
+    worker.process = nullptr;
+  }
+  if (worker.event) {
+    CloseHandle(worker.event);
+    worker.event = nullptr;
+  }
+  reserveOutput(worker, 0);
+}
+
+bool RasterFarm::exchange(Worker& worker,
+                          const RasterRequest& request,
+                          RasterReply& reply,
+                          DWORD timeout) {
+  // Each transfer ends when the event is set, or fails if the worker exits
+  // first.
+  auto transfer = [&worker, timeout](bool write, void* data, DWORD size) {
+    OVERLAPPED overlapped;
+    ZeroMemory(&overlapped, sizeof(overlapped));
+    overlapped.hEvent = worker.event;
+    ResetEvent(worker.event);
+
+    auto done = write ? WriteFile(worker.pipe, data, size, nullptr, &overlapped)
+                      : ReadFile(worker.pipe, data, size, nullptr, &overlapped);
+    if (!done && GetLastError() != ERROR_IO_PENDING) {
+      return false;
+    }
+
+    DWORD count;
+    HANDLE handles[] = {worker.event, worker.process};
+    if (WaitForMultipleObjects(2, handles, FALSE, timeout) != WAIT_OBJECT_0) {
+      // The cancelled transfer still owns overlapped and data until it
+      // completes. The caller then stops the worker.
+      CancelIo(worker.pipe);
+      GetOverlappedResult(worker.pipe, &overlapped, &count, TRUE);
+      return false;
+    }
+
+    return GetOverlappedResult(worker.pipe, &overlapped, &count, FALSE) &&
+           count == size;
+  };
+
+  auto message = request;
+  return transfer(true, &message, sizeof(message)) &&
+         transfer(false, &reply, sizeof(reply));
+}
+
+bool RasterFarm::reserveOutput(Worker& worker, uint64_t size) {
+  if (worker.view) {
+    UnmapViewOfFile(worker.view);
+    MemoryStats::release(MemoryCategory::bitmap, -1,
+                         static_cast<size_t>(worker.outputSize));
+    worker.view = nullptr;
+  }
+  if (worker.output) {
+    CloseHandle(worker.output);
+    worker.output = nullptr;
+  }
+  worker.outputSize = 0;
+  worker.outputName.clear();
+
+  if (size == 0) {
+    return false;
+  }
+
+  // A new name each time, the worker keeps its view of the previous one
+  // until it is asked for this one.
+  auto name = uniqueName(L"Local\\printing-output-", nextId++);
+  worker.output = createMapping(name, size);
+  if (!worker.output) {
+    return false;
+  }
+  worker.view = MapViewOfFile(worker.output, FILE_MAP_READ, 0, 0, 0);
+  if (!worker.view) {
+    CloseHandle(worker.output);
+    worker.output = nullptr;
+    return false;
+  }
+
+  MemoryStats::allocate(MemoryCategory::bitmap, -1, static_cast<size_t>(size));
+  worker.outputSize = size;
+  worker.outputName = name;
+  return true;
+}
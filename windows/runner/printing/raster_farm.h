@@ -0,0 +1,111 @@
+#ifndef PRINTING_PLUGIN_RASTER_FARM_H_
+#define PRINTING_PLUGIN_RASTER_FARM_H_
+
+#include <windows.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "open_document.h"
+#include "raster_worker.h"
+
+// Helper processes rendering pages, each with its own PDFium, so that the
+// pages of one document render on several cores and a document crashing
+// PDFium only takes a worker down. A worker is this executable started
+// with --raster-worker, fed over a named pipe. Documents and pages go
+// through shared memory, the pipe only carries small fixed-size messages.
+// A worker that crashes or hangs is stopped and started again on the next
+// request. All functions are thread-safe.
+class RasterFarm {
+ public:
+  // A document copied once into shared memory, which every worker parses
+  // in place.
+  class Document {
+   public:
+    // Returns nullptr if the shared memory cannot be allocated.
+    static std::shared_ptr<Document> create(const std::vector<uint8_t>& bytes);
+
+    ~Document();
+
+    Document(const Document&) = delete;
+    Document& operator=(const Document&) = delete;
+
+   private:
+    Document() = default;
+
+    friend class RasterFarm;
+    HANDLE mapping = nullptr;
+    std::wstring name;
+    uint64_t id = 0;
+    uint64_t size = 0;
+  };
+
+  explicit RasterFarm(size_t workers);
+
+  // Stops the workers.
+  ~RasterFarm();
+
+  RasterFarm(const RasterFarm&) = delete;
+  RasterFarm& operator=(const RasterFarm&) = delete;
+
+  size_t size() const { return workers.size(); }
+
+  // Starts the workers not running yet, so that the first pages do not
+  // wait for processes to start and load PDFium. Blocks until they are
+  // connected.
+  void warmUp();
+
+  // Returns -1 and sets error if no worker can load document.
+  int pageCount(const std::shared_ptr<Document>& document, std::string& error);
+
+  // Renders page of document at scale on the first idle worker, waiting for
+  // one if they are all busy. Returns false and sets error if the page
+  // cannot be rendered or the worker stopped.
+  bool render(const std::shared_ptr<Document>& document,
+              int page,
+              double scale,
+              OpenDocument::Image& image,
+              std::string& error);
+
+ private:
+  struct Worker {
+    HANDLE process = nullptr;
+    HANDLE pipe = nullptr;
+    HANDLE event = nullptr;  // completion of the pipe operations
+    HANDLE output = nullptr;
+    void* view = nullptr;
+    uint64_t outputSize = 0;
+    std::wstring outputName;
+    bool busy = false;
+  };
+
+  // Waits for an idle worker, started if it was not running.
+  // Returns nullptr if it cannot be started.
+  Worker* acquire();
+
+  void release(Worker* worker);
+
+  bool start(Worker& worker);
+
+  void stop(Worker& worker);
+
+  // Sends request and waits for the reply. False if the worker crashed,
+  // closed the pipe or did not answer in time.
+  bool exchange(Worker& worker,
+                const RasterRequest& request,
+                RasterReply& reply,
+                DWORD timeout);
+
+  // Replaces the output mapping of worker with one of at least size bytes.
+  bool reserveOutput(Worker& worker, uint64_t size);
+
+  std::vector<Worker> workers;
+  std::mutex mutex;
+  std::condition_variable idle;
+};
+
+#endif
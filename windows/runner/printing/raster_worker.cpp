@@ -0,0 +1,192 @@
+#include "raster_worker.h"
+
+#include <windows.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cwchar>
+
+#include "pdfium.h"
+#include "pdfview.h"
+
+const wchar_t* const rasterWorkerArgument = L"--raster-worker";
+
+bool isRasterWorker(const wchar_t* commandLine, std::wstring& pipeName) {
+  if (!commandLine) {
+    return false;
+  }
+
+  auto length = wcslen(rasterWorkerArgument);
+  while (*commandLine == L' ') {
+    commandLine++;
+  }
+  if (wcsncmp(commandLine, rasterWorkerArgument, length) != 0) {
+    return false;
+  }
+
+  pipeName = commandLine + length;
+  pipeName.erase(0, pipeName.find_first_not_of(L' '));
+  pipeName.erase(pipeName.find_last_not_of(L' ') + 1);
+  return !pipeName.empty();
+}
+
+// A named mapping opened by the worker, kept until another name is asked.
+class MappedView {
+ public:
+  ~MappedView() { close(); }
+
+  bool open(const wchar_t* mappingName, DWORD access) {
+    if (view && name == mappingName) {
+      return true;
+    }
+
+    close();
+    mapping = OpenFileMapping(access, FALSE, mappingName);
+    if (!mapping) {
+      return false;
+    }
+    view = MapViewOfFile(mapping, access, 0, 0, 0);
+    if (!view) {
+      close();
+      return false;
+    }
+    name = mappingName;
+    return true;
+  }
+
+  void close() {
+    if (view) {
+      UnmapViewOfFile(view);
+      view = nullptr;
+    }
+    if (mapping) {
+      CloseHandle(mapping);
+      mapping = nullptr;
+    }
+    name.clear();
+  }
+
+  void* data() const { return view; }
+
+ private:
+  HANDLE mapping = nullptr;
+  void* view = nullptr;
+  std::wstring name;
+};
+
+// A worker process is single threaded and owns its PDFium, the PDFium lock
+// is not needed here.
+class RasterWorker {
+ public:
+  ~RasterWorker() { closeDocument(); }
+
+  RasterReply handle(const RasterRequest& request) {
+    RasterReply reply{};
+    if (!load(request)) {
+      reply.status = RasterStatus::badDocument;
+      return reply;
+    }
+
+    reply.pageCount = FPDF_GetPageCount(doc);
+    if (request.command == RasterCommand::pageCount) {
+      reply.status = RasterStatus::ok;
+      return reply;
+    }
+
+    auto page = FPDF_LoadPage(doc, request.page);
+    if (!page) {
+      reply.status = RasterStatus::badPage;
+      return reply;
+    }
+
+    reply.width = static_cast<int32_t>(FPDF_GetPageWidth(page) * request.scale);
+    reply.height =
+        static_cast<int32_t>(FPDF_GetPageHeight(page) * request.scale);
+    reply.size = static_cast<uint64_t>(reply.width) * 4 * reply.height;
+
+    if (reply.width <= 0 || reply.height <= 0) {
+      reply.status = RasterStatus::badPage;
+    } else if (reply.size > request.outputSize ||
+               !output.open(request.outputMapping, FILE_MAP_WRITE)) {
+      reply.status = RasterStatus::outputTooSmall;
+    } else {
+      // Rendered straight into the memory the plugin reads.
+      auto pixels = static_cast<uint8_t*>(output.data());
+      auto bitmap = FPDFBitmap_CreateEx(reply.width, reply.height,
+                                        FPDFBitmap_BGRA, pixels,
+                                        reply.width * 4);
+      FPDFBitmap_FillRect(bitmap, 0, 0, reply.width, reply.height, 0xffffffff);
+      FPDF_RenderPageBitmap(bitmap, page, 0, 0, reply.width, reply.height, 0,
+                            FPDF_ANNOT | FPDF_LCD_TEXT);
+      FPDFBitmap_Destroy(bitmap);
+
+      // BGRA to RGBA conversion
+      for (uint64_t offset = 0; offset < reply.size; offset += 4) {
+        std::swap(pixels[offset], pixels[offset + 2]);
+      }
+      reply.status = RasterStatus::ok;
+    }
+
+    FPDF_ClosePage(page);
+    return reply;
+  }
+
+ private:
+  bool load(const RasterRequest& request) {
+    if (doc && document == request.document) {
+      return true;
+    }
+
+    closeDocument();
+    if (!source.open(request.documentMapping, FILE_MAP_READ)) {
+      return false;
+    }
+
+    // Parsed in place, the document is never copied into the worker.
+    doc = FPDF_LoadMemDocument64(source.data(), request.documentSize, nullptr);
+    document = request.document;
+    return doc != nullptr;
+  }
+
+  void closeDocument() {
+    if (doc) {
+      FPDF_CloseDocument(doc);
+      doc = nullptr;
+    }
+    source.close();
+  }
+
+  PdfiumLibrary library;
+  MappedView source;
+  MappedView output;
+  FPDF_DOCUMENT doc = nullptr;
+  uint64_t document = 0;
+};
+
+int runRasterWorker(const std::wstring& pipeName) {
+  auto pipe = CreateFile(pipeName.c_str(), GENERIC_READ | GENERIC_WRITE, 0,
+                         nullptr, OPEN_EXISTING, 0, nullptr);
+  if (pipe == INVALID_HANDLE_VALUE) {
+    return EXIT_FAILURE;
+  }
+
+  DWORD mode = PIPE_READMODE_MESSAGE;
+  SetNamedPipeHandleState(pipe, &mode, nullptr, nullptr);
+
+  {
+    RasterWorker worker;
+    RasterRequest request;
+    DWORD count;
+    // The plugin closes the pipe to stop the worker.
+    while (ReadFile(pipe, &request, sizeof(request), &count, nullptr) &&
+           count == sizeof(request)) {
+      auto reply = worker.handle(request);
+      if (!WriteFile(pipe, &reply, sizeof(reply), &count, nullptr)) {
+        break;
+      }
+    }
+  }
+
+  CloseHandle(pipe);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,55 @@
+#ifndef PRINTING_PLUGIN_RASTER_WORKER_H_
+#define PRINTING_PLUGIN_RASTER_WORKER_H_
+
+#include <cstdint>
+#include <string>
+
+// The protocol between RasterFarm and its worker processes: one request
+// and one reply per pipe message, in the same process image so both sides
+// share the layout. Bytes never go through the pipe, documents and pages
+// are in named shared memory.
+
+enum class RasterCommand : int32_t {
+  pageCount,
+  render,
+};
+
+enum class RasterStatus : int32_t {
+  ok,
+  badDocument,  // the document mapping cannot be opened or loaded
+  badPage,      // the page cannot be loaded or rendered
+  outputTooSmall,
+};
+
+struct RasterRequest {
+  RasterCommand command;
+  int32_t page;
+  double scale;
+  // Changes with the document, the worker keeps the last one loaded.
+  uint64_t document;
+  uint64_t documentSize;
+  uint64_t outputSize;
+  wchar_t documentMapping[64];
+  wchar_t outputMapping[64];
+};
+
+struct RasterReply {
+  RasterStatus status;
+  int32_t pageCount;
+  int32_t width;
+  int32_t height;
+  uint64_t size;  // RGBA bytes written, or needed if outputTooSmall
+};
+
+// Argument that starts the executable as a raster worker instead of the
+// application, followed by the name of the pipe to connect to.
+extern const wchar_t* const rasterWorkerArgument;
+
+// Returns true and sets pipeName if commandLine starts a raster worker.
+bool isRasterWorker(const wchar_t* commandLine, std::wstring& pipeName);
+
+// Serves requests from the pipe until it is closed, then returns the exit
+// code of the process.
+int runRasterWorker(const std::wstring& pipeName);
+
+#endif
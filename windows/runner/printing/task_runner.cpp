@@ -0,0 +1,55 @@
+#include "task_runner.h"
+
+static const auto taskMessage = WM_APP + 1;
+static const auto windowClass = TEXT("PrintingTaskRunner");
+
+TaskRunner::TaskRunner() {
+  WNDCLASSEX wc;
+  ZeroMemory(&wc, sizeof(wc));
+  wc.cbSize = sizeof(wc);
+  wc.lpfnWndProc = wndProc;
+  wc.hInstance = GetModuleHandle(nullptr);
+  wc.lpszClassName = windowClass;
+  RegisterClassEx(&wc);
+
+  window = CreateWindowEx(0, windowClass, TEXT(""), 0, 0, 0, 0, 0,
+                          HWND_MESSAGE, nullptr, wc.hInstance, this);
+}
+
+TaskRunner::~TaskRunner() {
+  if (window) {
+    DestroyWindow(window);
+  }
+}
+
+void TaskRunner::post(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock{mutex};
+    tasks.push_back(std::move(task));
+  }
+  PostMessage(window, taskMessage, 0, reinterpret_cast<LPARAM>(this));
+}
+
+LRESULT CALLBACK TaskRunner::wndProc(HWND hwnd,
+                                     UINT message,
+                                     WPARAM wparam,
+                                     LPARAM lparam) {
+  if (message == taskMessage) {
+    reinterpret_cast<TaskRunner*>(lparam)->runTasks();
+    return 0;
+  }
+
+  return DefWindowProc(hwnd, message, wparam, lparam);
+}
+
+void TaskRunner::runTasks() {
+  std::deque<std::function<void()>> pending;
+  {
+    std::lock_guard<std::mutex> lock{mutex};
+    pending.swap(tasks);
+  }
+
+  for (auto& task : pending) {
+    task();
+  }
+}
@@ -0,0 +1,34 @@
+#ifndef PRINTING_PLUGIN_TASK_RUNNER_H_
+#define PRINTING_PLUGIN_TASK_RUNNER_H_
+
+#include <windows.h>
+
+#include <deque>
+#include <functional>
+#include <mutex>
+
+// Runs tasks posted from any thread on the platform thread, where the
+// printing channel may be used.
+// Must be created on the platform thread.
+class TaskRunner {
+ public:
+  TaskRunner();
+
+  virtual ~TaskRunner();
+
+  void post(std::function<void()> task);
+
+ private:
+  static LRESULT CALLBACK wndProc(HWND hwnd,
+                                  UINT message,
+                                  WPARAM wparam,
+                                  LPARAM lparam);
+
+  void runTasks();
+
+  HWND window = nullptr;
+  std::mutex mutex;
+  std::deque<std::function<void()>> tasks;
+};
+
+#endif
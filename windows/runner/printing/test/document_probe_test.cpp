@@ -0,0 +1,60 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "document_probe.h"
+#include "test_util.h"
+
+static void readsSizesAndPreferences() {
+  auto data = makePdf({{612, 792, "1"},
+                       {842, 595, "2"},
+                       {300, 400, "3"},
+                       {612, 792, "4"}},
+                      "/ViewerPreferences << /PrintScaling /None "
+                      "/NumCopies 3 /Duplex /DuplexFlipLongEdge "
+                      "/PrintPageRange [1 2 4 3 3 4 2 9] >>");
+
+  DocumentProbe probe;
+  std::string error;
+  EXPECT(DocumentProbe::probe(data, probe, error));
+  EXPECT(error.empty());
+
+  EXPECT(probe.pageCount == 4);
+  EXPECT(probe.sizes ==
+         (std::vector<double>{612, 792, 842, 595, 300, 400, 612, 792}));
+  EXPECT(probe.fileVersion == 17);
+  EXPECT(!probe.printScaling);
+  EXPECT(probe.numCopies == 3);
+  EXPECT(probe.duplex == DuplexFlipLongEdge);
+
+  // Zero-based, the reversed pair and the pair past the last page dropped.
+  EXPECT(probe.printPageRange == (std::vector<int32_t>{0, 1, 2, 3}));
+}
+
+static void defaultsWithoutPreferences() {
+  DocumentProbe probe;
+  std::string error;
+  EXPECT(DocumentProbe::probe(makePdf({{612, 792, "1"}}), probe, error));
+
+  EXPECT(probe.pageCount == 1);
+  EXPECT(probe.printScaling);
+  EXPECT(probe.numCopies == 1);
+  EXPECT(probe.duplex == DuplexUndefined);
+  EXPECT(probe.printPageRange.empty());
+}
+
+static void rejectsMalformedFiles() {
+  std::string text = "not a pdf file";
+  DocumentProbe probe;
+  std::string error;
+  EXPECT(!DocumentProbe::probe(std::vector<uint8_t>(text.begin(), text.end()),
+                               probe, error));
+  EXPECT(error == "Cannot probe a malformed PDF file");
+}
+
+int main() {
+  readsSizesAndPreferences();
+  defaultsWithoutPreferences();
+  rejectsMalformedFiles();
+  return testFailures();
+}
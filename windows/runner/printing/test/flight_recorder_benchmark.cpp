@@ -0,0 +1,73 @@
+// Cost of FlightRecorder::record, which stays on in release builds: from
+// one thread, then from every core at once writing into the same ring.
+//
+// flight_recorder_benchmark [records per thread]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "flight_recorder.h"
+#include "test_util.h"
+
+static void recordMany(int thread, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    FlightRecorder::record(FlightEvent::pageRendered, thread,
+                           static_cast<int>(i));
+  }
+}
+
+static void report(const char* name,
+                   size_t threads,
+                   size_t records,
+                   std::chrono::steady_clock::time_point start) {
+  auto ns = std::chrono::duration<double, std::nano>(
+                std::chrono::steady_clock::now() - start)
+                .count();
+  // Per thread, each one records its share in the elapsed time.
+  std::printf("%-16s %2zu threads  %10zu records  %8.2f ns/record\n", name,
+              threads, records, ns * threads / records);
+}
+
+int main(int argc, char* argv[]) {
+  size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000000;
+  if (count == 0) {
+    return 1;
+  }
+
+  // Every slot of the ring written once before the clock starts.
+  recordMany(0, 1 << 12);
+
+  auto start = std::chrono::steady_clock::now();
+  recordMany(0, count);
+  report("single-threaded", 1, count, start);
+
+  auto threads = std::max<size_t>(std::thread::hardware_concurrency(), 2);
+  std::atomic<size_t> ready{0};
+  std::atomic<bool> go{false};
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; t++) {
+    workers.emplace_back([&, t] {
+      ready++;
+      while (!go) {
+        std::this_thread::yield();
+      }
+      recordMany(static_cast<int>(t), count);
+    });
+  }
+  while (ready < threads) {
+    std::this_thread::yield();
+  }
+
+  start = std::chrono::steady_clock::now();
+  go = true;
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  report("contended", threads, count * threads, start);
+  return 0;
+}
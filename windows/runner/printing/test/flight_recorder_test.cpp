@@ -0,0 +1,117 @@
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "flight_recorder.h"
+#include "test_util.h"
+
+static const size_t capacity = 1 << 12;
+
+// The packed records of toMap: time, job, page and event for each.
+static std::vector<int64_t> records() {
+  auto map = FlightRecorder::toMap();
+  return std::get<std::vector<int64_t>>(
+      map[flutter::EncodableValue("records")]);
+}
+
+static void recordsInOrder() {
+  FlightRecorder::record(FlightEvent::enqueue, 7);
+  FlightRecorder::record(FlightEvent::start, 7);
+  FlightRecorder::record(FlightEvent::pageRendered, 7, 0);
+  FlightRecorder::record(FlightEvent::pageSent, 7, 0);
+  FlightRecorder::record(FlightEvent::completed, 7);
+
+  auto packed = records();
+  EXPECT(packed.size() == 5 * 4);
+  if (packed.size() != 5 * 4) {
+    return;
+  }
+
+  int64_t expected[] = {
+      static_cast<int64_t>(FlightEvent::enqueue),
+      static_cast<int64_t>(FlightEvent::start),
+      static_cast<int64_t>(FlightEvent::pageRendered),
+      static_cast<int64_t>(FlightEvent::pageSent),
+      static_cast<int64_t>(FlightEvent::completed),
+  };
+  for (size_t i = 0; i < 5; i++) {
+    EXPECT(packed[i * 4 + 1] == 7);
+    EXPECT(packed[i * 4 + 3] == expected[i]);
+    EXPECT(i == 0 || packed[i * 4] >= packed[(i - 1) * 4]);
+  }
+  EXPECT(packed[2 * 4 + 2] == 0);
+  EXPECT(packed[4 * 4 + 2] == -1);
+}
+
+static void keepsTheLatestRecords() {
+  for (size_t i = 0; i < capacity + 100; i++) {
+    FlightRecorder::record(FlightEvent::pageSent, 1, static_cast<int>(i));
+  }
+
+  auto packed = records();
+  EXPECT(packed.size() == capacity * 4);
+  if (packed.size() != capacity * 4) {
+    return;
+  }
+  EXPECT(packed[2] == 100);
+  EXPECT(packed[packed.size() - 2] == static_cast<int64_t>(capacity + 99));
+}
+
+static void recordsFromSeveralThreads() {
+  const auto threads = 4;
+  const auto perThread = 10000;
+
+  std::vector<std::thread> writers;
+  for (auto t = 0; t < threads; t++) {
+    writers.emplace_back([t] {
+      for (auto i = 0; i < perThread; i++) {
+        FlightRecorder::record(FlightEvent::pageRendered, t, i);
+      }
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+
+  // Records of each writer come out in the order it wrote them.
+  auto packed = records();
+  EXPECT(packed.size() == capacity * 4);
+  std::vector<int64_t> lastPage(threads, -1);
+  for (size_t i = 0; i < packed.size(); i += 4) {
+    auto job = packed[i + 1];
+    EXPECT(job >= 0 && job < threads);
+    EXPECT(packed[i + 3] == static_cast<int64_t>(FlightEvent::pageRendered));
+    if (job >= 0 && job < threads) {
+      EXPECT(packed[i + 2] > lastPage[job]);
+      lastPage[job] = packed[i + 2];
+    }
+  }
+}
+
+static void exportsCsv() {
+  auto path = tempPath("flight_recorder_test.csv");
+  EXPECT(FlightRecorder::exportTo(path));
+
+  std::ifstream in{path};
+  std::string line;
+  std::getline(in, line);
+  EXPECT(line == "time_ns,job,page,event");
+  size_t lines = 0;
+  while (std::getline(in, line)) {
+    lines++;
+  }
+  EXPECT(lines == capacity);
+  in.close();
+  DeleteFileA(path.c_str());
+}
+
+int main() {
+  // Each test relies on the records left by the previous ones.
+  recordsInOrder();
+  keepsTheLatestRecords();
+  recordsFromSeveralThreads();
+  exportsCsv();
+  return testFailures();
+}
@@ -0,0 +1,104 @@
+// Time to the page sizes of a long document: probeDocument, which reads them
+// from the page tree, against loading every page as a full raster does
+// before it can lay out a preview.
+//
+// probe_benchmark [file.pdf]
+// A generated document of 2000 pages of mixed sizes is used if no file is
+// given.
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "document_probe.h"
+#include "pdfium.h"
+#include "test_util.h"
+
+static const int generatedPages = 2000;
+
+static const int runs = 5;
+
+// Page sizes by loading each page, the way the raster path finds them.
+static bool loadPages(const std::vector<uint8_t>& data,
+                      std::vector<double>& sizes) {
+  PdfiumLock lock{pdfiumMutex()};
+  auto doc = FPDF_LoadMemDocument64(data.data(), data.size(), nullptr);
+  if (!doc) {
+    return false;
+  }
+
+  auto pages = FPDF_GetPageCount(doc);
+  sizes.clear();
+  for (auto i = 0; i < pages; i++) {
+    auto page = FPDF_LoadPage(doc, i);
+    if (!page) {
+      FPDF_CloseDocument(doc);
+      return false;
+    }
+    sizes.push_back(FPDF_GetPageWidth(page));
+    sizes.push_back(FPDF_GetPageHeight(page));
+    FPDF_ClosePage(page);
+  }
+  FPDF_CloseDocument(doc);
+  return true;
+}
+
+static void report(const char* name,
+                   size_t pages,
+                   std::chrono::steady_clock::time_point start) {
+  auto ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start)
+                .count() /
+            runs;
+  std::printf("%-12s %zu pages  %8.2f ms  %8.2f us/page\n", name, pages, ms,
+              pages > 0 ? ms * 1000 / pages : 0.0);
+}
+
+int main(int argc, char* argv[]) {
+  std::vector<uint8_t> document;
+  if (argc > 1) {
+    std::ifstream file(argv[1], std::ios::binary);
+    document.assign(std::istreambuf_iterator<char>(file),
+                    std::istreambuf_iterator<char>());
+  } else {
+    std::vector<TestPage> pages;
+    for (auto i = 0; i < generatedPages; i++) {
+      pages.push_back(i % 3 == 2 ? TestPage{842, 595, std::to_string(i)}
+                                 : TestPage{612, 792, std::to_string(i)});
+    }
+    document = makePdf(pages);
+  }
+
+  // Keeps PDFium initialized between the runs, as in the plugin.
+  PdfiumLibrary library;
+
+  DocumentProbe probe;
+  std::string error;
+  auto start = std::chrono::steady_clock::now();
+  for (auto i = 0; i < runs; i++) {
+    if (!DocumentProbe::probe(document, probe, error)) {
+      std::fprintf(stderr, "%s\n", error.c_str());
+      return 1;
+    }
+  }
+  report("probe", probe.sizes.size() / 2, start);
+
+  std::vector<double> sizes;
+  start = std::chrono::steady_clock::now();
+  for (auto i = 0; i < runs; i++) {
+    if (!loadPages(document, sizes)) {
+      std::fprintf(stderr, "Cannot load the pages\n");
+      return 1;
+    }
+  }
+  report("load pages", sizes.size() / 2, start);
+
+  if (sizes != probe.sizes) {
+    std::fprintf(stderr, "The probe and the loaded pages disagree\n");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,105 @@
+// Compares rendering the first page of many documents one at a time in this
+// process, each loading PDFium for itself, with the way rasterBatch does it:
+// the documents shared with the raster worker processes, one task per
+// worker on the pool taking the documents in turn.
+//
+// raster_batch_benchmark [file.pdf...]
+// Generated documents are used if no file is given. The workers are this
+// executable started with --raster-worker.
+
+#include <windows.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cwchar>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "open_document.h"
+#include "raster_farm.h"
+#include "raster_worker.h"
+#include "test_util.h"
+#include "worker_pool.h"
+
+static const double thumbnailScale = 0.25;
+
+static bool renderFirstPage(const OpenDocument::Bytes& bytes) {
+  std::string error;
+  auto document = OpenDocument::open(bytes, error);
+  OpenDocument::Image image;
+  return document && document->render(0, thumbnailScale, image);
+}
+
+static bool renderFirstPage(RasterFarm& workers,
+                            const OpenDocument::Bytes& bytes) {
+  auto document = RasterFarm::Document::create(*bytes);
+  std::string error;
+  OpenDocument::Image image;
+  return document && workers.pageCount(document, error) > 0 &&
+         workers.render(document, 0, thumbnailScale, image, error);
+}
+
+static void report(const char* name,
+                   size_t documents,
+                   size_t rendered,
+                   std::chrono::steady_clock::time_point start) {
+  auto ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start)
+                .count();
+  std::printf("%-14s %zu/%zu documents  %8.1f ms  %8.1f documents/s\n", name,
+              rendered, documents, ms, ms > 0 ? documents * 1000 / ms : 0.0);
+}
+
+int wmain(int argc, wchar_t* argv[]) {
+  if (argc > 2 && wcscmp(argv[1], rasterWorkerArgument) == 0) {
+    return runRasterWorker(argv[2]);
+  }
+
+  std::vector<OpenDocument::Bytes> documents;
+  for (auto i = 1; i < argc; i++) {
+    std::ifstream file(argv[i], std::ios::binary);
+    documents.push_back(std::make_shared<const std::vector<uint8_t>>(
+        std::istreambuf_iterator<char>(file),
+        std::istreambuf_iterator<char>()));
+  }
+  if (documents.empty()) {
+    for (auto i = 0; i < 200; i++) {
+      documents.push_back(std::make_shared<const std::vector<uint8_t>>(
+          makePdf({{612, 792, "Document " + std::to_string(i)},
+                   {612, 792, "Second page"}})));
+    }
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  size_t rendered = 0;
+  for (auto& bytes : documents) {
+    rendered += renderFirstPage(bytes) ? 1 : 0;
+  }
+  report("one at a time", documents.size(), rendered, start);
+
+  // Started before the clock, like startRasterWorkers.
+  RasterFarm workers{
+      std::max<size_t>(std::thread::hardware_concurrency() / 2, 2)};
+  workers.warmUp();
+
+  start = std::chrono::steady_clock::now();
+  std::atomic<size_t> batchRendered{0};
+  std::atomic<size_t> next{0};
+  WorkerPool::shared().parallelFor(workers.size(), [&](size_t) {
+    for (auto i = next++; i < documents.size(); i = next++) {
+      if (renderFirstPage(workers, documents[i])) {
+        batchRendered++;
+      }
+    }
+  });
+  report("batch", documents.size(), batchRendered, start);
+
+  std::printf("%zu raster workers\n", workers.size());
+  return 0;
+}
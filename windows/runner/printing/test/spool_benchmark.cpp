@@ -0,0 +1,184 @@
+// Compares the output modes of printPdf on one printer: the bytes each one
+// spools for the whole document, and the time until the first page is handed
+// to the spooler. Every mode runs through PrintJob::writeJob as a printPdf
+// call would, with the output written to a file instead of the printer, so
+// nothing is printed.
+//
+// spool_benchmark <file.pdf> [printer]
+
+#include <windows.h>
+
+#include <flutter/binary_messenger.h>
+#include <flutter/method_channel.h>
+#include <flutter/standard_method_codec.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "flight_recorder.h"
+#include "print_job.h"
+#include "printing.h"
+#include "task_runner.h"
+
+// The channel Printing reports the jobs on, see NullMessenger.
+std::unique_ptr<flutter::MethodChannel<flutter::EncodableValue>> channel;
+
+// Defined by print_job.cpp.
+std::string toUtf8(std::wstring wstr);
+
+// There is no Dart side, the events of the jobs are dropped.
+class NullMessenger : public flutter::BinaryMessenger {
+ public:
+  void Send(const std::string& channel,
+            const uint8_t* message,
+            size_t message_size,
+            flutter::BinaryReply reply) const override {}
+
+  void SetMessageHandler(const std::string& channel,
+                         flutter::BinaryMessageHandler handler) override {}
+};
+
+struct Result {
+  bool completed = false;
+  int64_t spoolBytes = -1;
+  double firstPageMs = -1;
+  double totalMs = -1;
+};
+
+static int64_t fileSize(const std::wstring& path) {
+  WIN32_FILE_ATTRIBUTE_DATA data;
+  if (!GetFileAttributesEx(path.c_str(), GetFileExInfoStandard, &data)) {
+    return -1;
+  }
+  return (static_cast<int64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+}
+
+// Reads the outcome of job and the time from its start to its first page
+// sent from the flight recorder, as writeJob logs them. A RAW job logs its
+// only page once the whole file is written.
+static void readFlight(int job, Result& result) {
+  auto map = FlightRecorder::toMap();
+  auto& records =
+      std::get<std::vector<int64_t>>(map[flutter::EncodableValue("records")]);
+  int64_t start = -1;
+  for (size_t i = 0; i + 3 < records.size(); i += 4) {
+    if (records[i + 1] != job) {
+      continue;
+    }
+
+    auto time = records[i];
+    switch (static_cast<FlightEvent>(records[i + 3])) {
+      case FlightEvent::start:
+        start = time;
+        break;
+      case FlightEvent::pageSent:
+        if (start >= 0 && result.firstPageMs < 0) {
+          result.firstPageMs = static_cast<double>(time - start) / 1e6;
+        }
+        break;
+      case FlightEvent::completed:
+        result.completed = true;
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+// Prints data on printer with its default settings through a PrintJob, as
+// printPdf with usePrinterSettings does.
+static Result spool(Printing& printing,
+                    int index,
+                    const std::vector<uint8_t>& data,
+                    const std::string& printer,
+                    OutputMode mode,
+                    const std::wstring& output) {
+  Result result;
+  DeleteFile(output.c_str());
+
+  PrintJob job{&printing, index};
+  job.setOutputMode(mode);
+  job.setOutputFile(output);
+  if (!job.printPdf("spool_benchmark", printer, 0, 0, true)) {
+    return result;
+  }
+
+  // The layout is skipped, the document is the one Dart would send back.
+  auto start = std::chrono::steady_clock::now();
+  job.writeJob(data);
+  result.totalMs = std::chrono::duration<double, std::milli>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+  readFlight(index, result);
+  result.spoolBytes = fileSize(output);
+  return result;
+}
+
+static std::wstring defaultPrinter() {
+  DWORD size = 0;
+  GetDefaultPrinter(nullptr, &size);
+  std::wstring name(size, L'\0');
+  if (!size || !GetDefaultPrinter(name.data(), &size)) {
+    return std::wstring{};
+  }
+  name.resize(size - 1);
+  return name;
+}
+
+static void report(const char* mode, const Result& result) {
+  if (!result.completed || result.spoolBytes < 0) {
+    std::printf("%-12s failed\n", mode);
+    return;
+  }
+  std::printf("%-12s %12lld bytes  first page %8.1f ms  total %8.1f ms\n",
+              mode, static_cast<long long>(result.spoolBytes),
+              result.firstPageMs, result.totalMs);
+}
+
+int wmain(int argc, wchar_t* argv[]) {
+  if (argc < 2) {
+    std::printf("usage: spool_benchmark <file.pdf> [printer]\n");
+    return 2;
+  }
+
+  std::ifstream file(argv[1], std::ios::binary);
+  std::vector<uint8_t> data{std::istreambuf_iterator<char>(file),
+                            std::istreambuf_iterator<char>()};
+  auto printer = argc > 2 ? std::wstring{argv[2]} : defaultPrinter();
+  if (data.empty() || printer.empty()) {
+    std::printf("cannot read the document or find a printer\n");
+    return 1;
+  }
+
+  wchar_t tempDir[MAX_PATH];
+  GetTempPath(MAX_PATH, tempDir);
+  auto output = std::wstring{tempDir} + L"spool_benchmark.prn";
+
+  NullMessenger messenger;
+  channel = std::make_unique<flutter::MethodChannel<flutter::EncodableValue>>(
+      &messenger, "printing", &flutter::StandardMethodCodec::GetInstance());
+  TaskRunner runner;
+  Printing printing{&runner};
+
+  std::printf("%ls\n", printer.c_str());
+  auto name = toUtf8(printer);
+  report("gdi", spool(printing, 1, data, name, OutputMode::gdi, output));
+  report("postScript2",
+         spool(printing, 2, data, name, OutputMode::postScript2, output));
+  report("postScript3",
+         spool(printing, 3, data, name, OutputMode::postScript3, output));
+  // Spooled untouched, the printer only starts on the first page once it
+  // has received the whole file.
+  report("pdf", spool(printing, 4, data, name, OutputMode::pdf, output));
+
+  DeleteFile(output.c_str());
+  channel = nullptr;
+  return 0;
+}
@@ -0,0 +1,31 @@
+#ifndef PRINTING_PLUGIN_TEST_UTIL_H_
+#define PRINTING_PLUGIN_TEST_UTIL_H_
+
+#include <windows.h>
+
+#include <string>
+
+#include "printing_test_util.h"
+
+// Windows helpers of the printing tests.
+
+// Defined by print_job.cpp in the runner, each test includes this header
+// once.
+std::wstring fromUtf8(std::string str) {
+  auto len = MultiByteToWideChar(CP_UTF8, 0, str.c_str(),
+                                 static_cast<int>(str.length()), nullptr, 0);
+  auto wstr = std::wstring(len > 0 ? len : 0, L'\0');
+  if (len > 0) {
+    MultiByteToWideChar(CP_UTF8, 0, str.c_str(),
+                        static_cast<int>(str.length()), &wstr[0], len);
+  }
+  return wstr;
+}
+
+inline std::string tempPath(const std::string& name) {
+  char dir[MAX_PATH];
+  GetTempPathA(MAX_PATH, dir);
+  return std::string{dir} + name;
+}
+
+#endif
@@ -0,0 +1,62 @@
+// Pages and characters per second of TextIndex::build on the worker pool,
+// which extracts the text of every page with PDFium and indexes its words.
+//
+// text_index_benchmark [file.pdf]
+// A generated document of 1000 pages is used if no file is given.
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "test_util.h"
+#include "text_index.h"
+#include "worker_pool.h"
+
+static const int generatedPages = 1000;
+
+// A line of words, some of them shared by every page and some unique.
+static std::string pageText(int page) {
+  return "Page " + std::to_string(page) +
+         " of the quarterly report lists invoice " +
+         std::to_string(page * 7919 % 100000) +
+         " with totals carried forward to the summary";
+}
+
+int main(int argc, char* argv[]) {
+  std::vector<uint8_t> document;
+  if (argc > 1) {
+    std::ifstream file(argv[1], std::ios::binary);
+    document.assign(std::istreambuf_iterator<char>(file),
+                    std::istreambuf_iterator<char>());
+  } else {
+    std::vector<TestPage> pages;
+    for (auto i = 0; i < generatedPages; i++) {
+      pages.push_back({612, 792, pageText(i)});
+    }
+    document = makePdf(pages);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  auto index = TextIndex::build(document, WorkerPool::shared());
+  auto seconds = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  if (!index) {
+    std::fprintf(stderr, "Cannot load the document\n");
+    return 1;
+  }
+
+  size_t chars = 0;
+  for (size_t i = 0; i < index->pageCount(); i++) {
+    chars += index->page(i).chars.size();
+  }
+  std::printf("%zu pages  %zu chars  %8.1f ms  %10.1f pages/s  "
+              "%12.1f chars/s\n",
+              index->pageCount(), chars, seconds * 1000,
+              seconds > 0 ? index->pageCount() / seconds : 0.0,
+              seconds > 0 ? chars / seconds : 0.0);
+  return 0;
+}
@@ -0,0 +1,113 @@
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "test_util.h"
+#include "text_index.h"
+#include "worker_pool.h"
+
+static std::shared_ptr<const TextIndex> buildIndex(WorkerPool& pool) {
+  return TextIndex::build(makePdf({{612, 792, "Hello printing world"},
+                                   {612, 792, "Nothing to see"},
+                                   {612, 792, "The PRINTING World again"}}),
+                          pool);
+}
+
+static void searchesWords(WorkerPool& pool) {
+  auto index = buildIndex(pool);
+  EXPECT(index != nullptr);
+  if (!index) {
+    return;
+  }
+  EXPECT(index->pageCount() == 3);
+
+  // Case folded, in page order.
+  auto hits = index->search("printing", 10);
+  EXPECT(hits.size() == 2);
+  if (hits.size() == 2) {
+    EXPECT(hits[0].page == 0 && hits[0].start == 6 && hits[0].length == 8);
+    EXPECT(hits[1].page == 2 && hits[1].start == 4 && hits[1].length == 8);
+    EXPECT(hits[0].left < hits[0].right && hits[0].top < hits[0].bottom);
+  }
+
+  // Consecutive words only.
+  EXPECT(index->search("printing world", 10).size() == 2);
+  EXPECT(index->search("hello world", 10).empty());
+  EXPECT(index->search("missing", 10).empty());
+  EXPECT(index->search("printing", 1).size() == 1);
+}
+
+static void savesAndLoads(WorkerPool& pool) {
+  auto index = buildIndex(pool);
+  auto path = tempPath("text_index_test.idx");
+  EXPECT(index && index->save(path));
+
+  auto loaded = TextIndex::load(path, pool);
+  EXPECT(loaded != nullptr);
+  if (index && loaded) {
+    EXPECT(loaded->pageCount() == index->pageCount());
+    auto hits = loaded->search("printing world", 10);
+    EXPECT(hits.size() == 2);
+    EXPECT(hits.size() == 2 && hits[1].page == 2 && hits[1].length == 14);
+  }
+  DeleteFileA(path.c_str());
+}
+
+static std::vector<char> readFile(const std::string& path) {
+  std::ifstream in{path, std::ios::binary};
+  return std::vector<char>{std::istreambuf_iterator<char>(in),
+                           std::istreambuf_iterator<char>()};
+}
+
+static void writeFile(const std::string& path, const std::vector<char>& data) {
+  std::ofstream out{path, std::ios::binary | std::ios::trunc};
+  out.write(data.data(), data.size());
+}
+
+static void rejectsDamagedFiles(WorkerPool& pool) {
+  auto index = buildIndex(pool);
+  auto path = tempPath("text_index_test.idx");
+  EXPECT(index && index->save(path));
+  auto data = readFile(path);
+  EXPECT(data.size() > 32);
+  if (data.size() <= 32) {
+    return;
+  }
+
+  // Header: magic, version, page count, then width, height and character
+  // count of the first page.
+  auto truncated = std::vector<char>(data.begin(), data.end() - 5);
+  writeFile(path, truncated);
+  EXPECT(TextIndex::load(path, pool) == nullptr);
+
+  auto pages = data;
+  uint32_t pageCount = 0x7fffffff;
+  std::memcpy(&pages[8], &pageCount, sizeof(pageCount));
+  writeFile(path, pages);
+  EXPECT(TextIndex::load(path, pool) == nullptr);
+
+  auto chars = data;
+  uint32_t charCount = 0x7fffffff;
+  std::memcpy(&chars[20], &charCount, sizeof(charCount));
+  writeFile(path, chars);
+  EXPECT(TextIndex::load(path, pool) == nullptr);
+
+  auto magic = data;
+  magic[0] = 'X';
+  writeFile(path, magic);
+  EXPECT(TextIndex::load(path, pool) == nullptr);
+
+  DeleteFileA(path.c_str());
+  EXPECT(TextIndex::load(path, pool) == nullptr);
+}
+
+int main() {
+  WorkerPool pool{2};
+  searchesWords(pool);
+  savesAndLoads(pool);
+  rejectsDamagedFiles(pool);
+  return testFailures();
+}
@@ -0,0 +1,343 @@
+#include "text_index.h"
+
+#include <algorithm>
+#include <cwctype>
+#include <fstream>
+
+#include "fpdf_text.h"
+#include "pdfium.h"
+#include "pdfview.h"
+#include "trace.h"
+#include "worker_pool.h"
+
+static const char indexMagic[4] = {'P', 'T', 'X', 'I'};
+static const uint32_t indexVersion = 1;
+
+std::wstring fromUtf8(std::string str);
+
+static bool isIdeograph(uint32_t c) {
+  return (c >= 0x3040 && c <= 0x30ff) || (c >= 0x3400 && c <= 0x4dbf) ||
+         (c >= 0x4e00 && c <= 0x9fff) || (c >= 0xf900 && c <= 0xfaff) ||
+         (c >= 0x20000 && c <= 0x2ffff);
+}
+
+static bool isWordChar(uint32_t c) {
+  if (c >= 0x10000) {
+    return true;
+  }
+  return std::iswalnum(static_cast<wint_t>(c)) != 0;
+}
+
+static uint32_t fold(uint32_t c) {
+  if (c >= 0x10000) {
+    return c;
+  }
+  return static_cast<uint32_t>(std::towlower(static_cast<wint_t>(c)));
+}
+
+static std::vector<uint32_t> decodeUtf8(const std::string& str) {
+  std::vector<uint32_t> chars;
+  chars.reserve(str.size());
+
+  for (size_t i = 0; i < str.size();) {
+    auto c = static_cast<uint8_t>(str[i]);
+    auto length = c < 0x80 ? 1 : c < 0xe0 ? 2 : c < 0xf0 ? 3 : 4;
+    uint32_t code = length == 1 ? c
+                    : length == 2 ? c & 0x1f
+                    : length == 3 ? c & 0x0f
+                                  : c & 0x07;
+    for (auto k = 1; k < length && i + k < str.size(); k++) {
+      code = (code << 6) | (static_cast<uint8_t>(str[i + k]) & 0x3f);
+    }
+    chars.push_back(code);
+    i += length;
+  }
+
+  return chars;
+}
+
+std::vector<TextIndex::Word> TextIndex::tokenize(
+    const std::vector<uint32_t>& chars) {
+  std::vector<Word> words;
+  auto count = static_cast<int>(chars.size());
+
+  for (auto i = 0; i < count;) {
+    auto c = chars[i];
+    if (isIdeograph(c)) {
+      words.push_back(Word{std::u32string(1, static_cast<char32_t>(c)), i, 1});
+      i++;
+    } else if (isWordChar(c)) {
+      auto start = i;
+      std::u32string term;
+      while (i < count && isWordChar(chars[i]) && !isIdeograph(chars[i])) {
+        term.push_back(static_cast<char32_t>(fold(chars[i])));
+        i++;
+      }
+      words.push_back(Word{std::move(term), start, i - start});
+    } else {
+      i++;
+    }
+  }
+
+  return words;
+}
+
+std::shared_ptr<const TextIndex> TextIndex::index(
+    std::vector<Page> pages,
+    std::vector<std::vector<Word>> words) {
+  auto result = std::make_shared<TextIndex>();
+  result->pages = std::move(pages);
+  result->tokens.resize(words.size());
+
+  for (size_t p = 0; p < words.size(); p++) {
+    auto& pageTokens = result->tokens[p];
+    pageTokens.reserve(words[p].size());
+
+    for (auto& word : words[p]) {
+      auto it = result->terms.find(word.term);
+      if (it == result->terms.end()) {
+        it = result->terms
+                 .emplace(std::move(word.term),
+                          static_cast<int>(result->postings.size()))
+                 .first;
+        result->postings.emplace_back();
+      }
+
+      result->postings[it->second].push_back(
+          Posting{static_cast<int>(p), static_cast<int>(pageTokens.size())});
+      pageTokens.push_back(Token{it->second, word.start, word.length});
+    }
+  }
+
+  return result;
+}
+
+std::shared_ptr<const TextIndex> TextIndex::build(
+    const std::vector<uint8_t>& data,
+    WorkerPool& pool) {
+  PRINTING_TRACE_SCOPE("buildTextIndex", -1, -1);
+  PdfiumLibrary library;
+
+  FPDF_DOCUMENT doc;
+  int pageCount;
+  {
+    PdfiumLock lock{pdfiumMutex()};
+    doc = FPDF_LoadMemDocument64(data.data(), data.size(), nullptr);
+    if (!doc) {
+      return nullptr;
+    }
+    pageCount = FPDF_GetPageCount(doc);
+  }
+
+  std::vector<Page> pages(pageCount);
+  std::vector<std::vector<Word>> words(pageCount);
+
+  // PDFium serializes the extraction itself, tokenizing a page overlaps with
+  // the extraction of the next ones.
+  pool.parallelFor(pages.size(), [&](size_t n) {
+    auto& page = pages[n];
+    {
+      PRINTING_TRACE_SCOPE("extractText", -1, static_cast<int>(n));
+      PdfiumLock lock{pdfiumMutex()};
+      auto pdfPage = FPDF_LoadPage(doc, static_cast<int>(n));
+      if (!pdfPage) {
+        return;
+      }
+
+      page.width = static_cast<float>(FPDF_GetPageWidth(pdfPage));
+      page.height = static_cast<float>(FPDF_GetPageHeight(pdfPage));
+
+      auto text = FPDFText_LoadPage(pdfPage);
+      if (text) {
+        auto count = std::max(FPDFText_CountChars(text), 0);
+        page.chars.resize(count);
+        page.boxes.resize(static_cast<size_t>(count) * 4);
+
+        for (auto i = 0; i < count; i++) {
+          page.chars[i] = FPDFText_GetUnicode(text, i);
+
+          double left = 0, right = 0, bottom = 0, top = 0;
+          FPDFText_GetCharBox(text, i, &left, &right, &bottom, &top);
+          auto box = &page.boxes[static_cast<size_t>(i) * 4];
+          box[0] = static_cast<float>(left);
+          box[1] = page.height - static_cast<float>(top);
+          box[2] = static_cast<float>(right);
+          box[3] = page.height - static_cast<float>(bottom);
+        }
+
+        FPDFText_ClosePage(text);
+      }
+
+      FPDF_ClosePage(pdfPage);
+    }
+
+    PRINTING_TRACE_SCOPE("tokenize", -1, static_cast<int>(n));
+    words[n] = tokenize(page.chars);
+  });
+
+  {
+    PdfiumLock lock{pdfiumMutex()};
+    FPDF_CloseDocument(doc);
+  }
+
+  return index(std::move(pages), std::move(words));
+}
+
+template <typename T>
+static void writeValue(std::ofstream& out, const T& value) {
+  out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+static bool readValue(std::ifstream& in, T& value) {
+  return static_cast<bool>(
+      in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+bool TextIndex::save(const std::string& path) const {
+  std::ofstream out{fromUtf8(path),
+                    std::ios::out | std::ios::binary | std::ios::trunc};
+  if (!out) {
+    return false;
+  }
+
+  // Only the extracted characters are stored, the words and postings are
+  // rebuilt on load without PDFium.
+  out.write(indexMagic, sizeof(indexMagic));
+  writeValue(out, indexVersion);
+  writeValue(out, static_cast<uint32_t>(pages.size()));
+  for (auto& page : pages) {
+    writeValue(out, page.width);
+    writeValue(out, page.height);
+    writeValue(out, static_cast<uint32_t>(page.chars.size()));
+    out.write(reinterpret_cast<const char*>(page.chars.data()),
+              page.chars.size() * sizeof(uint32_t));
+    out.write(reinterpret_cast<const char*>(page.boxes.data()),
+              page.boxes.size() * sizeof(float));
+  }
+
+  return out.good();
+}
+
+std::shared_ptr<const TextIndex> TextIndex::load(const std::string& path,
+                                                 WorkerPool& pool) {
+  std::ifstream in{fromUtf8(path),
+                   std::ios::in | std::ios::binary | std::ios::ate};
+  if (!in) {
+    return nullptr;
+  }
+  uint64_t fileSize = in.tellg();
+  in.seekg(0);
+
+  char magic[sizeof(indexMagic)];
+  uint32_t version, pageCount;
+  if (!in.read(magic, sizeof(magic)) ||
+      !std::equal(std::begin(magic), std::end(magic), indexMagic) ||
+      !readValue(in, version) || version != indexVersion ||
+      !readValue(in, pageCount)) {
+    return nullptr;
+  }
+
+  // Counts are checked against the bytes left before anything is allocated,
+  // a truncated or corrupt index is rejected instead.
+  const uint64_t pageHeaderSize = sizeof(float) * 2 + sizeof(uint32_t);
+  const uint64_t charSize = sizeof(uint32_t) + sizeof(float) * 4;
+  auto remaining = [&in, fileSize] {
+    return fileSize - static_cast<uint64_t>(in.tellg());
+  };
+  if (pageCount > remaining() / pageHeaderSize) {
+    return nullptr;
+  }
+
+  std::vector<Page> pages(pageCount);
+  for (auto& page : pages) {
+    uint32_t count;
+    if (!readValue(in, page.width) || !readValue(in, page.height) ||
+        !readValue(in, count) || count > remaining() / charSize) {
+      return nullptr;
+    }
+
+    page.chars.resize(count);
+    page.boxes.resize(static_cast<size_t>(count) * 4);
+    if (!in.read(reinterpret_cast<char*>(page.chars.data()),
+                 page.chars.size() * sizeof(uint32_t)) ||
+        !in.read(reinterpret_cast<char*>(page.boxes.data()),
+                 page.boxes.size() * sizeof(float))) {
+      return nullptr;
+    }
+  }
+
+  std::vector<std::vector<Word>> words(pageCount);
+  pool.parallelFor(pages.size(),
+                   [&](size_t n) { words[n] = tokenize(pages[n].chars); });
+
+  return index(std::move(pages), std::move(words));
+}
+
+std::vector<TextHit> TextIndex::search(const std::string& query,
+                                       size_t limit) const {
+  std::vector<TextHit> hits;
+
+  auto words = tokenize(decodeUtf8(query));
+  if (words.empty()) {
+    return hits;
+  }
+
+  std::vector<int> queryTerms;
+  for (auto& word : words) {
+    auto it = terms.find(word.term);
+    if (it == terms.end()) {
+      return hits;
+    }
+    queryTerms.push_back(it->second);
+  }
+
+  for (auto& posting : postings[queryTerms[0]]) {
+    if (hits.size() >= limit) {
+      break;
+    }
+
+    auto& pageTokens = tokens[posting.page];
+    if (posting.token + queryTerms.size() > pageTokens.size()) {
+      continue;
+    }
+
+    auto matches = true;
+    for (size_t i = 1; i < queryTerms.size() && matches; i++) {
+      matches = pageTokens[posting.token + i].term == queryTerms[i];
+    }
+    if (!matches) {
+      continue;
+    }
+
+    auto& first = pageTokens[posting.token];
+    auto& last = pageTokens[posting.token + queryTerms.size() - 1];
+    auto& boxes = pages[posting.page].boxes;
+
+    TextHit hit{posting.page, first.start, last.start + last.length - first.start,
+                0, 0, 0, 0};
+    auto empty = true;
+    for (auto c = hit.start; c < hit.start + hit.length; c++) {
+      auto box = &boxes[static_cast<size_t>(c) * 4];
+      if (box[0] == box[2] || box[1] == box[3]) {
+        continue;  // generated characters have no box
+      }
+      if (empty) {
+        hit.left = box[0];
+        hit.top = box[1];
+        hit.right = box[2];
+        hit.bottom = box[3];
+        empty = false;
+      } else {
+        hit.left = std::min(hit.left, box[0]);
+        hit.top = std::min(hit.top, box[1]);
+        hit.right = std::max(hit.right, box[2]);
+        hit.bottom = std::max(hit.bottom, box[3]);
+      }
+    }
+
+    hits.push_back(hit);
+  }
+
+  return hits;
+}
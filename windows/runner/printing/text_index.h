@@ -0,0 +1,84 @@
+#ifndef PRINTING_PLUGIN_TEXT_INDEX_H_
+#define PRINTING_PLUGIN_TEXT_INDEX_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class WorkerPool;
+
+// A match of a search query: characters [start, start + length) of a page,
+// and their bounding box in PDF points from the top-left corner of the page.
+struct TextHit {
+  int page;
+  int start;
+  int length;
+  float left;
+  float top;
+  float right;
+  float bottom;
+};
+
+// Inverted index over the words of a document, built once from PDFium text
+// pages so that queries never go back to PDFium.
+// Words are lowercased runs of letters and digits; CJK ideographs and kana
+// are one word each. A query matches consecutive words of a page.
+class TextIndex {
+ public:
+  // The characters of a page as extracted by PDFium.
+  struct Page {
+    float width = 0;
+    float height = 0;
+    std::vector<uint32_t> chars;
+    std::vector<float> boxes;  // left, top, right, bottom per char
+  };
+
+  // Returns nullptr if the document cannot be loaded.
+  static std::shared_ptr<const TextIndex> build(const std::vector<uint8_t>& data,
+                                                WorkerPool& pool);
+
+  // Returns nullptr if the file is missing or not an index.
+  static std::shared_ptr<const TextIndex> load(const std::string& path,
+                                               WorkerPool& pool);
+
+  bool save(const std::string& path) const;
+
+  // query is UTF-8. Hits are in page order.
+  std::vector<TextHit> search(const std::string& query, size_t limit) const;
+
+  size_t pageCount() const { return pages.size(); }
+
+  const Page& page(size_t index) const { return pages[index]; }
+
+ private:
+  struct Word {
+    std::u32string term;
+    int start;
+    int length;
+  };
+
+  struct Token {
+    int term;
+    int start;
+    int length;
+  };
+
+  struct Posting {
+    int page;
+    int token;
+  };
+
+  static std::vector<Word> tokenize(const std::vector<uint32_t>& chars);
+
+  static std::shared_ptr<const TextIndex> index(std::vector<Page> pages,
+                                                std::vector<std::vector<Word>> words);
+
+  std::vector<Page> pages;
+  std::vector<std::vector<Token>> tokens;  // per page, in reading order
+  std::unordered_map<std::u32string, int> terms;
+  std::vector<std::vector<Posting>> postings;  // per term
+};
+
+#endif
@@ -0,0 +1,60 @@
+#include "text_layer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "fpdf_text.h"
+
+static uint16_t quantize(float value, float size) {
+  if (size <= 0) {
+    return 0;
+  }
+  auto q = value / size * 65535.0f + 0.5f;
+  return static_cast<uint16_t>(std::min(std::max(q, 0.0f), 65535.0f));
+}
+
+std::vector<uint8_t> extractTextLayer(FPDF_PAGE page) {
+  auto width = static_cast<float>(FPDF_GetPageWidth(page));
+  auto height = static_cast<float>(FPDF_GetPageHeight(page));
+
+  auto text = FPDFText_LoadPage(page);
+  uint32_t count = 0;
+  if (text) {
+    count = static_cast<uint32_t>(std::max(FPDFText_CountChars(text), 0));
+  }
+
+  const size_t header = sizeof(uint32_t) + 2 * sizeof(float);
+  std::vector<uint8_t> layer(header + count * sizeof(uint32_t) +
+                             count * 4 * sizeof(uint16_t));
+
+  auto out = layer.data();
+  std::memcpy(out, &count, sizeof(count));
+  std::memcpy(out + sizeof(count), &width, sizeof(width));
+  std::memcpy(out + sizeof(count) + sizeof(width), &height, sizeof(height));
+
+  auto codepoints = out + header;
+  auto boxes = codepoints + count * sizeof(uint32_t);
+
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t codepoint = FPDFText_GetUnicode(text, static_cast<int>(i));
+    std::memcpy(codepoints + i * sizeof(uint32_t), &codepoint,
+                sizeof(codepoint));
+
+    FS_RECTF rect{0, 0, 0, 0};
+    FPDFText_GetLooseCharBox(text, static_cast<int>(i), &rect);
+
+    uint16_t box[4] = {
+        quantize(rect.left, width),
+        quantize(height - rect.top, height),
+        quantize(rect.right, width),
+        quantize(height - rect.bottom, height),
+    };
+    std::memcpy(boxes + i * sizeof(box), box, sizeof(box));
+  }
+
+  if (text) {
+    FPDFText_ClosePage(text);
+  }
+
+  return layer;
+}
@@ -0,0 +1,20 @@
+#ifndef PRINTING_PLUGIN_TEXT_LAYER_H_
+#define PRINTING_PLUGIN_TEXT_LAYER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "pdfview.h"
+
+// Packs the glyphs of a page for text selection over its raster image.
+// Little-endian layout:
+//   uint32 count
+//   float32 pageWidth, pageHeight  (PDF points)
+//   uint32 codepoints[count]
+//   uint16 boxes[count * 4]        (left, top, right, bottom)
+// Boxes are quantized to 1/65535 of the page size, from the top-left
+// corner, so they scale with any raster resolution.
+// Must be called while holding a PdfiumLock.
+std::vector<uint8_t> extractTextLayer(FPDF_PAGE page);
+
+#endif
@@ -0,0 +1,86 @@
+#include "trace.h"
+
+#ifdef PRINTING_TRACE
+
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+struct TraceEvent {
+  const char* name;
+  int job;
+  int page;
+  size_t thread;
+  long long start;  // microseconds
+  long long duration;
+};
+
+// Events past this count are dropped until the next export.
+static const size_t maxEvents = 1 << 20;
+
+static std::mutex traceMutex;
+static std::vector<TraceEvent> traceEvents;
+static const auto traceEpoch = std::chrono::steady_clock::now();
+
+std::wstring fromUtf8(std::string str);
+
+static long long micros(std::chrono::steady_clock::duration d) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+
+TraceScope::TraceScope(const char* name, int job, int page)
+    : name{name},
+      job{job},
+      page{page},
+      start{std::chrono::steady_clock::now()} {}
+
+TraceScope::~TraceScope() {
+  auto end = std::chrono::steady_clock::now();
+  auto thread = std::hash<std::thread::id>{}(std::this_thread::get_id());
+
+  std::lock_guard<std::mutex> lock{traceMutex};
+  if (traceEvents.size() < maxEvents) {
+    traceEvents.push_back(TraceEvent{name, job, page, thread,
+                                     micros(start - traceEpoch),
+                                     micros(end - start)});
+  }
+}
+
+bool exportTrace(const std::string& path) {
+  std::vector<TraceEvent> events;
+  {
+    std::lock_guard<std::mutex> lock{traceMutex};
+    events.swap(traceEvents);
+  }
+
+  std::ofstream out{fromUtf8(path), std::ios::out | std::ios::trunc};
+  if (!out) {
+    return false;
+  }
+
+  out << "{\"traceEvents\":[";
+  auto first = true;
+  for (auto& e : events) {
+    if (!first) {
+      out << ',';
+    }
+    first = false;
+    out << "{\"name\":\"" << e.name << "\",\"cat\":\"printing\",\"ph\":\"X\""
+        << ",\"pid\":1,\"tid\":" << (e.thread & 0xffffff)
+        << ",\"ts\":" << e.start << ",\"dur\":" << e.duration
+        << ",\"args\":{\"job\":" << e.job << ",\"page\":" << e.page << "}}";
+  }
+  out << "],\"displayTimeUnit\":\"ms\"}";
+
+  return out.good();
+}
+
+#else
+
+bool exportTrace(const std::string& path) {
+  return false;
+}
+
+#endif
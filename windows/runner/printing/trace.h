@@ -0,0 +1,48 @@
+#ifndef PRINTING_PLUGIN_TRACE_H_
+#define PRINTING_PLUGIN_TRACE_H_
+
+#include <string>
+
+// Scoped trace events for the print and raster pipelines, exported in the
+// Chrome trace event format (chrome://tracing, ui.perfetto.dev).
+// Build with PRINTING_TRACE defined to record them, otherwise
+// PRINTING_TRACE_SCOPE expands to nothing.
+
+#ifdef PRINTING_TRACE
+
+#include <chrono>
+
+class TraceScope {
+ public:
+  // name must be a string literal, it is stored as a pointer.
+  TraceScope(const char* name, int job, int page);
+
+  ~TraceScope();
+
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+ private:
+  const char* name;
+  int job;
+  int page;
+  std::chrono::steady_clock::time_point start;
+};
+
+#define PRINTING_TRACE_CONCAT_(a, b) a##b
+#define PRINTING_TRACE_CONCAT(a, b) PRINTING_TRACE_CONCAT_(a, b)
+#define PRINTING_TRACE_SCOPE(name, job, page) \
+  TraceScope PRINTING_TRACE_CONCAT(traceScope, __LINE__) { name, job, page }
+
+#else
+
+#define PRINTING_TRACE_SCOPE(name, job, page)
+
+#endif
+
+// Writes the events recorded so far to path as Chrome trace JSON and
+// forgets them. Returns false if tracing is compiled out or the file cannot
+// be written.
+bool exportTrace(const std::string& path);
+
+#endif
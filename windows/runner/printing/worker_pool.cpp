@@ -0,0 +1,97 @@
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+WorkerPool::WorkerPool(size_t count) {
+  threads.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    threads.emplace_back([this] { run(); });
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock{mutex};
+    stopping = true;
+  }
+  available.notify_all();
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+void WorkerPool::post(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock{mutex};
+    tasks.push_back(std::move(task));
+  }
+  available.notify_one();
+}
+
+void WorkerPool::run() {
+  for (;;) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock{mutex};
+      available.wait(lock, [this] { return stopping || !tasks.empty(); });
+      if (tasks.empty()) {
+        return;
+      }
+      task = std::move(tasks.front());
+      tasks.pop_front();
+    }
+    task();
+  }
+}
+
+// Shared between the caller of parallelFor and the helpers it posted.
+// Helpers that start after every index was taken return without touching
+// task, so the caller only waits for the indices, not for the helpers.
+struct ParallelFor {
+  std::function<void(size_t)> task;
+  size_t count;
+  std::atomic<size_t> next{0};
+  size_t done = 0;
+  std::mutex mutex;
+  std::condition_variable finished;
+
+  void run() {
+    for (auto i = next++; i < count; i = next++) {
+      task(i);
+      std::lock_guard<std::mutex> lock{mutex};
+      if (++done == count) {
+        finished.notify_all();
+      }
+    }
+  }
+};
+
+void WorkerPool::parallelFor(size_t count,
+                             const std::function<void(size_t)>& task) {
+  if (count == 0) {
+    return;
+  }
+
+  auto state = std::make_shared<ParallelFor>();
+  state->task = task;
+  state->count = count;
+
+  auto helpers = std::min(threads.size(), count - 1);
+  for (size_t i = 0; i < helpers; i++) {
+    post([state] { state->run(); });
+  }
+
+  state->run();
+
+  std::unique_lock<std::mutex> lock{state->mutex};
+  state->finished.wait(lock, [&] { return state->done == count; });
+}
+
+WorkerPool& WorkerPool::shared() {
+  static WorkerPool pool{
+      std::max(2u, std::thread::hardware_concurrency()) - 1};
+  return pool;
+}
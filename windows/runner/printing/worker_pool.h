@@ -0,0 +1,45 @@
+#ifndef PRINTING_PLUGIN_WORKER_POOL_H_
+#define PRINTING_PLUGIN_WORKER_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of threads running posted tasks in order.
+// PDFium calls made from tasks still need a PdfiumLock.
+class WorkerPool {
+ public:
+  explicit WorkerPool(size_t threads);
+
+  // Runs the tasks already posted, then joins the threads.
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  void post(std::function<void()> task);
+
+  // Calls task(i) for every i in [0, count) on the pool and the calling
+  // thread, and returns once all calls are done. The calling thread takes
+  // part, so this may be used from a pool thread.
+  void parallelFor(size_t count, const std::function<void(size_t)>& task);
+
+  size_t size() const { return threads.size(); }
+
+  // Pool sized to the hardware, shared by the whole plugin.
+  static WorkerPool& shared();
+
+ private:
+  void run();
+
+  std::vector<std::thread> threads;
+  std::mutex mutex;
+  std::condition_variable available;
+  std::deque<std::function<void()>> tasks;
+  bool stopping = false;
+};
+
+#endif